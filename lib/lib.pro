@@ -7,7 +7,9 @@ INCLUDEPATH += src
 CONFIG      += staticlib
 
 SOURCES += \
+           src/action/decimate-mesh.cpp \
            src/action/finalize.cpp \
+           src/action/remesh.cpp \
            src/action/sculpt.cpp \
            src/action/subdivide-mesh.cpp \
            src/adjacent-iterator.cpp \
@@ -25,13 +27,17 @@ SOURCES += \
            src/mesh.cpp \
            src/mesh-util.cpp \
            src/mirror.cpp \
+           src/multi-res.cpp \
            src/opengl.cpp \
            src/opengl-buffer-id.cpp \
+           src/parallel-util.cpp \
            src/partial-action/collapse-edge.cpp \
+           src/partial-action/collapse-edges.cpp \
            src/partial-action/collapse-face.cpp \
            src/partial-action/delete-edge-face.cpp \
            src/partial-action/delete-valence-3-vertex.cpp \
            src/partial-action/delete-vertex.cpp \
+           src/partial-action/extend-domain.cpp \
            src/partial-action/flip-edge.cpp \
            src/partial-action/insert-edge-face.cpp \
            src/partial-action/insert-edge-vertex.cpp \
@@ -48,6 +54,7 @@ SOURCES += \
            src/primitive/ray.cpp \
            src/primitive/sphere.cpp \
            src/primitive/triangle.cpp \
+           src/quadric.cpp \
            src/render-mode.cpp \
            src/renderer.cpp \
            src/scene.cpp \
@@ -61,11 +68,14 @@ SOURCES += \
            src/sketch/node-intersection.cpp \
            src/sketch/path.cpp \
            src/sketch/path-intersection.cpp \
+           src/sketch/preview.cpp \
            src/state.cpp \
            src/subdivision-butterfly.cpp \
+           src/subdivision-loop.cpp \
            src/time-delta.cpp \
            src/tool.cpp \
            src/tool/convert-sketch.cpp \
+           src/tool/decimate-mesh.cpp \
            src/tool/delete-mesh.cpp \
            src/tool/delete-sketch.cpp \
            src/tool/modify-sketch.cpp \
@@ -74,6 +84,7 @@ SOURCES += \
            src/tool/new-mesh.cpp \
            src/tool/new-sketch.cpp \
            src/tool/rebalance-sketch.cpp \
+           src/tool/remesh-mesh.cpp \
            src/tool/sculpt.cpp \
            src/tool/sculpt/carve.cpp \
            src/tool/sculpt/crease.cpp \
@@ -84,6 +95,7 @@ SOURCES += \
            src/tool/sculpt/reduce.cpp \
            src/tool/sculpt/smooth.cpp \
            src/tool/sketch-spheres.cpp \
+           src/tool/subdivide-mesh.cpp \
            src/tool/util/movement.cpp \
            src/tool/util/scaling.cpp \
            src/util.cpp \
@@ -106,13 +118,16 @@ SOURCES += \
            src/winged/edge.cpp \
            src/winged/face.cpp \
            src/winged/face-intersection.cpp \
+           src/winged/log.cpp \
            src/winged/mesh.cpp \
            src/winged/util.cpp \
            src/winged/vertex.cpp \
            src/xml-conversion.cpp \
 
 HEADERS += \
+           src/action/decimate-mesh.hpp \
            src/action/finalize.hpp \
+           src/action/remesh.hpp \
            src/action/sculpt.hpp \
            src/action/subdivide-mesh.hpp \
            src/adjacent-iterator.hpp \
@@ -137,13 +152,17 @@ HEADERS += \
            src/mesh.hpp \
            src/mesh-util.hpp \
            src/mirror.hpp \
+           src/multi-res.hpp \
            src/opengl.hpp \
            src/opengl-buffer-id.hpp \
+           src/parallel-util.hpp \
            src/partial-action/collapse-edge.hpp \
+           src/partial-action/collapse-edges.hpp \
            src/partial-action/collapse-face.hpp \
            src/partial-action/delete-edge-face.hpp \
            src/partial-action/delete-valence-3-vertex.hpp \
            src/partial-action/delete-vertex.hpp \
+           src/partial-action/extend-domain.hpp \
            src/partial-action/flip-edge.hpp \
            src/partial-action/insert-edge-face.hpp \
            src/partial-action/insert-edge-vertex.hpp \
@@ -160,6 +179,7 @@ HEADERS += \
            src/primitive/ray.hpp \
            src/primitive/sphere.hpp \
            src/primitive/triangle.hpp \
+           src/quadric.hpp \
            src/render-mode.hpp \
            src/renderer.hpp \
            src/scene.hpp \
@@ -174,8 +194,10 @@ HEADERS += \
            src/sketch/node-intersection.hpp \
            src/sketch/path.hpp \
            src/sketch/path-intersection.hpp \
+           src/sketch/preview.hpp \
            src/state.hpp \
            src/subdivision-butterfly.hpp \
+           src/subdivision-loop.hpp \
            src/time-delta.hpp \
            src/tool.hpp \
            src/tool/move-camera.hpp \
@@ -206,6 +228,7 @@ HEADERS += \
            src/winged/face.hpp \
            src/winged/face-intersection.hpp \
            src/winged/fwd.hpp \
+           src/winged/log.hpp \
            src/winged/mesh.hpp \
            src/winged/util.hpp \
            src/winged/vertex.hpp \
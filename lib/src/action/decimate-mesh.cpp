@@ -0,0 +1,232 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <chrono>
+#include <glm/glm.hpp>
+#include <glm/gtx/norm.hpp>
+#include <limits>
+#include <vector>
+#include "action/decimate-mesh.hpp"
+#include "adjacent-iterator.hpp"
+#include "affected-faces.hpp"
+#include "mesh.hpp"
+#include "partial-action/collapse-edge.hpp"
+#include "partial-action/collapse-edges.hpp"
+#include "primitive/plane.hpp"
+#include "quadric.hpp"
+#include "util.hpp"
+#include "winged/edge.hpp"
+#include "winged/face.hpp"
+#include "winged/mesh.hpp"
+#include "winged/vertex.hpp"
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  constexpr float infiniteCost = std::numeric_limits <float>::max ();
+
+  /** Each vertex accumulates the quadrics of the planes of its adjacent faces, weighted by
+   * their areas.
+   * A collapse sums the quadrics of the collapsed vertices, such that the quadric of a
+   * vertex measures the distance to all original faces it replaces. */
+  class Quadrics {
+    public:
+      Quadrics (const WingedMesh& mesh)
+        : quadrics (mesh.mesh ().numVertices ())
+      {
+        mesh.forEachConstFace ([this, &mesh] (const WingedFace& face) {
+          const glm::vec3 p0     = face.vertexRef (0).position (mesh);
+          const glm::vec3 p1     = face.vertexRef (1).position (mesh);
+          const glm::vec3 p2     = face.vertexRef (2).position (mesh);
+          const glm::vec3 cross  = glm::cross (p1 - p0, p2 - p0);
+          const float     length = glm::length (cross);
+
+          if (length > 0.0f) {
+            const Quadric quadric (PrimPlane (p0, cross), 0.5f * length);
+
+            for (unsigned int i = 0; i < 3; i++) {
+              this->quadrics [face.vertexRef (i).index ()].add (quadric);
+            }
+          }
+        });
+      }
+
+      Quadric quadric (const WingedEdge& edge) const {
+        Quadric quadric = this->quadrics.at (edge.vertex1Ref ().index ());
+        quadric.add (this->quadrics.at (edge.vertex2Ref ().index ()));
+        return quadric;
+      }
+
+      void set (const WingedVertex& vertex, const Quadric& quadric) {
+        if (vertex.index () >= this->quadrics.size ()) {
+          this->quadrics.resize (vertex.index () + 1);
+        }
+        this->quadrics [vertex.index ()] = quadric;
+      }
+
+    private:
+      std::vector <Quadric> quadrics;
+  };
+
+  /** `collapsePosition (m,e,q)` is the position of minimal error of quadric `q`, if it is
+   * unique and near `e`.
+   * Otherwise, it is the vertex or the middle of `e` with the smallest error. */
+  glm::vec3 collapsePosition (const WingedMesh& mesh, const WingedEdge& edge, const Quadric& q) {
+    const glm::vec3 middle = edge.middle (mesh);
+    glm::vec3       position;
+
+    if (q.minimize (position) && glm::distance2 (position, middle) <= edge.lengthSqr (mesh)) {
+      return position;
+    }
+    else {
+      const glm::vec3 candidates[] = { middle
+                                     , edge.vertex1Ref ().position (mesh)
+                                     , edge.vertex2Ref ().position (mesh) };
+      position = middle;
+
+      for (const glm::vec3& c : candidates) {
+        if (q.error (c) < q.error (position)) {
+          position = c;
+        }
+      }
+      return position;
+    }
+  }
+
+  // `flipsFace (m,e,p)` checks if collapsing `e` at position `p` flips an adjacent face
+  bool flipsFace (const WingedMesh& mesh, const WingedEdge& edge, const glm::vec3& position) {
+    auto check = [&] (const WingedVertex& vertex) -> bool {
+      for (const WingedFace& face : vertex.adjacentFaces ()) {
+        if (&face == edge.leftFace () || &face == edge.rightFace ()) {
+          continue;
+        }
+        glm::vec3 oldPositions[3];
+        glm::vec3 newPositions[3];
+
+        for (unsigned int i = 0; i < 3; i++) {
+          const WingedVertex& v = face.vertexRef (i);
+
+          oldPositions[i] = v.position (mesh);
+          newPositions[i] = v == vertex ? position : oldPositions[i];
+        }
+
+        const glm::vec3 oldCross = glm::cross ( oldPositions[1] - oldPositions[0]
+                                              , oldPositions[2] - oldPositions[1] );
+        const glm::vec3 newCross = glm::cross ( newPositions[1] - newPositions[0]
+                                              , newPositions[2] - newPositions[1] );
+
+        if (glm::dot (oldCross, newCross) <= 0.0f) {
+          return true;
+        }
+      }
+      return false;
+    };
+    return check (edge.vertex1Ref ()) || check (edge.vertex2Ref ());
+  }
+}
+
+Action::DecimateStats Action :: decimateMesh ( WingedMesh& mesh, unsigned int numFaces
+                                             , const PrimPlane* mirror )
+{
+  const Clock::time_point start = Clock::now ();
+  const unsigned int      numOldFaces = mesh.numFaces ();
+  EdgePtrVec              edges;
+  unsigned int            numNegativeFaces = 0;
+  AffectedFaces           affectedFaces;
+  Quadrics                quadrics (mesh);
+
+  auto isPositive = [mirror] (const glm::vec3& p) -> bool {
+    return mirror->distance (p) > Util::epsilon ();
+  };
+
+  auto isPositiveVertex = [&mesh, &isPositive] (const WingedVertex& v) -> bool {
+    return isPositive (v.position (mesh));
+  };
+
+  if (mirror) {
+    mesh.forEachEdge ([&edges, &isPositiveVertex] (WingedEdge& e) {
+      if (isPositiveVertex (e.vertex1Ref ()) && isPositiveVertex (e.vertex2Ref ())) {
+        edges.push_back (&e);
+      }
+    });
+    /* `MeshUtil::mirror` drops faces without a vertex on the positive side, using half of
+     * the epsilon of `isPositive`. Collapses never move a vertex off the positive side, so
+     * the number of dropped faces is fixed. */
+    mesh.forEachConstFace ([&mesh, mirror, &numNegativeFaces] (const WingedFace& f) {
+      const float eps = Util::epsilon () * 0.5f;
+
+      if ( mirror->distance (f.vertexRef (0).position (mesh)) <= eps
+        && mirror->distance (f.vertexRef (1).position (mesh)) <= eps
+        && mirror->distance (f.vertexRef (2).position (mesh)) <= eps )
+      {
+        numNegativeFaces++;
+      }
+    });
+  }
+  else {
+    edges.reserve (mesh.numEdges ());
+    mesh.forEachEdge ([&edges] (WingedEdge& e) {
+      edges.push_back (&e);
+    });
+  }
+
+  const unsigned int minNumFaces = mirror ? numNegativeFaces + (numFaces / 2) : numFaces;
+
+  /* Collapses on the positive side of the mirror plane must keep all vertices on the plane.
+   * Valence-3 vertices opposite to the edge would be deleted by `collapseEdge`, which may
+   * in turn reduce the valence of a vertex on the plane to 3. */
+  auto isMirrorSafe = [&] (const WingedEdge& edge, const glm::vec3& position) -> bool {
+    if (mirror == nullptr) {
+      return true;
+    }
+    const WingedVertex& vertex3 = edge.leftSuccessorRef  ().otherVertexRef (edge.vertex2Ref ());
+    const WingedVertex& vertex4 = edge.rightSuccessorRef ().otherVertexRef (edge.vertex1Ref ());
+
+    return isPositive (position) && vertex3.valence () > 3 && vertex4.valence () > 3;
+  };
+
+  auto cost = [&] (const WingedEdge& edge) -> float {
+    const Quadric   quadric  = quadrics.quadric (edge);
+    const glm::vec3 position = collapsePosition (mesh, edge, quadric);
+
+    if (isMirrorSafe (edge, position) == false || flipsFace (mesh, edge, position)) {
+      return infiniteCost;
+    }
+    else {
+      // favours short edges on flat regions, where the quadric error vanishes
+      const float lengthSqr = edge.lengthSqr (mesh);
+      return quadric.error (position) + (0.001f * lengthSqr * lengthSqr);
+    }
+  };
+
+  auto collapse = [&] (WingedEdge& edge, AffectedFaces& faces) -> bool {
+    const Quadric   quadric  = quadrics.quadric (edge);
+    const glm::vec3 position = collapsePosition (mesh, edge, quadric);
+    WingedVertex*   vertex   = nullptr;
+
+    if (isMirrorSafe (edge, position) == false) {
+      return false;
+    }
+    else if (PartialAction::collapseEdge (mesh, edge, faces, &position, &vertex)) {
+      if (vertex) {
+        quadrics.set (*vertex, quadric);
+      }
+      return true;
+    }
+    else {
+      return false;
+    }
+  };
+
+  PartialAction::collapseEdges ( mesh, edges, cost, collapse, infiniteCost, minNumFaces
+                               , affectedFaces );
+
+  const std::chrono::duration <float> elapsed = Clock::now () - start;
+  const DecimateStats                 stats   = { numOldFaces - mesh.numFaces ()
+                                                , elapsed.count () };
+  if (mesh.isEmpty () == false) {
+    mesh.fromMesh (mesh.makePrunedMesh (), mesh.makePrunedMask (), mirror);
+  }
+  return stats;
+}
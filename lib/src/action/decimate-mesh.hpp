@@ -0,0 +1,31 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_ACTION_DECIMATE_MESH
+#define DILAY_ACTION_DECIMATE_MESH
+
+class PrimPlane;
+class WingedMesh;
+
+namespace Action {
+
+  /** `DecimateStats` are the number of faces removed by `decimateMesh` and the seconds
+   * spent collapsing edges, which exclude the final rebuild and `bufferData`. */
+  struct DecimateStats {
+    unsigned int numRemovedFaces;
+    float        collapseTime;
+  };
+
+  /** `decimateMesh (m,n,p)` collapses edges of `m` in order of increasing quadric error
+   * until `m` has at most `n` faces.
+   * Each collapse removes two or four faces, so the result has at least `n-3` faces,
+   * unless there are no collapsible edges left.
+   * If `p` is given, only the positive side of `p` is decimated and mirrored afterwards.
+   * Then, the result has between `n-7` and `n` faces, provided that no face of `m` crosses
+   * `p`, which holds for meshes that have been mirrored at `p` before. The mirroring splits
+   * crossing faces, which adds faces. */
+  DecimateStats decimateMesh (WingedMesh&, unsigned int, const PrimPlane* = nullptr);
+};
+
+#endif
@@ -33,10 +33,10 @@ void Action :: finalize (WingedMesh& mesh, AffectedFaces& affectedFaces) {
   }
   Action::collapseDegeneratedFaces (mesh, affectedFaces);
 
-  for (WingedVertex* v : affectedFaces.toVertexSet ()) {
-    v->writeInterpolatedNormal (mesh);
-  }
-  mesh.bufferData ();
+  const VertexPtrSet vertices = affectedFaces.toVertexSet ();
+
+  mesh.writeNormals (VertexPtrVec (vertices.begin (), vertices.end ()));
+  mesh.bufferData   ();
 
   assert (mesh.octree ().numDegeneratedElements () == 0);
 }
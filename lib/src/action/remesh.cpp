@@ -0,0 +1,609 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <glm/glm.hpp>
+#include <glm/gtx/norm.hpp>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include "action/remesh.hpp"
+#include "adjacent-iterator.hpp"
+#include "affected-faces.hpp"
+#include "hash.hpp"
+#include "mesh.hpp"
+#include "parallel-util.hpp"
+#include "partial-action/collapse-edges.hpp"
+#include "partial-action/relax-edge.hpp"
+#include "partial-action/smooth.hpp"
+#include "partial-action/subdivide-edge.hpp"
+#include "util.hpp"
+#include "winged/edge.hpp"
+#include "winged/face.hpp"
+#include "winged/mesh.hpp"
+#include "winged/vertex.hpp"
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  constexpr float infiniteCost = std::numeric_limits <float>::max ();
+
+  /** `timed (t,f)` calls `f` and adds the elapsed seconds to `t`. */
+  void timed (float& time, const std::function <void ()>& f) {
+    const Clock::time_point start = Clock::now ();
+
+    f ();
+
+    const std::chrono::duration <float> elapsed = Clock::now () - start;
+    time += elapsed.count ();
+  }
+
+  void addTimes (Action::RemeshTimes& times, const Action::RemeshTimes& other) {
+    times.partition += other.partition;
+    times.split     += other.split;
+    times.collapse  += other.collapse;
+    times.flip      += other.flip;
+    times.relax     += other.relax;
+    times.merge     += other.merge;
+    times.finalize  += other.finalize;
+  }
+
+  bool isMasked (const std::vector <bool>& mask, unsigned int i) {
+    return i < mask.size () && mask [i];
+  }
+
+  /** `Locks` protect parts of a mesh from the remeshing passes: pinned vertices are
+   * neither moved nor deleted, and frozen faces are neither split nor flipped nor changed
+   * by collapses.
+   * A face is frozen if one of its vertices is freezing. Freezing vertices are pinned. */
+  class Locks {
+    public:
+      Locks (std::vector <bool>&& p, std::vector <bool>&& f)
+        : pinned   (std::move (p))
+        , freezing (std::move (f))
+      {}
+
+      bool isPinned (const WingedVertex& vertex) const {
+        return isMasked (this->pinned, vertex.index ());
+      }
+
+      bool isFrozen (const WingedFace& face) const {
+        return isMasked (this->freezing, face.vertexRef (0).index ())
+            || isMasked (this->freezing, face.vertexRef (1).index ())
+            || isMasked (this->freezing, face.vertexRef (2).index ());
+      }
+
+      bool hasFrozenFace (const WingedEdge& edge) const {
+        return this->isFrozen (edge.leftFaceRef ()) || this->isFrozen (edge.rightFaceRef ());
+      }
+
+      /** `isCollapsible (e)` checks if collapsing `e` keeps all locks.
+       * `PartialAction::collapseEdge` deletes opposite vertices of valence 3, which may
+       * expose further neighbours of both vertices of `e`. */
+      bool isCollapsible (const WingedEdge& edge) const {
+        const WingedVertex& vertex1 = edge.vertex1Ref ();
+        const WingedVertex& vertex2 = edge.vertex2Ref ();
+
+        if ( this->isPinned (vertex1) || this->isPinned (vertex2)
+          || this->hasFrozenFace (vertex1) || this->hasFrozenFace (vertex2) )
+        {
+          return false;
+        }
+        else if (this->hasPinnedNeighbour (vertex1) || this->hasPinnedNeighbour (vertex2)) {
+          const WingedVertex& vertex3 = edge.leftSuccessorRef  ().otherVertexRef (vertex2);
+          const WingedVertex& vertex4 = edge.rightSuccessorRef ().otherVertexRef (vertex1);
+
+          return vertex3.valence () > 3 && vertex4.valence () > 3;
+        }
+        else {
+          return true;
+        }
+      }
+
+    private:
+      std::vector <bool> pinned;
+      std::vector <bool> freezing;
+
+      bool hasFrozenFace (const WingedVertex& vertex) const {
+        for (const WingedFace& f : vertex.adjacentFaces ()) {
+          if (this->isFrozen (f)) {
+            return true;
+          }
+        }
+        return false;
+      }
+
+      bool hasPinnedNeighbour (const WingedVertex& vertex) const {
+        for (const WingedVertex& a : vertex.adjacentVertices ()) {
+          if (this->isPinned (a)) {
+            return true;
+          }
+        }
+        return false;
+      }
+  };
+
+  void splitEdges (WingedMesh& mesh, const Locks& locks, float maxLength) {
+    const float   maxLengthSqr = maxLength * maxLength;
+    AffectedFaces affectedFaces;
+    EdgePtrVec    edges;
+
+    auto isSplittable = [&] (const WingedEdge& e) -> bool {
+      return e.lengthSqr (mesh) > maxLengthSqr && locks.hasFrozenFace (e) == false;
+    };
+
+    edges.reserve (mesh.numEdges ());
+    mesh.forEachEdge ([&] (WingedEdge& e) {
+      if (isSplittable (e)) {
+        edges.push_back (&e);
+      }
+    });
+
+    // each edge is split once at its middle like in [Botsch & Kobbelt 2004]: splitting
+    // until all edges are short does not terminate at degenerated faces
+    for (WingedEdge* e : edges) {
+      if (isSplittable (*e)) {
+        const glm::vec3 middle = e->middle (mesh);
+
+        PartialAction::subdivideEdge (mesh, *e, affectedFaces);
+
+        assert (e->vertex1Ref ().valence () == 4);
+        mesh.setVertex (e->vertex1Ref ().index (), middle);
+      }
+    }
+  }
+
+  void collapseEdges (WingedMesh& mesh, const Locks& locks, float minLength, float maxLength) {
+    const float   maxLengthSqr = maxLength * maxLength;
+    AffectedFaces affectedFaces;
+    EdgePtrVec    edges;
+
+    edges.reserve (mesh.numEdges ());
+    mesh.forEachEdge ([&edges, &locks] (WingedEdge& e) {
+      if (locks.isPinned (e.vertex1Ref ()) == false && locks.isPinned (e.vertex2Ref ()) == false) {
+        edges.push_back (&e);
+      }
+    });
+
+    // collapses that would introduce edges longer than `maxLength` are forbidden
+    auto cost = [&mesh, &locks, maxLengthSqr] (const WingedEdge& edge) -> float {
+      const glm::vec3 middle = edge.middle (mesh);
+
+      auto isShort = [&] (const WingedVertex& vertex) -> bool {
+        for (const WingedVertex& a : vertex.adjacentVertices ()) {
+          if (glm::distance2 (middle, a.position (mesh)) > maxLengthSqr) {
+            return false;
+          }
+        }
+        return true;
+      };
+
+      if ( locks.isCollapsible (edge) && isShort (edge.vertex1Ref ())
+                                      && isShort (edge.vertex2Ref ()) )
+      {
+        return edge.lengthSqr (mesh);
+      }
+      else {
+        return infiniteCost;
+      }
+    };
+
+    PartialAction::collapseEdges (mesh, edges, cost, minLength * minLength, 0, affectedFaces);
+  }
+
+  /** Flips must not connect two pinned vertices, since they may already be connected
+   * outside of the mesh, i.e. in another patch. */
+  void flipEdges (WingedMesh& mesh, const Locks& locks) {
+    AffectedFaces affectedFaces;
+
+    mesh.forEachEdge ([&mesh, &locks, &affectedFaces] (WingedEdge& e) {
+      if ( locks.hasFrozenFace (e) == false
+        && ( locks.isPinned (e.vertexRef (e.leftFaceRef  (), 2)) == false
+          || locks.isPinned (e.vertexRef (e.rightFaceRef (), 2)) == false ) )
+      {
+        PartialAction::relaxEdge (mesh, e, affectedFaces);
+      }
+    });
+  }
+
+  void relaxVertices (WingedMesh& mesh, const Locks& locks) {
+    AffectedFaces affectedFaces;
+    VertexPtrSet  vertices;
+
+    vertices.reserve (mesh.numVertices ());
+    mesh.forEachVertex ([&vertices, &locks] (WingedVertex& v) {
+      if (locks.isPinned (v) == false) {
+        vertices.insert (&v);
+      }
+    });
+    PartialAction::smooth (mesh, vertices, 1, affectedFaces);
+  }
+
+  /** `UnionFind` partitions `[0,n)` into disjoint sets. */
+  class UnionFind {
+    public:
+      UnionFind (unsigned int n)
+        : parents (n)
+      {
+        for (unsigned int i = 0; i < n; i++) {
+          this->parents [i] = i;
+        }
+      }
+
+      unsigned int find (unsigned int i) {
+        while (this->parents [i] != i) {
+          this->parents [i] = this->parents [this->parents [i]];
+          i = this->parents [i];
+        }
+        return i;
+      }
+
+      void unite (unsigned int i, unsigned int j) {
+        this->parents [this->find (i)] = this->find (j);
+      }
+
+    private:
+      std::vector <unsigned int> parents;
+  };
+
+  /** `PatchResult` is a remeshed patch: `indices` refer to vertices of the source mesh, or
+   * to `vertices` if they are offset by the number of vertices of the source mesh.
+   * `boundary` are the indices of source vertices on the boundary of the patch. */
+  struct PatchResult {
+    std::vector <glm::vec3>    vertices;
+    std::vector <unsigned int> indices;
+    std::vector <unsigned int> boundary;
+    Action::RemeshTimes        times;
+  };
+
+  /** `remeshPatch (m,mask,fs,minL,maxL)` copies the faces `fs` of `m` into a winged mesh of
+   * their own, such that patches can be remeshed in parallel.
+   * Vertices are copied per fan of adjacent faces of `fs`, so that each boundary vertex
+   * has a single outgoing boundary edge. Each boundary loop is closed by a fan of frozen
+   * faces around a cap vertex at the loop's center. Boundary vertices and masked vertices
+   * are pinned, such that the boundary and all masked faces are kept. */
+  PatchResult remeshPatch ( const Mesh& source, const std::vector <bool>& mask
+                          , const std::vector <unsigned int>& faces
+                          , float minLength, float maxLength )
+  {
+    PatchResult result;
+    result.times = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+
+    const unsigned int         numCorners = 3 * faces.size ();
+    UnionFind                  fans (numCorners);
+    std::vector <unsigned int> cornerVertices (numCorners);
+    std::vector <unsigned int> globalIndices;
+    std::vector <bool>         pinned;
+    std::vector <bool>         freezing;
+    Mesh                       patch (source, false);
+    unsigned int               numVertices = 0;
+    WingedMesh                 mesh (0);
+
+    timed (result.times.partition, [&] () {
+      std::unordered_map <ui_pair, ui_pair> edges;
+      std::vector <unsigned int>            rootVertices (numCorners, Util::invalidIndex ());
+      std::vector <unsigned int>            nextBoundary;
+
+      auto corner = [&faces] (unsigned int face, unsigned int i) -> unsigned int {
+        return (3 * face) + (i % 3);
+      };
+      auto vertex = [&source, &faces] (unsigned int c) -> unsigned int {
+        return source.index ((3 * faces [c / 3]) + (c % 3));
+      };
+
+      // directed edges map to the corners of their vertices
+      edges.reserve (numCorners);
+      for (unsigned int f = 0; f < faces.size (); f++) {
+        for (unsigned int i = 0; i < 3; i++) {
+          const unsigned int c1 = corner (f, i);
+          const unsigned int c2 = corner (f, i + 1);
+
+          edges.emplace (ui_pair (vertex (c1), vertex (c2)), ui_pair (c1, c2));
+        }
+      }
+
+      // corners of a vertex belong to the same fan if their faces share an edge
+      for (const auto& e : edges) {
+        const auto twin = edges.find (ui_pair (e.first.second, e.first.first));
+
+        if (twin != edges.end ()) {
+          fans.unite (e.second.first , twin->second.second);
+          fans.unite (e.second.second, twin->second.first);
+        }
+      }
+
+      for (unsigned int c = 0; c < numCorners; c++) {
+        const unsigned int root = fans.find (c);
+
+        if (rootVertices [root] == Util::invalidIndex ()) {
+          const unsigned int g = vertex (c);
+
+          rootVertices [root] = patch.addVertex (source.vertex (g));
+          globalIndices.push_back (g);
+          pinned       .push_back (isMasked (mask, g));
+          freezing     .push_back (isMasked (mask, g));
+        }
+        cornerVertices [c] = rootVertices [root];
+        patch.addIndex (cornerVertices [c]);
+      }
+      numVertices = patch.numVertices ();
+      nextBoundary.resize (numVertices, Util::invalidIndex ());
+
+      for (const auto& e : edges) {
+        if (edges.count (ui_pair (e.first.second, e.first.first)) == 0) {
+          const unsigned int v1 = cornerVertices [e.second.first];
+          const unsigned int v2 = cornerVertices [e.second.second];
+
+          assert (nextBoundary [v1] == Util::invalidIndex ());
+          nextBoundary [v1] = v2;
+
+          result.boundary.push_back (globalIndices [v1]);
+          pinned [v1] = true;
+        }
+      }
+
+      // cap faces contain the twins of the boundary edges
+      for (unsigned int v = 0; v < numVertices; v++) {
+        if (nextBoundary [v] == Util::invalidIndex ()) {
+          continue;
+        }
+        glm::vec3    center (0.0f);
+        unsigned int n = 0;
+
+        for (unsigned int w = v; nextBoundary [w] != Util::invalidIndex (); w = nextBoundary [w]) {
+          center += patch.vertex (w);
+          n++;
+
+          if (nextBoundary [w] == v) {
+            break;
+          }
+        }
+        const unsigned int cap = patch.addVertex (center / float (n));
+
+        pinned  .push_back (true);
+        freezing.push_back (true);
+
+        for (unsigned int w = v; nextBoundary [w] != Util::invalidIndex (); ) {
+          const unsigned int next = nextBoundary [w];
+
+          patch.addIndex (next);
+          patch.addIndex (w);
+          patch.addIndex (cap);
+
+          nextBoundary [w] = Util::invalidIndex ();
+          w = next;
+        }
+      }
+      mesh.topologyFromMesh (patch);
+    });
+
+    const Locks        locks (std::move (pinned), std::move (freezing));
+    const unsigned int numCapVertices = patch.numVertices () - numVertices;
+
+    timed (result.times.split   , [&] () { splitEdges    (mesh, locks, maxLength); });
+    timed (result.times.collapse, [&] () { collapseEdges (mesh, locks, minLength, maxLength); });
+    timed (result.times.flip    , [&] () { flipEdges     (mesh, locks); });
+    timed (result.times.relax   , [&] () { relaxVertices (mesh, locks); });
+
+    timed (result.times.merge, [&] () {
+      const unsigned int         numSourceVertices = source.numVertices ();
+      std::vector <unsigned int> newIndices (mesh.mesh ().numVertices (), Util::invalidIndex ());
+
+      auto isCap = [numVertices, numCapVertices] (unsigned int i) -> bool {
+        return i >= numVertices && i < numVertices + numCapVertices;
+      };
+
+      mesh.forEachConstVertex ([&] (const WingedVertex& v) {
+        if (v.index () < numVertices && locks.isPinned (v)) {
+          newIndices [v.index ()] = globalIndices [v.index ()];
+        }
+        else if (isCap (v.index ()) == false) {
+          newIndices [v.index ()] = numSourceVertices + result.vertices.size ();
+          result.vertices.push_back (v.position (mesh));
+        }
+      });
+      mesh.forEachConstFace ([&] (const WingedFace& f) {
+        const unsigned int i1 = f.vertexRef (0).index ();
+        const unsigned int i2 = f.vertexRef (1).index ();
+        const unsigned int i3 = f.vertexRef (2).index ();
+
+        if (isCap (i1) == false && isCap (i2) == false && isCap (i3) == false) {
+          result.indices.push_back (newIndices [i1]);
+          result.indices.push_back (newIndices [i2]);
+          result.indices.push_back (newIndices [i3]);
+        }
+      });
+    });
+    return result;
+  }
+
+  /** `remeshPatches (m,mask,ps,n,minL,maxL,t,s)` remeshes the `n` patches of `m` in
+   * parallel, where face `i` belongs to patch `ps [i]`. Faces that do not belong to any
+   * patch are kept.
+   * `mask` is updated to the returned mesh. If `s` is given, it flags the vertices of the
+   * returned mesh that are on the boundary of a patch. */
+  Mesh remeshPatches ( const Mesh& mesh, std::vector <bool>& mask
+                     , const std::vector <unsigned int>& patches, unsigned int numPatches
+                     , float minLength, float maxLength, Action::RemeshTimes& times
+                     , std::vector <bool>* seams )
+  {
+    std::vector <std::vector <unsigned int>> patchFaces (numPatches);
+    std::vector <PatchResult>                results    (numPatches);
+    Mesh                                     newMesh    (mesh, false);
+    std::vector <bool>                       newMask;
+    std::vector <unsigned int>               newIndices (mesh.numVertices (), Util::invalidIndex ());
+
+    for (unsigned int i = 0; i < patches.size (); i++) {
+      if (patches [i] != Util::invalidIndex ()) {
+        patchFaces [patches [i]].push_back (i);
+      }
+    }
+
+    ParallelUtil::forEach (numPatches, [&] (unsigned int i) {
+      results [i] = remeshPatch (mesh, mask, patchFaces [i], minLength, maxLength);
+    }, 1);
+
+    timed (times.merge, [&] () {
+      auto sourceVertex = [&] (unsigned int i) -> unsigned int {
+        if (newIndices [i] == Util::invalidIndex ()) {
+          newIndices [i] = newMesh.addVertex (mesh.vertex (i));
+          newMask.push_back (isMasked (mask, i));
+        }
+        return newIndices [i];
+      };
+
+      for (unsigned int i = 0; i < patches.size (); i++) {
+        if (patches [i] == Util::invalidIndex ()) {
+          newMesh.addIndex (sourceVertex (mesh.index ((3 * i) + 0)));
+          newMesh.addIndex (sourceVertex (mesh.index ((3 * i) + 1)));
+          newMesh.addIndex (sourceVertex (mesh.index ((3 * i) + 2)));
+        }
+      }
+      for (const PatchResult& result : results) {
+        const unsigned int offset = newMesh.numVertices ();
+
+        for (const glm::vec3& v : result.vertices) {
+          newMesh.addVertex (v);
+          newMask.push_back (false);
+        }
+        for (unsigned int i : result.indices) {
+          newMesh.addIndex (i < mesh.numVertices () ? sourceVertex (i)
+                                                    : offset + i - mesh.numVertices ());
+        }
+      }
+      if (seams) {
+        seams->assign (newMesh.numVertices (), false);
+
+        for (const PatchResult& result : results) {
+          for (unsigned int i : result.boundary) {
+            if (newIndices [i] != Util::invalidIndex ()) {
+              (*seams) [newIndices [i]] = true;
+            }
+          }
+        }
+      }
+    });
+    for (const PatchResult& result : results) {
+      addTimes (times, result.times);
+    }
+    mask = std::move (newMask);
+    return newMesh;
+  }
+
+  /** `gridPatches (m,l,s,n)` partitions the faces of `m` by the cells of a grid, where
+   * each cell is a patch. There are about four cells per thread, unless cells would become
+   * smaller than `8l`. If `s` is set, the grid is shifted by half a cell. */
+  std::vector <unsigned int> gridPatches ( const Mesh& mesh, float maxLength, bool shift
+                                         , unsigned int& numPatches )
+  {
+    std::vector <unsigned int> patches (mesh.numIndices () / 3, 0);
+    glm::vec3                  min, max;
+
+    numPatches = patches.empty () ? 0 : 1;
+    if (ParallelUtil::numThreads () == 1 || patches.empty ()) {
+      return patches;
+    }
+    mesh.minMax (min, max);
+
+    const float        extent   = glm::max (max.x - min.x, glm::max (max.y - min.y, max.z - min.z));
+    const unsigned int maxCells = (unsigned int) (extent / (8.0f * maxLength));
+    const unsigned int numCells = glm::min ( maxCells, (unsigned int) std::ceil (std::cbrt (
+                                               4.0f * float (ParallelUtil::numThreads ()))) );
+    if (numCells <= 1) {
+      return patches;
+    }
+    const float                cellSize  = extent / float (numCells);
+    const float                offset    = shift ? 0.5f : 0.0f;
+    const unsigned int         dimension = numCells + 1;
+    std::vector <unsigned int> cells (dimension * dimension * dimension, Util::invalidIndex ());
+
+    numPatches = 0;
+    for (unsigned int i = 0; i < patches.size (); i++) {
+      const glm::vec3 center = ( mesh.vertex (mesh.index ((3 * i) + 0))
+                               + mesh.vertex (mesh.index ((3 * i) + 1))
+                               + mesh.vertex (mesh.index ((3 * i) + 2)) ) / 3.0f;
+      const glm::uvec3 cell = glm::min ( glm::uvec3 (((center - min) / cellSize) + offset)
+                                       , glm::uvec3 (numCells) );
+      unsigned int& patch = cells [cell.x + (dimension * (cell.y + (dimension * cell.z)))];
+
+      if (patch == Util::invalidIndex ()) {
+        patch = numPatches++;
+      }
+      patches [i] = patch;
+    }
+    return patches;
+  }
+
+  /** `seamPatch (m,s,n)` puts all faces of `m` with a vertex flagged by `s` into a
+   * single patch. */
+  std::vector <unsigned int> seamPatch ( const Mesh& mesh, const std::vector <bool>& seams
+                                       , unsigned int& numPatches )
+  {
+    std::vector <unsigned int> patches (mesh.numIndices () / 3, Util::invalidIndex ());
+
+    numPatches = 0;
+    for (unsigned int i = 0; i < patches.size (); i++) {
+      if ( seams [mesh.index ((3 * i) + 0)] || seams [mesh.index ((3 * i) + 1)]
+                                            || seams [mesh.index ((3 * i) + 2)] )
+      {
+        patches [i] = 0;
+        numPatches  = 1;
+      }
+    }
+    return patches;
+  }
+}
+
+Action::RemeshTimes Action :: remesh ( WingedMesh& mesh, float targetLength
+                                     , unsigned int numIterations )
+{
+  assert (targetLength > 0.0f);
+
+  const Clock::time_point start     = Clock::now ();
+  const float             minLength = (4.0f / 5.0f) * targetLength;
+  const float             maxLength = (4.0f / 3.0f) * targetLength;
+  RemeshTimes             times     = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+  Mesh                    remeshed  = mesh.makePrunedMesh ();
+  std::vector <bool>      mask      = mesh.makePrunedMask ();
+  std::vector <bool>      seams;
+  unsigned int            numPatches;
+
+  for (unsigned int i = 0; i < numIterations && remeshed.numIndices () > 0; i++) {
+    std::vector <unsigned int> patches;
+
+    timed (times.partition, [&] () {
+      patches = gridPatches (remeshed, maxLength, i % 2 == 1, numPatches);
+    });
+    remeshed = remeshPatches ( remeshed, mask, patches, numPatches, minLength, maxLength
+                             , times, &seams );
+  }
+
+  // boundaries of the last iteration's patches are remeshed in a single patch
+  if (seams.empty () == false) {
+    std::vector <unsigned int> patches;
+
+    timed (times.partition, [&] () {
+      patches = seamPatch (remeshed, seams, numPatches);
+    });
+    if (numPatches > 0) {
+      remeshed = remeshPatches ( remeshed, mask, patches, numPatches, minLength, maxLength
+                               , times, nullptr );
+    }
+  }
+
+  timed (times.finalize, [&] () {
+    if (remeshed.numIndices () > 0) {
+      mesh.fromMesh (remeshed, mask);
+    }
+    else {
+      mesh.reset ();
+    }
+  });
+
+  const std::chrono::duration <float> elapsed = Clock::now () - start;
+  times.total = elapsed.count ();
+  return times;
+}
@@ -0,0 +1,37 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_ACTION_REMESH
+#define DILAY_ACTION_REMESH
+
+class WingedMesh;
+
+namespace Action {
+
+  /** `RemeshTimes` are the seconds spent in each pass of `remesh`. The passes of all
+   * patches are summed up, i.e. they may exceed the `total` elapsed time. */
+  struct RemeshTimes {
+    float partition;
+    float split;
+    float collapse;
+    float flip;
+    float relax;
+    float merge;
+    float finalize;
+    float total;
+  };
+
+  /** `remesh (m,l,n)` runs `n` iterations of isotropic remeshing with target edge length `l`:
+   * edges longer than `4l/3` are split, edges shorter than `4l/5` are collapsed, edges are
+   * flipped to improve valences, and vertices are relaxed tangentially.
+   * Masked vertices are kept and faces with masked vertices are neither split, flipped nor
+   * changed by collapses.
+   * Each iteration partitions the mesh into patches by the cells of a grid, which are
+   * remeshed in parallel. Patch boundaries are kept, and the grid is shifted by half a cell
+   * in every other iteration. Finally, the boundaries of the last iteration's patches are
+   * remeshed on their own. */
+  RemeshTimes remesh (WingedMesh&, float, unsigned int = 5);
+};
+
+#endif
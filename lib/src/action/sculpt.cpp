@@ -2,73 +2,156 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <chrono>
 #include <glm/glm.hpp>
 #include <glm/gtx/norm.hpp>
+#include <limits>
+#include <queue>
 #include "action/finalize.hpp"
+#include "adjacent-iterator.hpp"
 #include "action/sculpt.hpp"
 #include "affected-faces.hpp"
 #include "sculpt-brush.hpp"
-#include "partial-action/collapse-edge.hpp"
+#include "partial-action/collapse-edges.hpp"
+#include "partial-action/extend-domain.hpp"
 #include "partial-action/relax-edge.hpp"
 #include "partial-action/smooth.hpp"
 #include "partial-action/subdivide-edge.hpp"
+#include "primitive/plane.hpp"
 #include "winged/edge.hpp"
 #include "winged/mesh.hpp"
 #include "winged/util.hpp"
+#include "winged/vertex.hpp"
 
 namespace {
-  void postprocessEdges (const SculptBrush& brush, AffectedFaces& domain) {
+  void postprocessEdges (SculptBrush& brush, const PrimPlane* mirror, AffectedFaces& domain) {
     const float maxLength    ((4.0f/3.0f) * brush.subdivThreshold ());
     const float maxLengthSqr (maxLength * maxLength);
     WingedMesh& mesh         (brush.meshRef ());
 
+    // edges of masked faces are neither subdivided nor relaxed
+    auto hasMaskedFace = [&mesh] (const WingedEdge& edge) -> bool {
+      return mesh.isMasked (edge.leftFaceRef ()) || mesh.isMasked (edge.rightFaceRef ());
+    };
+
+    // edges are not collapsed if a masked face is adjacent to one of their vertices
+    auto hasMaskedNeighbourhood = [&mesh] (const WingedEdge& edge) -> bool {
+      if (mesh.hasMask ()) {
+        for (const WingedFace& f : edge.vertex1Ref ().adjacentFaces ()) {
+          if (mesh.isMasked (f)) {
+            return true;
+          }
+        }
+        for (const WingedFace& f : edge.vertex2Ref ().adjacentFaces ()) {
+          if (mesh.isMasked (f)) {
+            return true;
+          }
+        }
+      }
+      return false;
+    };
+
     auto isSubdividable = [&] (WingedEdge& edge) -> bool {
-      return edge.lengthSqr (mesh) > maxLengthSqr;
+      return edge.lengthSqr (mesh) > maxLengthSqr && hasMaskedFace (edge) == false;
     };
 
-    auto subdivideEdges = [&] () {
-      for (WingedEdge* e : domain.toEdgeVec ()) {
-        if (isSubdividable (*e)) {
-          PartialAction::subdivideEdge (mesh, *e, domain);
+    // slots of pending edges may have been freed and reused by other edges in the meantime
+    auto pendingEdge = [&mesh] (const SBPendingEdge& p) -> WingedEdge* {
+      WingedEdge* e = mesh.edge (p.edge);
+
+      return e && e->vertex1Ref ().index () == p.vertex1 && e->vertex2Ref ().index () == p.vertex2
+           ? e : nullptr;
+    };
+
+    auto insertPendingEdges = [&] () {
+      for (const SBPendingEdge& p : brush.pendingEdges ()) {
+        WingedEdge* e = pendingEdge (p);
+
+        if (e && hasMaskedFace (*e) == false) {
+          domain.insert (e->leftFaceRef  ());
+          domain.insert (e->rightFaceRef ());
         }
       }
+      brush.pendingEdges ().clear ();
       domain.commit ();
     };
 
-    auto isCollapsable = [&] (WingedEdge& edge, float avgLength) -> bool {
-      const auto& params = brush.constParameters <SBReduceParameters> ();
-      const float l2     = avgLength * avgLength;
-      const float i2     = params.intensity () * params.intensity ();
-      return edge.lengthSqr (mesh) < l2 * i2;
+    // longer edges that are closer to the brush's center (or its mirrored center) are
+    // subdivided first
+    auto priority = [&] (const WingedEdge& edge) -> float {
+      const glm::vec3 middle      = edge.middle (mesh);
+      const float     radiusSqr   = brush.radius () * brush.radius ();
+      const float     distanceSqr = mirror
+        ? glm::min ( glm::distance2 (middle, brush.position ())
+                   , glm::distance2 (middle, mirror->mirror (brush.position ())) )
+        : glm::distance2 (middle, brush.position ());
+
+      return edge.lengthSqr (mesh) / (1.0f + (distanceSqr / radiusSqr));
     };
 
-    auto collapseEdges = [&] () {
-      EdgePtrVec                 edges     = domain.toEdgeVec ();
-      const float                avgLength = WingedUtil::averageLength (mesh, edges);
-      std::vector <unsigned int> indices;
+    auto subdivideEdges = [&] () {
+      typedef std::pair <float, unsigned int> Candidate;
+      typedef std::chrono::steady_clock       Clock;
+
+      std::priority_queue <Candidate> candidates;
 
-      for (WingedEdge* e : edges) {
-        indices.push_back (e->index ());
+      for (WingedEdge* e : domain.toEdgeVec ()) {
+        if (isSubdividable (*e)) {
+          candidates.emplace (priority (*e), e->index ());
+        }
       }
-      domain.reset ();
 
-      for (unsigned int i : indices) {
-        WingedEdge* e = mesh.edge (i);
+      const Clock::time_point start    = Clock::now ();
+      const unsigned int      maxFaces = mesh.numFaces () + brush.faceBudget ();
+      const float             maxTime  = brush.timeBudget ();
 
-        if (e && isCollapsable (*e, avgLength)) {
-          PartialAction::collapseEdge (mesh, *e, domain);
+      while (candidates.empty () == false) {
+        const std::chrono::duration <float> elapsed = Clock::now () - start;
 
-          if (mesh.isEmpty ()) {
-            return;
-          }
+        if (mesh.numFaces () >= maxFaces || elapsed.count () >= maxTime) {
+          break;
+        }
+        WingedEdge* e = mesh.edge (candidates.top ().second);
+        candidates.pop ();
+
+        if (e && isSubdividable (*e)) {
+          PartialAction::subdivideEdge (mesh, *e, domain);
         }
       }
+
+      while (candidates.empty () == false) {
+        WingedEdge* e = mesh.edge (candidates.top ().second);
+        candidates.pop ();
+
+        if (e) {
+          brush.pendingEdges ().push_back ({ e->index (), e->vertex1Ref ().index ()
+                                           , e->vertex2Ref ().index () });
+        }
+      }
+      domain.commit ();
+    };
+
+    auto collapseEdges = [&] () {
+      const EdgePtrVec edges     = domain.toEdgeVec ();
+      const auto&      params    = brush.constParameters <SBReduceParameters> ();
+      const float      avgLength = WingedUtil::averageLength (mesh, edges);
+      const float      maxLength = avgLength * params.intensity ();
+
+      auto cost = [&mesh, &hasMaskedNeighbourhood] (const WingedEdge& edge) {
+        return hasMaskedNeighbourhood (edge) ? std::numeric_limits <float>::infinity ()
+                                             : edge.lengthSqr (mesh);
+      };
+
+      domain.reset ();
+      PartialAction::collapseEdges (mesh, edges, cost, maxLength * maxLength, 0, domain);
       domain.commit ();
     };
 
     auto relaxEdges = [&] () {
       for (WingedEdge* e : domain.toEdgeVec ()) {
-        PartialAction::relaxEdge (mesh, *e, domain);
+        if (hasMaskedFace (*e) == false) {
+          PartialAction::relaxEdge (mesh, *e, domain);
+        }
       }
       domain.commit ();
     };
@@ -85,9 +168,10 @@ namespace {
       }
     }
     else {
-      PartialAction::extendDomain (domain);
+      PartialAction::extendDomain (mesh, domain, brush.domainRings ());
       if (brush.subdivide ()) {
-        subdivideEdges ();
+        insertPendingEdges ();
+        subdivideEdges     ();
       }
     }
     relaxEdges     ();
@@ -95,13 +179,24 @@ namespace {
   }
 }
 
-void Action :: sculpt (const SculptBrush& brush) { 
+void Action :: sculpt (SculptBrush& brush, const PrimPlane* mirror) {
   AffectedFaces domain;
 
   brush.sculpt (domain);
 
+  if (mirror) {
+    AffectedFaces mirroredDomain;
+
+    brush.mirror (*mirror);
+    brush.sculpt (mirroredDomain);
+    brush.mirror (*mirror);
+
+    domain.insert (mirroredDomain);
+    domain.commit ();
+  }
+
   if (domain.isEmpty () == false) {
-    postprocessEdges (brush, domain);
+    postprocessEdges (brush, mirror, domain);
   }
   if (brush.meshRef ().isEmpty () == false) {
     Action::finalize (brush.meshRef (), domain);
@@ -5,12 +5,16 @@
 #ifndef DILAY_ACTION_SCULPT
 #define DILAY_ACTION_SCULPT
 
+class PrimPlane;
 class SculptBrush;
 class WingedMesh;
 
 namespace Action {
 
-  void sculpt     (const SculptBrush&);
+  /** `sculpt (b,p)` sculpts with brush `b`.
+   * If a mirror plane `p` is given, `b` is also applied on the mirrored side of `p`.
+   * Both sides are postprocessed and finalized in a single pass. */
+  void sculpt     (SculptBrush&, const PrimPlane* = nullptr);
   void smoothMesh (WingedMesh&);
 };
 
@@ -3,33 +3,339 @@
  * Use and redistribute under the terms of the GNU General Public License
  */
 #include <glm/glm.hpp>
+#include "action/finalize.hpp"
 #include "action/subdivide-mesh.hpp"
+#include "adjacent-iterator.hpp"
 #include "affected-faces.hpp"
+#include "mesh.hpp"
+#include "multi-res.hpp"
+#include "parallel-util.hpp"
 #include "partial-action/insert-edge-vertex.hpp"
+#include "partial-action/subdivide-edge.hpp"
 #include "partial-action/triangulate-6-gon.hpp"
 #include "subdivision-butterfly.hpp"
+#include "subdivision-loop.hpp"
+#include "util.hpp"
+#include "winged/edge.hpp"
+#include "winged/face.hpp"
 #include "winged/mesh.hpp"
+#include "winged/vertex.hpp"
 
-void Action::subdivideMesh (WingedMesh& mesh) {
-  AffectedFaces affected;
-  mesh.forEachFace ([&affected] (WingedFace& f) {
-    affected.insert (f);
+namespace {
+  WingedEdge& findEdge (WingedMesh& mesh, unsigned int index1, unsigned int index2) {
+    WingedVertex& v1 = mesh.vertexRef (index1);
+
+    for (WingedEdge& e : v1.adjacentEdges ()) {
+      if (e.otherVertexRef (v1).index () == index2) {
+        return e;
+      }
+    }
+    DILAY_IMPOSSIBLE
+  }
+
+  /** `predictions (m,l)` subdivides the parent edges of level `l` of the coarse mesh `m`
+   * with the butterfly scheme, without modifying `m`. */
+  std::vector <glm::vec3> predictions (WingedMesh& mesh, const MultiResLevel& level) {
+    std::vector <glm::vec3> positions (level.parents.size ());
+
+    ParallelUtil::forEachRange (positions.size (), [&] (unsigned int begin, unsigned int end) {
+      SubdivisionButterfly::Adjacents a1;
+      SubdivisionButterfly::Adjacents a2;
+
+      for (unsigned int i = begin; i < end; i++) {
+        WingedEdge& edge = findEdge (mesh, level.parents [i].first, level.parents [i].second);
+
+        positions [i] = SubdivisionButterfly::subdivideEdge (mesh, edge, a1, a2);
+      }
+    });
+    return positions;
+  }
+
+  /** `subdivide (m,es,p)` splits each edge `es [i]` at `p (i)` and triangulates all faces.
+   * Data is not buffered. */
+  void subdivide ( WingedMesh& mesh, const EdgePtrVec& edges
+                 , const std::function <glm::vec3 (unsigned int)>& position )
+  {
+    AffectedFaces affected;
+
+    mesh.forEachFace ([&affected] (WingedFace& f) {
+      affected.insert (f);
+    });
+    affected.commit ();
+
+    // subdivide edges
+    for (unsigned int i = 0; i < edges.size (); i++) {
+      PartialAction::insertEdgeVertex (mesh, *edges [i], position (i));
+    }
+
+    // triangulate faces
+    for (WingedFace* f : affected.faces ()) {
+      PartialAction::triangulate6Gon (mesh, *f, affected);
+    }
+
+    mesh.writeAllIndices ();
+    mesh.writeAllNormals ();
+    mesh.realignAllFaces ();
+  }
+
+  /** `refine (m,l)` subdivides the coarse mesh `m` of level `l` into its finer level. */
+  void refine (WingedMesh& mesh, const MultiResLevel& level) {
+    const std::vector <glm::vec3> predicted = predictions (mesh, level);
+    EdgePtrVec                    edges;
+
+    // edges are split in the recorded order, so that new vertices get the same indices
+    edges.reserve (level.parents.size ());
+    for (const std::pair <unsigned int, unsigned int>& p : level.parents) {
+      edges.push_back (&findEdge (mesh, p.first, p.second));
+    }
+    subdivide (mesh, edges, [&predicted, &level] (unsigned int i) {
+      return predicted [i] + level.details [i];
+    });
+  }
+}
+
+void Action::subdivideMesh (WingedMesh& mesh, SubdivisionScheme scheme) {
+  MultiRes&     multiRes = mesh.multiRes ();
+  MultiResLevel level;
+
+  // Loop subdivision moves the vertices of the coarse level, which is not supported by
+  // multi-resolution levels
+  if (scheme == SubdivisionScheme::Loop || multiRes.isOutdated (mesh)) {
+    multiRes.reset ();
+  }
+
+  // new vertices must be indexed consecutively and the coarse level must not contain
+  // free slots: the mesh is only rebuilt if its slots are fragmented, which changes the
+  // topology of its current level
+  if ( mesh.numVertices () != mesh.mesh ().numVertices ()
+    || mesh.numFaces () != mesh.mesh ().numIndices () / 3 )
+  {
+    multiRes.reset ();
+    mesh.fromMesh  (mesh.makePrunedMesh (), mesh.makePrunedMask ());
+  }
+
+#ifndef NDEBUG
+  const unsigned int numVertices = mesh.numVertices ();
+  const unsigned int numEdges    = mesh.numEdges    ();
+  const unsigned int numFaces    = mesh.numFaces    ();
+#endif
+  EdgePtrVec edges;
+
+  edges.reserve (mesh.numEdges ());
+  mesh.forEachEdge ([&edges, &level] (WingedEdge& e) {
+    edges.push_back (&e);
+    level.parents.emplace_back (e.vertex1Ref ().index (), e.vertex2Ref ().index ());
   });
-  affected.commit ();
 
-  // subdivide edges
-  for (WingedEdge* e : affected.toEdgeVec ()) {
-    const glm::vec3 p = SubdivisionButterfly::subdivideEdge (mesh, *e);
-    PartialAction::insertEdgeVertex (mesh, *e , p);
+  level.coarse         = mesh.mesh ();
+  level.coarseTopology = MultiRes::topology (mesh);
+
+  // all new positions are computed on the unmodified mesh
+  std::vector <glm::vec3> positions (edges.size ());
+
+  if (scheme == SubdivisionScheme::Butterfly) {
+    ParallelUtil::forEachRange (edges.size (), [&] (unsigned int begin, unsigned int end) {
+      SubdivisionButterfly::Adjacents a1;
+      SubdivisionButterfly::Adjacents a2;
+
+      for (unsigned int i = begin; i < end; i++) {
+        positions [i] = SubdivisionButterfly::subdivideEdge (mesh, *edges [i], a1, a2);
+      }
+    });
   }
+  else {
+    VertexPtrVec            vertices;
+    std::vector <glm::vec3> vertexPositions (mesh.numVertices ());
+
+    vertices.reserve (mesh.numVertices ());
+    mesh.forEachVertex ([&vertices] (WingedVertex& v) {
+      vertices.push_back (&v);
+    });
 
-  // triangulate faces
-  for (WingedFace* f : affected.faces ()) {
-    PartialAction::triangulate6Gon (mesh, *f, affected);
+    ParallelUtil::forEach (edges.size (), [&mesh, &edges, &positions] (unsigned int i) {
+      positions [i] = SubdivisionLoop::subdivideEdge (mesh, *edges [i]);
+    });
+    ParallelUtil::forEach (vertices.size (), [&mesh, &vertices, &vertexPositions] (unsigned int i) {
+      vertexPositions [i] = SubdivisionLoop::smoothVertex (mesh, *vertices [i]);
+    });
+    for (unsigned int i = 0; i < vertices.size (); i++) {
+      vertices [i]->writePosition (mesh, vertexPositions [i]);
+    }
   }
 
-  mesh.writeAllIndices ();
-  mesh.writeAllNormals ();
-  mesh.realignAllFaces ();
-  mesh.bufferData      ();
+  subdivide (mesh, edges, [&positions] (unsigned int i) {
+    return positions [i];
+  });
+  mesh.bufferData ();
+
+  // each edge gets a new vertex and each face is split into four faces by three new edges
+  assert (mesh.numVertices () == numVertices + numEdges);
+  assert (mesh.numEdges    () == (2 * numEdges) + (3 * numFaces));
+  assert (mesh.numFaces    () == 4 * numFaces);
+
+  // new vertices are not displaced from their butterfly positions yet
+  if (scheme == SubdivisionScheme::Butterfly) {
+    level.fineTopology = MultiRes::topology (mesh);
+    level.details.assign (level.parents.size (), glm::vec3 (0.0f));
+
+    multiRes.addLevel (std::move (level));
+  }
+}
+
+void Action::subdivideMeshAdaptively ( WingedMesh& mesh, float maxLength
+                                     , float maxAngle, float minLength )
+{
+  assert (minLength > 0.0f);
+
+  // each pass roughly halves the length of all subdividable edges
+  const unsigned int maxNumPasses = 20;
+  const float        maxLengthSqr = maxLength * maxLength;
+  const float        minLengthSqr = minLength * minLength;
+  const float        minCos       = glm::cos (maxAngle);
+  AffectedFaces      domain;
+  EdgePtrVec         edges;
+
+  auto normal = [&mesh] (const WingedFace& face) -> glm::vec3 {
+    const glm::vec3 v1 = face.vertexRef (0).position (mesh);
+    const glm::vec3 v2 = face.vertexRef (1).position (mesh);
+    const glm::vec3 v3 = face.vertexRef (2).position (mesh);
+    const glm::vec3 n  = glm::cross (v2 - v1, v3 - v2);
+
+    return glm::dot (n, n) > 0.0f ? glm::normalize (n) : n;
+  };
+
+  // edges are split if they are too long or if they are long enough and the angle
+  // between their adjacent faces is too large
+  auto isSubdividable = [&] (const WingedEdge& edge) -> bool {
+    const float lengthSqr = edge.lengthSqr (mesh);
+
+    if (lengthSqr > maxLengthSqr) {
+      return true;
+    }
+    else if (lengthSqr > minLengthSqr) {
+      const float cos = glm::dot ( normal (edge.leftFaceRef  ())
+                                 , normal (edge.rightFaceRef ()) );
+      return cos < minCos;
+    }
+    else {
+      return false;
+    }
+  };
+
+  auto collectEdges = [&] () {
+    edges.clear ();
+    mesh.forEachEdge ([&] (WingedEdge& e) {
+      if (isSubdividable (e)) {
+        edges.push_back (&e);
+      }
+    });
+  };
+
+  // adaptive subdivision changes the topology of multi-resolution levels
+  mesh.multiRes ().reset ();
+
+#ifndef NDEBUG
+  auto eulerCharacteristic = [&mesh] () -> int {
+    return int (mesh.numVertices ()) - int (mesh.numEdges ()) + int (mesh.numFaces ());
+  };
+  const int oldEulerCharacteristic = eulerCharacteristic ();
+#endif
+
+  collectEdges ();
+  for (unsigned int i = 0; i < maxNumPasses && edges.empty () == false; i++) {
+    for (WingedEdge* e : edges) {
+      if (isSubdividable (*e)) {
+        PartialAction::subdivideEdge (mesh, *e, domain);
+      }
+    }
+    domain.commit ();
+    collectEdges  ();
+  }
+
+  // edge splits keep the topology of the surface
+  assert (eulerCharacteristic () == oldEulerCharacteristic);
+
+  if (domain.isEmpty () == false) {
+    Action::finalize (mesh, domain);
+  }
+}
+
+bool Action::coarsenMesh (WingedMesh& mesh) {
+  MultiRes& multiRes = mesh.multiRes ();
+
+  if (multiRes.currentLevel () == 0) {
+    return false;
+  }
+  MultiResLevel& level = multiRes.level (multiRes.currentLevel () - 1);
+
+  if (MultiRes::topology (mesh) != level.fineTopology) {
+    multiRes.reset ();
+    return false;
+  }
+  const unsigned int      numCoarseVertices = level.coarse.numVertices ();
+  Mesh                    coarse (level.coarse);
+  std::vector <glm::vec3> fine (level.parents.size ());
+  std::vector <bool>      mask (mesh.mask ());
+
+  for (unsigned int i = 0; i < level.parents.size (); i++) {
+    fine [i] = mesh.vector (numCoarseVertices + i);
+  }
+
+  for (unsigned int i = 0; i < numCoarseVertices; i++) {
+    coarse.setVertex (i, mesh.vector (i));
+  }
+  if (mask.size () > numCoarseVertices) {
+    mask.resize (numCoarseVertices);
+  }
+  mesh.fromMesh         (coarse, mask);
+  multiRes.currentLevel (multiRes.currentLevel () - 1);
+
+  // degenerated faces of the coarse level have been collapsed
+  if (MultiRes::topology (mesh) != level.coarseTopology) {
+    multiRes.reset ();
+    return true;
+  }
+  const std::vector <glm::vec3> predicted = predictions (mesh, level);
+
+  for (unsigned int i = 0; i < level.parents.size (); i++) {
+    level.details [i] = fine [i] - predicted [i];
+  }
+  return true;
+}
+
+bool Action::refineMesh (WingedMesh& mesh) {
+  MultiRes& multiRes = mesh.multiRes ();
+
+  if (multiRes.currentLevel () + 1 >= multiRes.numLevels ()) {
+    return false;
+  }
+  MultiResLevel& level = multiRes.level (multiRes.currentLevel ());
+
+  if (MultiRes::topology (mesh) != level.coarseTopology) {
+    multiRes.reset ();
+    return false;
+  }
+  refine          (mesh, level);
+  mesh.bufferData ();
+
+  level.fineTopology = MultiRes::topology (mesh);
+  multiRes.currentLevel (multiRes.currentLevel () + 1);
+  return true;
+}
+
+bool Action::finestLevel (WingedMesh& mesh, Mesh& finest) {
+  MultiRes& multiRes = mesh.multiRes ();
+
+  if (multiRes.currentLevel () + 1 >= multiRes.numLevels () || multiRes.isOutdated (mesh)) {
+    return false;
+  }
+  WingedMesh finer (mesh.index ());
+
+  finer.topologyFromMesh (mesh.mesh ());
+
+  for (unsigned int i = multiRes.currentLevel (); i + 1 < multiRes.numLevels (); i++) {
+    refine (finer, multiRes.level (i));
+  }
+  finest = finer.mesh ();
+  return true;
 }
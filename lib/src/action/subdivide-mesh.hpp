@@ -5,11 +5,43 @@
 #ifndef DILAY_ACTION_SUBDIVIDE_MESH
 #define DILAY_ACTION_SUBDIVIDE_MESH
 
+class Mesh;
 class WingedMesh;
 
 namespace Action {
 
-  void subdivideMesh (WingedMesh&);
+  enum class SubdivisionScheme { Butterfly, Loop };
+
+  /** `subdivideMesh (m,s)` subdivides all faces of `m` with scheme `s`.
+   * Butterfly subdivision adds a new level to `m`'s multi-resolution levels, Loop
+   * subdivision discards all levels. */
+  void subdivideMesh (WingedMesh&, SubdivisionScheme = SubdivisionScheme::Butterfly);
+
+  /** `subdivideMeshAdaptively (m,maxL,maxA,minL)` splits edges of `m` that are longer than
+   * `maxL`, or that are longer than `minL` while the normals of their adjacent faces
+   * differ by more than `maxA` (in radians), until there are no such edges or a maximum
+   * number of passes is reached. `minL` must be positive.
+   * Multi-resolution levels of `m` are discarded. */
+  void subdivideMeshAdaptively (WingedMesh&, float, float, float);
+
+  /** `coarsenMesh (m)` switches `m` to its next coarser level.
+   * Displacements of the current level are kept, so that a later `refineMesh` restores
+   * them on top of all edits of the coarser level.
+   * Returns `false` if there is no coarser level or if the topology of `m` has changed
+   * since its current level was created, in which case all levels are discarded. */
+  bool coarsenMesh   (WingedMesh&);
+
+  /** `refineMesh (m)` switches `m` to its next finer level: new vertices are placed by
+   * butterfly subdivision of the current level and displaced by their recorded details.
+   * Returns `false` if there is no finer level or if the topology of `m` has changed,
+   * in which case all levels are discarded. */
+  bool refineMesh    (WingedMesh&);
+
+  /** `finestLevel (m,f)` sets `f` to the finest level of `m`, which is subdivided from the
+   * current level of `m`, i.e. edits of the current level are propagated to `f`.
+   * `m` is not modified.
+   * Returns `false` if `m` is at its finest level or if its levels are outdated. */
+  bool finestLevel   (WingedMesh&, Mesh&);
 };
 
 #endif
@@ -7,7 +7,7 @@
 #include "config.hpp"
 
 namespace {
-  static constexpr int latestVersion = 5;
+  static constexpr int latestVersion = 8;
 }
 
 Config :: Config () 
@@ -50,6 +50,9 @@ void Config :: restoreDefaults () {
   this->set ("editor/tool/sculpt/detail-factor",     0.75f);
   this->set ("editor/tool/sculpt/step-width-factor", 0.1f);
   this->set ("editor/tool/sculpt/cursor-color",      Color (1.0f, 0.9f, 0.9f));
+  this->set ("editor/tool/sculpt/budget/faces",      20000);
+  this->set ("editor/tool/sculpt/budget/time",       0.05f);
+  this->set ("editor/tool/sculpt/domain-rings",      2);
   this->set ("editor/tool/sculpt/mirror/width",      0.02f);
   this->set ("editor/tool/sculpt/mirror/color",      Color (0.8f, 0.8f, 0.8f));
 
@@ -57,6 +60,7 @@ void Config :: restoreDefaults () {
   this->set ("editor/tool/sketch-spheres/step-width-factor", 0.1f);
 
   this->set ("editor/undo-depth", 15);
+  this->set ("editor/num-threads", 0);
 
   this->set ("window/initial-width",  1024);
   this->set ("window/initial-height", 768);
@@ -84,6 +88,19 @@ void Config :: update () {
       this->remove ("editor/camera/up");
       break;
 
+    case 5:
+      this->set ("editor/tool/sculpt/budget/faces", 20000);
+      this->set ("editor/tool/sculpt/budget/time",  0.05f);
+      break;
+
+    case 6:
+      this->set ("editor/tool/sculpt/domain-rings", 2);
+      break;
+
+    case 7:
+      this->set ("editor/num-threads", 0);
+      break;
+
     case latestVersion:
       return;
 
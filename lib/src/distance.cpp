@@ -2,6 +2,7 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <atomic>
 #include <glm/glm.hpp>
 #include "distance.hpp"
 #include "primitive/cone.hpp"
@@ -9,13 +10,18 @@
 #include "primitive/cylinder.hpp"
 #include "primitive/sphere.hpp"
 
+#if defined (__GNUC__) && defined (__x86_64__)
+#define DILAY_DISTANCE_SIMD
+#include <immintrin.h>
+#endif
+
 namespace {
   float distanceToCylinder ( const glm::vec3& center1, float radius, float length
                            , const glm::vec3& direction, const glm::vec3& point )
   {
     const glm::vec3 toP = point - center1;
     const float x       = glm::dot (toP, direction);  
-    const float y       = glm::sqrt (glm::dot (toP, toP) - (x*x));
+    const float y       = glm::sqrt (glm::max (0.0f, glm::dot (toP, toP) - (x*x)));
     const float yr      = y - radius;
     const float xl      = x - length;
     const bool  insideR = yr <= 0.0f;
@@ -52,7 +58,7 @@ float Distance::distance (const PrimCone& cone, const glm::vec3& point) {
   else {
     const glm::vec3 toP = point - cone.center1 ();
     const float x       = glm::dot (toP, cone.direction ());  
-    const float y       = glm::sqrt (glm::dot (toP, toP) - (x * x));
+    const float y       = glm::sqrt (glm::max (0.0f, glm::dot (toP, toP) - (x * x)));
     const float r1      = cone.radius1 ();
     const float r2      = cone.radius2 ();
     const float l       = cone.length ();
@@ -95,7 +101,7 @@ float Distance::distance (const PrimCone& cone, const glm::vec3& point) {
 float Distance::distance (const PrimConeSphere& coneSphere, const glm::vec3& point) {
   const glm::vec3 toP = point - coneSphere.sphere1 ().center ();
   const float x       = glm::dot (toP, coneSphere.direction ());  
-  const float y       = glm::sqrt (glm::dot (toP, toP) - (x * x));
+  const float y       = glm::sqrt (glm::max (0.0f, glm::dot (toP, toP) - (x * x)));
   const float r1      = coneSphere.sphere1 ().radius ();
   const float r2      = coneSphere.sphere2 ().radius ();
   const float l       = coneSphere.length ();
@@ -143,3 +149,278 @@ float Distance::distance (const PrimConeSphere& coneSphere, const glm::vec3& poi
     return glm::sqrt ((x * x) + (y * y)) - r1;
   }
 }
+
+namespace {
+  enum class ConeSphereType { SameRadii, Cone, Sphere };
+
+  // per-primitive constants of `Distance::distance (const PrimConeSphere&, ...)`
+  struct ConeSphereConstants {
+    ConeSphereType type;
+    glm::vec3      center1;
+    glm::vec3      direction;
+    float          r1, r2, l, s, h1, lh2, r1c, r2c, cosAlpha, sinAlpha;
+
+    ConeSphereConstants (const PrimConeSphere& coneSphere)
+      : type      ( coneSphere.sameRadii () ? ConeSphereType::SameRadii
+                  : coneSphere.hasCone   () ? ConeSphereType::Cone
+                                            : ConeSphereType::Sphere )
+      , center1   (coneSphere.sphere1 ().center ())
+      , direction (coneSphere.direction ())
+      , r1        (coneSphere.sphere1 ().radius ())
+      , r2        (coneSphere.sphere2 ().radius ())
+      , l         (coneSphere.length ())
+      , s         (0.0f)
+      , h1        (0.0f)
+      , lh2       (0.0f)
+      , r1c       (0.0f)
+      , r2c       (0.0f)
+      , cosAlpha  (coneSphere.cosAlpha ())
+      , sinAlpha  (coneSphere.sinAlpha ())
+    {
+      if (this->type == ConeSphereType::Cone) {
+        this->s   = coneSphere.coneSideLength ();
+        this->h1  = this->r1 * coneSphere.delta () / this->l;
+        this->lh2 = this->l + (this->r2 * coneSphere.delta () / this->l);
+        this->r1c = this->r1 * this->s / this->l;
+        this->r2c = this->r2 * this->s / this->l;
+      }
+    }
+  };
+
+#ifdef DILAY_DISTANCE_SIMD
+  /* The kernels evaluate all branches of the scalar functions and select their results
+   * with the same comparisons.
+   * Operations are performed in the same order, such that results are bit-identical. */
+
+  std::atomic <bool>& isAvx2Enabled () {
+    static std::atomic <bool> enabled (true);
+    return enabled;
+  }
+
+  bool hasAvx2 () {
+    static const bool avx2 = [] () {
+      __builtin_cpu_init ();
+      return __builtin_cpu_supports ("avx2") != 0;
+    } ();
+    return avx2 && isAvx2Enabled ();
+  }
+
+  __m128 selectSse (__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps (_mm_and_ps (mask, a), _mm_andnot_ps (mask, b));
+  }
+
+  unsigned int distancesSse ( const PrimSphere& sphere, unsigned int n
+                            , const float* xs, const float* ys, const float* zs, float* ds )
+  {
+    const __m128 cx = _mm_set1_ps (sphere.center ().x);
+    const __m128 cy = _mm_set1_ps (sphere.center ().y);
+    const __m128 cz = _mm_set1_ps (sphere.center ().z);
+    const __m128 r  = _mm_set1_ps (sphere.radius ());
+
+    unsigned int i = 0;
+    for (; i + 4 <= n; i += 4) {
+      const __m128 tx = _mm_sub_ps (_mm_loadu_ps (xs + i), cx);
+      const __m128 ty = _mm_sub_ps (_mm_loadu_ps (ys + i), cy);
+      const __m128 tz = _mm_sub_ps (_mm_loadu_ps (zs + i), cz);
+      const __m128 dd = _mm_add_ps ( _mm_add_ps (_mm_mul_ps (tx, tx), _mm_mul_ps (ty, ty))
+                                   , _mm_mul_ps (tz, tz) );
+      const __m128 d  = _mm_sub_ps (_mm_sqrt_ps (dd), r);
+
+      _mm_storeu_ps (ds + i, d);
+    }
+    return i;
+  }
+
+  unsigned int distancesSse ( const ConeSphereConstants& c, unsigned int n
+                            , const float* xs, const float* ys, const float* zs, float* ds )
+  {
+    const __m128 zero = _mm_setzero_ps ();
+    const __m128 c1x  = _mm_set1_ps (c.center1.x);
+    const __m128 c1y  = _mm_set1_ps (c.center1.y);
+    const __m128 c1z  = _mm_set1_ps (c.center1.z);
+    const __m128 dx   = _mm_set1_ps (c.direction.x);
+    const __m128 dy   = _mm_set1_ps (c.direction.y);
+    const __m128 dz   = _mm_set1_ps (c.direction.z);
+    const __m128 r1   = _mm_set1_ps (c.r1);
+    const __m128 r2   = _mm_set1_ps (c.type == ConeSphereType::SameRadii ? c.r1 : c.r2);
+    const __m128 l    = _mm_set1_ps (c.l);
+    const __m128 s    = _mm_set1_ps (c.s);
+    const __m128 h1   = _mm_set1_ps (c.h1);
+    const __m128 lh2  = _mm_set1_ps (c.lh2);
+    const __m128 r1c  = _mm_set1_ps (c.r1c);
+    const __m128 r2c  = _mm_set1_ps (c.r2c);
+    const __m128 cosA = _mm_set1_ps (c.cosAlpha);
+    const __m128 sinA = _mm_set1_ps (c.sinAlpha);
+
+    unsigned int i = 0;
+    for (; i + 4 <= n; i += 4) {
+      const __m128 tx = _mm_sub_ps (_mm_loadu_ps (xs + i), c1x);
+      const __m128 ty = _mm_sub_ps (_mm_loadu_ps (ys + i), c1y);
+      const __m128 tz = _mm_sub_ps (_mm_loadu_ps (zs + i), c1z);
+      const __m128 x  = _mm_add_ps ( _mm_add_ps (_mm_mul_ps (tx, dx), _mm_mul_ps (ty, dy))
+                                   , _mm_mul_ps (tz, dz) );
+      const __m128 dd = _mm_add_ps ( _mm_add_ps (_mm_mul_ps (tx, tx), _mm_mul_ps (ty, ty))
+                                   , _mm_mul_ps (tz, tz) );
+      const __m128 y  = _mm_sqrt_ps (_mm_max_ps (_mm_sub_ps (dd, _mm_mul_ps (x, x)), zero));
+      const __m128 yy = _mm_mul_ps (y, y);
+      const __m128 xl = _mm_sub_ps (x, l);
+      const __m128 d1 = _mm_sub_ps (_mm_sqrt_ps (_mm_add_ps (_mm_mul_ps (x, x), yy)), r1);
+      const __m128 d2 = _mm_sub_ps (_mm_sqrt_ps (_mm_add_ps (_mm_mul_ps (xl, xl), yy)), r2);
+      __m128       d;
+
+      if (c.type == ConeSphereType::SameRadii) {
+        d = selectSse ( _mm_cmple_ps (x, zero), d1
+                      , selectSse (_mm_cmpge_ps (x, l), d2, _mm_sub_ps (y, r1)) );
+      }
+      else if (c.type == ConeSphereType::Cone) {
+        const __m128 xh = _mm_sub_ps (x, h1);
+        const __m128 yr = _mm_sub_ps (y, r1c);
+        const __m128 xn = _mm_sub_ps (_mm_mul_ps (xh, cosA), _mm_mul_ps (yr, sinA));
+        const __m128 yn = _mm_add_ps (_mm_mul_ps (xh, sinA), _mm_mul_ps (yr, cosA));
+        const __m128 dn = selectSse ( _mm_cmple_ps (xn, zero), d1
+                                    , selectSse (_mm_cmpge_ps (xn, s), d2, yn) );
+        const __m128 m2 = _mm_and_ps (_mm_cmpge_ps (x, lh2), _mm_cmple_ps (y, r2c));
+
+        d = selectSse (_mm_cmple_ps (x, zero), d1, selectSse (m2, d2, dn));
+      }
+      else {
+        d = d1;
+      }
+      _mm_storeu_ps (ds + i, d);
+    }
+    return i;
+  }
+
+  __attribute__ ((target ("avx2")))
+  unsigned int distancesAvx2 ( const PrimSphere& sphere, unsigned int n
+                             , const float* xs, const float* ys, const float* zs, float* ds )
+  {
+    const __m256 cx = _mm256_set1_ps (sphere.center ().x);
+    const __m256 cy = _mm256_set1_ps (sphere.center ().y);
+    const __m256 cz = _mm256_set1_ps (sphere.center ().z);
+    const __m256 r  = _mm256_set1_ps (sphere.radius ());
+
+    unsigned int i = 0;
+    for (; i + 8 <= n; i += 8) {
+      const __m256 tx = _mm256_sub_ps (_mm256_loadu_ps (xs + i), cx);
+      const __m256 ty = _mm256_sub_ps (_mm256_loadu_ps (ys + i), cy);
+      const __m256 tz = _mm256_sub_ps (_mm256_loadu_ps (zs + i), cz);
+      const __m256 dd = _mm256_add_ps ( _mm256_add_ps ( _mm256_mul_ps (tx, tx)
+                                                      , _mm256_mul_ps (ty, ty) )
+                                      , _mm256_mul_ps (tz, tz) );
+      const __m256 d  = _mm256_sub_ps (_mm256_sqrt_ps (dd), r);
+
+      _mm256_storeu_ps (ds + i, d);
+    }
+    return i;
+  }
+
+  __attribute__ ((target ("avx2")))
+  unsigned int distancesAvx2 ( const ConeSphereConstants& c, unsigned int n
+                             , const float* xs, const float* ys, const float* zs, float* ds )
+  {
+    const __m256 zero = _mm256_setzero_ps ();
+    const __m256 c1x  = _mm256_set1_ps (c.center1.x);
+    const __m256 c1y  = _mm256_set1_ps (c.center1.y);
+    const __m256 c1z  = _mm256_set1_ps (c.center1.z);
+    const __m256 dx   = _mm256_set1_ps (c.direction.x);
+    const __m256 dy   = _mm256_set1_ps (c.direction.y);
+    const __m256 dz   = _mm256_set1_ps (c.direction.z);
+    const __m256 r1   = _mm256_set1_ps (c.r1);
+    const __m256 r2   = _mm256_set1_ps (c.type == ConeSphereType::SameRadii ? c.r1 : c.r2);
+    const __m256 l    = _mm256_set1_ps (c.l);
+    const __m256 s    = _mm256_set1_ps (c.s);
+    const __m256 h1   = _mm256_set1_ps (c.h1);
+    const __m256 lh2  = _mm256_set1_ps (c.lh2);
+    const __m256 r1c  = _mm256_set1_ps (c.r1c);
+    const __m256 r2c  = _mm256_set1_ps (c.r2c);
+    const __m256 cosA = _mm256_set1_ps (c.cosAlpha);
+    const __m256 sinA = _mm256_set1_ps (c.sinAlpha);
+
+    unsigned int i = 0;
+    for (; i + 8 <= n; i += 8) {
+      const __m256 tx = _mm256_sub_ps (_mm256_loadu_ps (xs + i), c1x);
+      const __m256 ty = _mm256_sub_ps (_mm256_loadu_ps (ys + i), c1y);
+      const __m256 tz = _mm256_sub_ps (_mm256_loadu_ps (zs + i), c1z);
+      const __m256 x  = _mm256_add_ps ( _mm256_add_ps ( _mm256_mul_ps (tx, dx)
+                                                      , _mm256_mul_ps (ty, dy) )
+                                      , _mm256_mul_ps (tz, dz) );
+      const __m256 dd = _mm256_add_ps ( _mm256_add_ps ( _mm256_mul_ps (tx, tx)
+                                                      , _mm256_mul_ps (ty, ty) )
+                                      , _mm256_mul_ps (tz, tz) );
+      const __m256 y  = _mm256_sqrt_ps ( _mm256_max_ps (_mm256_sub_ps (dd, _mm256_mul_ps (x, x))
+                                                     , zero) );
+      const __m256 yy = _mm256_mul_ps (y, y);
+      const __m256 xl = _mm256_sub_ps (x, l);
+      const __m256 d1 = _mm256_sub_ps ( _mm256_sqrt_ps (_mm256_add_ps (_mm256_mul_ps (x, x), yy))
+                                      , r1 );
+      const __m256 d2 = _mm256_sub_ps ( _mm256_sqrt_ps (_mm256_add_ps (_mm256_mul_ps (xl, xl), yy))
+                                      , r2 );
+      __m256       d;
+
+      // `_mm256_blendv_ps (b,a,m)` selects `a` where `m` is set
+      const __m256 m0 = _mm256_cmp_ps (x, zero, _CMP_LE_OQ);
+
+      if (c.type == ConeSphereType::SameRadii) {
+        const __m256 mL = _mm256_cmp_ps (x, l, _CMP_GE_OQ);
+
+        d = _mm256_blendv_ps (_mm256_blendv_ps (_mm256_sub_ps (y, r1), d2, mL), d1, m0);
+      }
+      else if (c.type == ConeSphereType::Cone) {
+        const __m256 xh = _mm256_sub_ps (x, h1);
+        const __m256 yr = _mm256_sub_ps (y, r1c);
+        const __m256 xn = _mm256_sub_ps (_mm256_mul_ps (xh, cosA), _mm256_mul_ps (yr, sinA));
+        const __m256 yn = _mm256_add_ps (_mm256_mul_ps (xh, sinA), _mm256_mul_ps (yr, cosA));
+        const __m256 m2 = _mm256_and_ps ( _mm256_cmp_ps (x, lh2, _CMP_GE_OQ)
+                                        , _mm256_cmp_ps (y, r2c, _CMP_LE_OQ) );
+        const __m256 mN = _mm256_cmp_ps (xn, zero, _CMP_LE_OQ);
+        const __m256 mS = _mm256_cmp_ps (xn, s, _CMP_GE_OQ);
+        const __m256 dn = _mm256_blendv_ps (_mm256_blendv_ps (yn, d2, mS), d1, mN);
+
+        d = _mm256_blendv_ps (_mm256_blendv_ps (dn, d2, m2), d1, m0);
+      }
+      else {
+        d = d1;
+      }
+      _mm256_storeu_ps (ds + i, d);
+    }
+    return i;
+  }
+#endif
+}
+
+void Distance::distances ( const PrimSphere& sphere, unsigned int n
+                         , const float* xs, const float* ys, const float* zs, float* ds )
+{
+  unsigned int i = 0;
+#ifdef DILAY_DISTANCE_SIMD
+  i = hasAvx2 () ? distancesAvx2 (sphere, n, xs, ys, zs, ds)
+                 : distancesSse  (sphere, n, xs, ys, zs, ds);
+#endif
+  for (; i < n; i++) {
+    ds[i] = Distance::distance (sphere, glm::vec3 (xs[i], ys[i], zs[i]));
+  }
+}
+
+void Distance::distances ( const PrimConeSphere& coneSphere, unsigned int n
+                         , const float* xs, const float* ys, const float* zs, float* ds )
+{
+  unsigned int i = 0;
+#ifdef DILAY_DISTANCE_SIMD
+  const ConeSphereConstants constants (coneSphere);
+
+  i = hasAvx2 () ? distancesAvx2 (constants, n, xs, ys, zs, ds)
+                 : distancesSse  (constants, n, xs, ys, zs, ds);
+#endif
+  for (; i < n; i++) {
+    ds[i] = Distance::distance (coneSphere, glm::vec3 (xs[i], ys[i], zs[i]));
+  }
+}
+
+void Distance::useAvx2 (bool enable) {
+#ifdef DILAY_DISTANCE_SIMD
+  isAvx2Enabled () = enable;
+#else
+  static_cast <void> (enable);
+#endif
+}
@@ -17,6 +17,19 @@ namespace Distance {
   float distance (const PrimCylinder&, const glm::vec3&);
   float distance (const PrimCone&, const glm::vec3&);
   float distance (const PrimConeSphere&, const glm::vec3&);
+
+  /** `distances (p,n,xs,ys,zs,ds)` sets `ds[i]` to the distance between `p` and the
+   * point `(xs[i],ys[i],zs[i])` for all `i < n`.
+   * Points are processed in batches with AVX2 or SSE instructions if they are supported
+   * by the CPU. Distances equal those computed by `distance (p, ...)`. */
+  void distances ( const PrimSphere&, unsigned int
+                 , const float*, const float*, const float*, float* );
+  void distances ( const PrimConeSphere&, unsigned int
+                 , const float*, const float*, const float*, float* );
+
+  /** `useAvx2 (false)` forces `distances` to use SSE instead of AVX2 instructions, such
+   * that both kernels can be tested on CPUs that support AVX2. */
+  void useAvx2 (bool);
 }
 
 #endif
@@ -6,39 +6,57 @@
 #include <vector>
 #include "config.hpp"
 #include "history.hpp"
-#include "index-octree.hpp"
-#include "maybe.hpp"
 #include "mesh.hpp"
+#include "multi-res.hpp"
 #include "scene.hpp"
 #include "sketch/mesh.hpp"
 #include "sketch/path.hpp"
 #include "state.hpp"
+#include "util.hpp"
+#include "winged/log.hpp"
 #include "winged/mesh.hpp"
 
 namespace {
   struct SnapshotConfig {
     bool snapshotWingedMeshes;
-    bool copyOctree;
     bool snapshotSketchMeshes;
+    bool logWingedMeshes;
 
-    SnapshotConfig (bool w, bool o, bool s)
+    SnapshotConfig (bool w, bool s, bool l = false)
       : snapshotWingedMeshes (w)
-      , copyOctree           (o)
       , snapshotSketchMeshes (s)
+      , logWingedMeshes      (l)
     {
-      assert (!this->copyOctree || this->snapshotWingedMeshes);
-    }
-
-    SnapshotConfig withoutOctrees () const {
-      return SnapshotConfig ( this->snapshotWingedMeshes
-                            , false
-                            , this->snapshotSketchMeshes );
+      assert (!this->logWingedMeshes || !this->snapshotWingedMeshes);
     }
   };
 
+  // keeps the index and all slots of a mesh, such that older logs remain applicable
   struct WingedMeshSnapshot {
+    unsigned int        index;
     Mesh                mesh;
-    Maybe <IndexOctree> octree;
+    std::vector <bool>  liveVertices;
+    std::vector <bool>  liveFaces;
+    std::vector <bool>  mask;
+    MultiRes            multiRes;
+  };
+
+  // log of the mesh with `index` in the scene: its geometry-less `frame` is kept in case
+  // the stroke empties the mesh.
+  // If the stroke has outdated the mesh's multi-resolution levels, they are moved to
+  // `multiRes` and swapped with the mesh's levels whenever the log is applied.
+  struct WingedMeshLog {
+    const unsigned int index;
+    const Mesh         frame;
+    WingedLog          log;
+    bool               swapsMultiRes;
+    MultiRes           multiRes;
+
+    WingedMeshLog (const WingedMesh& mesh)
+      : index         (mesh.index ())
+      , frame         (mesh.mesh (), false)
+      , swapsMultiRes (false)
+    {}
   };
 
   struct SketchMeshSnapshot {
@@ -50,31 +68,42 @@ namespace {
     const SnapshotConfig           config;
     std::list <WingedMeshSnapshot> wingedMeshes;
     std::list <SketchMeshSnapshot> sketchMeshes;
+    std::list <WingedMeshLog>      wingedMeshLogs;
 
     SceneSnapshot (const SnapshotConfig& c) : config (c) {}
   };
 
   typedef std::list <SceneSnapshot> Timeline;
 
+  WingedMeshSnapshot wingedMeshSnapshot (const WingedMesh& mesh) {
+    WingedMeshSnapshot snapshot = { mesh.index (), mesh.mesh (), {}, {}, mesh.mask ()
+                                  , mesh.multiRes () };
+
+    mesh.liveSlots (snapshot.liveVertices, snapshot.liveFaces);
+    return snapshot;
+  }
+
+  // snapshot of `mesh` before `log` has been recorded
+  WingedMeshSnapshot wingedMeshSnapshot (const WingedMesh& mesh, WingedMeshLog& log) {
+    WingedMeshSnapshot snapshot = wingedMeshSnapshot (mesh);
+
+    if (mesh.isEmpty ()) {
+      snapshot.mesh = log.frame;
+    }
+    log.log.apply (snapshot.mesh, snapshot.liveVertices, snapshot.liveFaces, snapshot.mask);
+
+    if (log.swapsMultiRes) {
+      snapshot.multiRes = log.multiRes;
+    }
+    return snapshot;
+  }
+
   SceneSnapshot sceneSnapshot (const Scene& scene, const SnapshotConfig& config) {
     SceneSnapshot snapshot (config);
 
     if (config.snapshotWingedMeshes) {
-      scene.forEachConstMesh ([&config, &snapshot] (const WingedMesh& mesh) {
-        if (config.copyOctree) {
-          std::vector <unsigned int> newFaceIndices;
-
-          WingedMeshSnapshot meshSnapshot = { mesh.makePrunedMesh (&newFaceIndices)
-                                            , mesh.octree () };
-
-          if (newFaceIndices.empty () == false) {
-            meshSnapshot.octree->rewriteIndices (newFaceIndices);
-          }
-          snapshot.wingedMeshes.push_back (std::move (meshSnapshot));
-        }
-        else {
-          snapshot.wingedMeshes.push_back ({ mesh.makePrunedMesh (), Maybe <IndexOctree> () });
-        }
+      scene.forEachConstMesh ([&snapshot] (const WingedMesh& mesh) {
+        snapshot.wingedMeshes.push_back (wingedMeshSnapshot (mesh));
       });
     }
     if (config.snapshotSketchMeshes) {
@@ -92,7 +121,12 @@ namespace {
       scene.deleteWingedMeshes ();
 
       for (const WingedMeshSnapshot& meshSnapshot : snapshot.wingedMeshes) {
-        scene.newWingedMesh (state.config (), meshSnapshot.mesh);
+        WingedMesh& mesh = scene.newWingedMesh ( state.config (), meshSnapshot.index
+                                               , meshSnapshot.mesh
+                                               , meshSnapshot.liveVertices
+                                               , meshSnapshot.liveFaces );
+        mesh.mask     (meshSnapshot.mask);
+        mesh.multiRes () = meshSnapshot.multiRes;
       }
     }
     if (snapshot.config.snapshotSketchMeshes) {
@@ -104,97 +138,182 @@ namespace {
           sketch.addPath (p);
         }
       }
+      scene.updateSketchPreviews ();
     }
   }
 
-  void deleteOctreeSnapshot (SceneSnapshot& sceneSnapshot) {
-    for (WingedMeshSnapshot& meshSnapshot : sceneSnapshot.wingedMeshes) {
-      meshSnapshot.octree.reset ();
+  void applyLogs (SceneSnapshot& snapshot, Scene& scene) {
+    assert (snapshot.config.logWingedMeshes);
+
+    for (WingedMeshLog& log : snapshot.wingedMeshLogs) {
+      WingedMesh* mesh = scene.wingedMesh (log.index);
+
+      if (mesh) {
+        mesh->applyLog (log.log);
+
+        if (log.swapsMultiRes) {
+          std::swap (mesh->multiRes (), log.multiRes);
+        }
+      }
+      else {
+        DILAY_WARN ("could not find logged mesh %u", log.index);
+      }
     }
   }
 }
 
 struct History::Impl {
-  unsigned int undoDepth;
-  Timeline     past;
-  Timeline     future;
+  unsigned int   undoDepth;
+  Timeline       past;
+  Timeline       future;
+  SceneSnapshot* stroke;
 
-  Impl (const Config& config) {
+  Impl (const Config& config)
+    : stroke (nullptr)
+  {
     this->runFromConfig (config);
   }
 
-  void snapshotAll (const Scene& scene) {
-    this->snapshot (scene, SnapshotConfig (true, true, true));
+  void snapshotAll (Scene& scene) {
+    this->snapshot (scene, SnapshotConfig (true, true));
+  }
+
+  void snapshotWingedMeshes (Scene& scene) {
+    this->snapshot (scene, SnapshotConfig (true, false));
   }
 
-  void snapshotWingedMeshes (const Scene& scene) {
-    this->snapshot (scene, SnapshotConfig (true, true, false));
+  void snapshotSketchMeshes (Scene& scene) {
+    this->snapshot (scene, SnapshotConfig (false, true));
   }
 
-  void snapshotSketchMeshes (const Scene& scene) {
+  /** `startStroke (s)` starts logging all winged meshes of `s`.
+   * Instead of copying whole meshes, only slots that are touched by the stroke are
+   * recorded. */
+  void startStroke (Scene& scene) {
     this->snapshot (scene, SnapshotConfig (false, false, true));
+
+    SceneSnapshot& snapshot = this->past.front ();
+
+    scene.forEachMesh ([&snapshot] (WingedMesh& mesh) {
+      snapshot.wingedMeshLogs.emplace_back (mesh);
+      mesh.startLog (snapshot.wingedMeshLogs.back ().log);
+    });
+    this->stroke = &snapshot;
   }
 
-  void snapshot (const Scene& scene, const SnapshotConfig& config) {
+  /** `finishStroke (s)` stops logging.
+   * Unchanged meshes are not kept and a stroke that did not change anything is dropped.
+   * Multi-resolution levels that have been outdated by the stroke are discarded, but
+   * kept by the stroke's logs.
+   * If a mesh has been emptied by the stroke, it will be deleted from the scene, which
+   * can not be logged: the stroke is kept as a snapshot of the whole scene instead, which
+   * is restored from the logs. */
+  void finishStroke (Scene& scene) {
+    if (this->stroke == nullptr) {
+      return;
+    }
+    SceneSnapshot& snapshot = *this->stroke;
+    this->stroke = nullptr;
+
+    assert (&snapshot == &this->past.front ());
+
+    scene.forEachMesh ([] (WingedMesh& mesh) {
+      mesh.stopLog ();
+    });
+    snapshot.wingedMeshLogs.remove_if ([] (const WingedMeshLog& log) {
+      return log.log.isEmpty ();
+    });
+
+    for (WingedMeshLog& log : snapshot.wingedMeshLogs) {
+      WingedMesh* mesh = scene.wingedMesh (log.index);
+
+      if (mesh && mesh->multiRes ().isOutdated (*mesh)) {
+        log.swapsMultiRes = true;
+        std::swap (mesh->multiRes (), log.multiRes);
+      }
+    }
+
+    bool hasEmptyMesh = false;
+    scene.forEachConstMesh ([&hasEmptyMesh] (const WingedMesh& mesh) {
+      hasEmptyMesh = hasEmptyMesh || mesh.isEmpty ();
+    });
+
+    if (snapshot.wingedMeshLogs.empty ()) {
+      this->past.pop_front ();
+    }
+    else if (hasEmptyMesh) {
+      SceneSnapshot fullSnapshot (SnapshotConfig (true, false));
+      auto          log = snapshot.wingedMeshLogs.begin ();
+
+      scene.forEachConstMesh ([&snapshot, &fullSnapshot, &log] (const WingedMesh& mesh) {
+        if (log != snapshot.wingedMeshLogs.end () && log->index == mesh.index ()) {
+          fullSnapshot.wingedMeshes.push_back (wingedMeshSnapshot (mesh, *log));
+          ++log;
+        }
+        else {
+          fullSnapshot.wingedMeshes.push_back (wingedMeshSnapshot (mesh));
+        }
+      });
+
+      this->past.pop_front  ();
+      this->past.push_front (std::move (fullSnapshot));
+    }
+  }
+
+  /** `snapshot (s,c)` finishes a running stroke first, since dropping the stroke's snapshot
+   * would leave its meshes logging into freed memory. */
+  void snapshot (Scene& scene, const SnapshotConfig& config) {
     assert (undoDepth > 0);
 
+    this->finishStroke (scene);
     this->future.clear ();
 
     while (this->past.size () >= this->undoDepth) {
       this->past.pop_back ();
     }
-    if (this->past.empty () == false) {
-      deleteOctreeSnapshot (this->past.front ());
-    }
     this->past.push_front (std::move (sceneSnapshot (scene, config)));
   }
 
-  void dropSnapshot () {
+  void dropSnapshot (Scene& scene) {
+    this->finishStroke (scene);
+
     if (this->past.empty () == false) {
       this->past.pop_front ();
     }
   }
 
   void undo (State& state) {
-    if (this->past.empty () == false) {
-      SnapshotConfig config = this->past.front ().config.withoutOctrees ();
+    this->finishStroke (state.scene ());
 
-      this->future.push_front (std::move (sceneSnapshot (state.scene (), config)));
+    if (this->past.empty () == false && this->past.front ().config.logWingedMeshes) {
+      applyLogs           (this->past.front (), state.scene ());
+      this->future.splice (this->future.begin (), this->past, this->past.begin ());
+    }
+    else if (this->past.empty () == false) {
+      this->future.push_front (std::move (sceneSnapshot ( state.scene ()
+                                                        , this->past.front ().config )));
       resetToSnapshot (this->past.front (), state);
       this->past.pop_front ();
     }
   }
 
   void redo (State& state) {
-    if (this->future.empty () == false) {
-      if (this->past.empty () == false) {
-        deleteOctreeSnapshot (this->past.front ());
-      }
-      SnapshotConfig config = this->future.front ().config.withoutOctrees ();
+    this->finishStroke (state.scene ());
 
-      this->past.push_front (std::move (sceneSnapshot (state.scene (), config)));
+    if (this->future.empty () == false && this->future.front ().config.logWingedMeshes) {
+      applyLogs         (this->future.front (), state.scene ());
+      this->past.splice (this->past.begin (), this->future, this->future.begin ());
+    }
+    else if (this->future.empty () == false) {
+      this->past.push_front (std::move (sceneSnapshot ( state.scene ()
+                                                      , this->future.front ().config )));
       resetToSnapshot (this->future.front (), state);
       this->future.pop_front ();
     }
   }
 
-  bool hasRecentOctrees () const {
-    return this->past.empty () == false 
-      && this->past.front ().config.snapshotWingedMeshes
-      && bool (this->past.front ().wingedMeshes.front ().octree);
-  }
-
-  void forEachRecentOctree (const std::function <void ( const Mesh& m
-                                                      , const IndexOctree& )>& f) const
-  {
-    assert (this->hasRecentOctrees ());
-    for (const WingedMeshSnapshot& s : this->past.front ().wingedMeshes) {
-      assert (s.octree);
-      f (s.mesh, *s.octree);
-    }
-  }
-
-  void reset () {
+  void reset (Scene& scene) {
+    this->finishStroke (scene);
     this->past  .clear ();
     this->future.clear ();
   }
@@ -205,13 +324,13 @@ struct History::Impl {
 };
 
 DELEGATE1_BIG3  (History, const Config&)
-DELEGATE1       (void, History, snapshotAll, const Scene&)
-DELEGATE1       (void, History, snapshotWingedMeshes, const Scene&)
-DELEGATE1       (void, History, snapshotSketchMeshes, const Scene&)
-DELEGATE        (void, History, dropSnapshot)
+DELEGATE1       (void, History, snapshotAll, Scene&)
+DELEGATE1       (void, History, snapshotWingedMeshes, Scene&)
+DELEGATE1       (void, History, snapshotSketchMeshes, Scene&)
+DELEGATE1       (void, History, startStroke, Scene&)
+DELEGATE1       (void, History, finishStroke, Scene&)
+DELEGATE1       (void, History, dropSnapshot, Scene&)
 DELEGATE1       (void, History, undo, State&)
 DELEGATE1       (void, History, redo, State&)
 DELEGATE1       (void, History, runFromConfig, const Config&)
-DELEGATE_CONST  (bool, History, hasRecentOctrees)
-DELEGATE        (void, History, reset)
-DELEGATE1_CONST (void, History, forEachRecentOctree, const std::function <void (const Mesh&, const IndexOctree&)>&)
+DELEGATE1       (void, History, reset, Scene&)
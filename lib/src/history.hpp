@@ -8,8 +8,6 @@
 #include "configurable.hpp"
 #include "macro.hpp"
 
-class IndexOctree;
-class Mesh;
 class Scene;
 class State;
 
@@ -17,15 +15,16 @@ class History : public Configurable {
   public: 
     DECLARE_BIG3 (History, const Config&)
 
-    void snapshotAll          (const Scene&);
-    void snapshotWingedMeshes (const Scene&);
-    void snapshotSketchMeshes (const Scene&);
-    void dropSnapshot         ();
+    /** Snapshots, `dropSnapshot` and `reset` finish a running stroke first. */
+    void snapshotAll          (Scene&);
+    void snapshotWingedMeshes (Scene&);
+    void snapshotSketchMeshes (Scene&);
+    void startStroke          (Scene&);
+    void finishStroke         (Scene&);
+    void dropSnapshot         (Scene&);
     void undo                 (State&);
     void redo                 (State&);
-    bool hasRecentOctrees     () const;
-    void forEachRecentOctree  (const std::function <void (const Mesh&, const IndexOctree&)>&) const;
-    void reset                ();
+    void reset                (Scene&);
 
   private:
     IMPLEMENTATION
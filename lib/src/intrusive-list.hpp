@@ -258,6 +258,25 @@ class IntrusiveIndexedList {
       }
     }
 
+    /** `emplaceAt (i,...)` emplaces an element with index `i`, which must be free.
+     * Indices below `i` that have not been used yet become free.
+     * Free indices are searched from the most recently freed one. */
+    template <typename ... Args>
+    T& emplaceAt (unsigned int index, const Args& ... args) {
+      while (this->_pointer.size () <= index) {
+        this->_freeIndices.push_back (this->_pointer.size ());
+        this->_pointer.push_back (nullptr);
+      }
+      auto it = std::find (this->_freeIndices.rbegin (), this->_freeIndices.rend (), index);
+
+      assert (it != this->_freeIndices.rend ());
+      *it = this->_freeIndices.back ();
+      this->_freeIndices.pop_back ();
+
+      this->_pointer [index] = &this->_list.emplaceBack (index, args ...);
+      return *this->_pointer [index];
+    }
+
     void deleteElement (T& element) {
       assert (this->isFreeSLOW (element.index ()) == false);
 
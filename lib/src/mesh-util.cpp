@@ -262,7 +262,7 @@ Mesh MeshUtil :: cylinder (unsigned int numVertices) {
   return finalized (mesh);
 }
 
-Mesh MeshUtil :: mirror (const Mesh& mesh, const PrimPlane& plane) {
+Mesh MeshUtil :: mirror (const Mesh& mesh, const PrimPlane& plane, std::vector <bool>* mask) {
   assert (MeshUtil::checkConsistency (mesh));
 
   enum class Side       { Negative, Border, Positive };
@@ -283,6 +283,16 @@ Mesh MeshUtil :: mirror (const Mesh& mesh, const PrimPlane& plane) {
   std::vector <BorderFlag>   borderFlags;
   std::vector <ui_pair>      newIndices;
   EdgeMap     <unsigned int> newBorderVertices;
+  std::vector <bool>         newMask;
+
+  auto isMasked = [mask] (unsigned int i) -> bool {
+    return mask && i < mask->size () && (*mask) [i];
+  };
+
+  auto addVertex = [&m, &newMask] (const glm::vec3& v, bool isMasked) -> unsigned int {
+    newMask.push_back (isMasked);
+    return m.addVertex (v);
+  };
 
   auto updateBorderFlag = [&borderFlags] (unsigned int i, Side side) {
     BorderFlag& current = borderFlags [i];
@@ -306,7 +316,7 @@ Mesh MeshUtil :: mirror (const Mesh& mesh, const PrimPlane& plane) {
     }
   };
 
-  auto newBorderVertex = [&mesh, &plane, &newBorderVertices, &m] 
+  auto newBorderVertex = [&mesh, &plane, &newBorderVertices, &isMasked, &addVertex] 
                          (unsigned int i1, unsigned int i2) -> unsigned int 
   {
     const unsigned int* existentIndex = newBorderVertices.find (i1, i2);
@@ -328,7 +338,7 @@ Mesh MeshUtil :: mirror (const Mesh& mesh, const PrimPlane& plane) {
       else {
         position = (v1 + v2) * 0.5f; 
       }
-      const unsigned int newIndex = m.addVertex (position);
+      const unsigned int newIndex = addVertex (position, isMasked (i1) && isMasked (i2));
 
       newBorderVertices.add (i1, i2, newIndex);
       return newIndex;
@@ -381,14 +391,14 @@ Mesh MeshUtil :: mirror (const Mesh& mesh, const PrimPlane& plane) {
           case BorderFlag::ConnectsNegative:
             break;
           case BorderFlag::ConnectsPositive: {
-            const unsigned int index1 = m.addVertex (v);
-            const unsigned int index2 = m.addVertex (v);
+            const unsigned int index1 = addVertex (v, isMasked (i));
+            const unsigned int index2 = addVertex (v, isMasked (i));
 
             newIndices [i] = std::make_pair (index1, index2);
             break;
           }
           case BorderFlag::ConnectsBoth: {
-            const unsigned int index = m.addVertex (v);
+            const unsigned int index = addVertex (v, isMasked (i));
 
             newIndices [i] = std::make_pair (index, index);
             break;
@@ -397,8 +407,8 @@ Mesh MeshUtil :: mirror (const Mesh& mesh, const PrimPlane& plane) {
         break;
       }
       case Side::Positive: {
-        const unsigned int index1 = m.addVertex (v);
-        const unsigned int index2 = m.addVertex (plane.mirror (v));
+        const unsigned int index1 = addVertex (v, isMasked (i));
+        const unsigned int index2 = addVertex (plane.mirror (v), isMasked (i));
 
         newIndices [i] = std::make_pair (index1, index2);
       }
@@ -533,6 +543,11 @@ Mesh MeshUtil :: mirror (const Mesh& mesh, const PrimPlane& plane) {
     }
   }
   assert (MeshUtil::checkConsistency (m));
+  assert (newMask.size () == m.numVertices ());
+
+  if (mask) {
+    *mask = std::move (newMask);
+  }
   return m;
 }
 
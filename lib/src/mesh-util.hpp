@@ -5,6 +5,8 @@
 #ifndef DILAY_MESH_UTIL
 #define DILAY_MESH_UTIL
 
+#include <vector>
+
 class Mesh;
 class PrimPlane;
 
@@ -18,7 +20,10 @@ namespace MeshUtil {
   Mesh cone             (unsigned int);
   Mesh cylinder         (unsigned int);
 
-  Mesh mirror           (const Mesh&, const PrimPlane&);
+  /** `mirror (m,p,mask)` mirrors `m` at `p`.
+   * If `mask` is given, it flags the masked vertices of `m` and is replaced by the flags
+   * of the mirrored mesh: both copies of a vertex keep its flag. */
+  Mesh mirror           (const Mesh&, const PrimPlane&, std::vector <bool>* = nullptr);
   bool checkConsistency (const Mesh&);
 };
 
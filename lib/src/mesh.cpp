@@ -2,6 +2,7 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <algorithm>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -15,6 +16,26 @@
 #include "renderer.hpp"
 #include "util.hpp"
 
+namespace {
+  // number of buffered elements, which is not copied (cf. `OpenGLBufferId`)
+  struct BufferSize {
+    unsigned int value;
+
+    BufferSize ()                  : value (0)       {}
+    BufferSize (const BufferSize&) : value (0)       {}
+    BufferSize (BufferSize&& o)    : value (o.value) {}
+
+    BufferSize& operator= (const BufferSize&) {
+      return *this;
+    }
+
+    BufferSize& operator= (BufferSize&& o) {
+      this->value = o.value;
+      return *this;
+    }
+  };
+}
+
 struct Mesh::Impl {
   // cf. copy-constructor, reset
   glm::mat4x4                 scalingMatrix;
@@ -29,6 +50,8 @@ struct Mesh::Impl {
   OpenGLBufferId              vertexBufferId;
   OpenGLBufferId              indexBufferId;
   OpenGLBufferId              normalBufferId;
+  BufferSize                  numBufferedVertices;
+  BufferSize                  numBufferedIndices;
 
   RenderMode                  renderMode;
 
@@ -105,6 +128,10 @@ struct Mesh::Impl {
     this->indices.reserve (n);
   }
 
+  void resizeIndices (unsigned int n) { 
+    this->indices.resize (n, 0);
+  }
+
   unsigned int addVertex (const glm::vec3& v) { 
     return this->addVertex (v, glm::vec3 (0.0f));
   }
@@ -129,6 +156,11 @@ struct Mesh::Impl {
     this->normals .reserve (3*n);
   }
 
+  void resizeVertices (unsigned int n) { 
+    this->vertices.resize (3*n, 0.0f);
+    this->normals .resize (3*n, 0.0f);
+  }
+
   void setIndex (unsigned int index, unsigned int vertexIndex) {
     assert (index < this->indices.size ());
     this->indices[index] = vertexIndex;
@@ -177,6 +209,49 @@ struct Mesh::Impl {
 
     OpenGL::glBindBuffer (OpenGL::ElementArrayBuffer (), 0);
     OpenGL::glBindBuffer (OpenGL::ArrayBuffer (), 0);
+
+    this->numBufferedVertices.value = this->numVertices ();
+    this->numBufferedIndices .value = this->numIndices  ();
+  }
+
+  void bufferData (const std::vector <unsigned int>& vertices, const std::vector <unsigned int>& faces) {
+    if ( this->vertexBufferId.isValid () == false
+      || this->numBufferedVertices.value != this->numVertices ()
+      || this->numBufferedIndices .value != this->numIndices  () )
+    {
+      this->bufferData ();
+      return;
+    }
+
+    if (vertices.empty () == false) {
+      const auto         range  = std::minmax_element (vertices.begin (), vertices.end ());
+      const unsigned int first  = 3 * (*range.first);
+      const unsigned int offset = first * sizeof (float);
+      const unsigned int size   = 3 * (*range.second - *range.first + 1) * sizeof (float);
+
+      assert (*range.second < this->numVertices ());
+
+      OpenGL::glBindBuffer    (OpenGL::ArrayBuffer (), this->vertexBufferId.id ());
+      OpenGL::glBufferSubData (OpenGL::ArrayBuffer (), offset, size, &this->vertices [first]);
+
+      OpenGL::glBindBuffer    (OpenGL::ArrayBuffer (), this->normalBufferId.id ());
+      OpenGL::glBufferSubData (OpenGL::ArrayBuffer (), offset, size, &this->normals [first]);
+    }
+
+    if (faces.empty () == false) {
+      const auto         range  = std::minmax_element (faces.begin (), faces.end ());
+      const unsigned int first  = 3 * (*range.first);
+      const unsigned int offset = first * sizeof (unsigned int);
+      const unsigned int size   = 3 * (*range.second - *range.first + 1) * sizeof (unsigned int);
+
+      assert ((3 * (*range.second)) + 2 < this->numIndices ());
+
+      OpenGL::glBindBuffer    (OpenGL::ElementArrayBuffer (), this->indexBufferId.id ());
+      OpenGL::glBufferSubData (OpenGL::ElementArrayBuffer (), offset, size, &this->indices [first]);
+    }
+
+    OpenGL::glBindBuffer (OpenGL::ElementArrayBuffer (), 0);
+    OpenGL::glBindBuffer (OpenGL::ArrayBuffer (), 0);
   }
 
   glm::mat4x4 modelMatrix () const {
@@ -258,6 +333,9 @@ struct Mesh::Impl {
     this->vertexBufferId.reset ();
     this->indexBufferId .reset ();
     this->normalBufferId.reset ();
+
+    this->numBufferedVertices.value = 0;
+    this->numBufferedIndices .value = 0;
   }
 
   void resetGeometry () {
@@ -373,14 +451,17 @@ DELEGATE1_CONST  (glm::vec3         , Mesh, normal, unsigned int)
 
 DELEGATE1        (unsigned int      , Mesh, addIndex, unsigned int)
 DELEGATE1        (void              , Mesh, reserveIndices, unsigned int)
+DELEGATE1        (void              , Mesh, resizeIndices, unsigned int)
 DELEGATE1        (unsigned int      , Mesh, addVertex, const glm::vec3&)
 DELEGATE2        (unsigned int      , Mesh, addVertex, const glm::vec3&, const glm::vec3&)
 DELEGATE1        (void              , Mesh, reserveVertices, unsigned int)
+DELEGATE1        (void              , Mesh, resizeVertices, unsigned int)
 DELEGATE2        (void              , Mesh, setIndex, unsigned int, unsigned int)
 DELEGATE2        (void              , Mesh, setVertex, unsigned int, const glm::vec3&)
 DELEGATE2        (void              , Mesh, setNormal, unsigned int, const glm::vec3&)
 
 DELEGATE         (void              , Mesh, bufferData)
+DELEGATE2        (void              , Mesh, bufferData, const std::vector <unsigned int>&, const std::vector <unsigned int>&)
 DELEGATE_CONST   (glm::mat4x4       , Mesh, modelMatrix)
 DELEGATE_CONST   (glm::mat3x3       , Mesh, modelNormalMatrix)
 DELEGATE1_CONST  (void              , Mesh, renderBegin, Camera&)
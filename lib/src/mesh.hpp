@@ -6,6 +6,7 @@
 #define DILAY_MESH
 
 #include <glm/fwd.hpp>
+#include <vector>
 #include "macro.hpp"
 
 class Camera;
@@ -29,14 +30,27 @@ class Mesh {
     glm::vec3          normal            (unsigned int) const;
     unsigned int       addIndex          (unsigned int);
     void               reserveIndices    (unsigned int);
+    void               resizeIndices     (unsigned int);
     unsigned int       addVertex         (const glm::vec3&);
     unsigned int       addVertex         (const glm::vec3&, const glm::vec3&);
     void               reserveVertices   (unsigned int);
+
+    /** `resizeVertices (n)` adds (or removes) vertices at the end, such that
+     * `numVertices () == n`. New vertices and normals are zero. */
+    void               resizeVertices    (unsigned int);
     void               setIndex          (unsigned int, unsigned int);
     void               setVertex         (unsigned int, const glm::vec3&);
     void               setNormal         (unsigned int, const glm::vec3&);
 
     void               bufferData        ();
+
+    /** `bufferData (v,f)` only buffers the range of vertices (and normals) that spans
+     * `v` and the range of faces that spans `f`, where face `i` refers to indices `3i`,
+     * `3i+1` and `3i+2`.
+     * Everything is buffered if the number of vertices or indices has changed since the
+     * last call of `bufferData`. */
+    void               bufferData        ( const std::vector <unsigned int>&
+                                         , const std::vector <unsigned int>& );
     glm::mat4x4        modelMatrix       () const;
     glm::mat3x3        modelNormalMatrix () const;
     void               renderBegin       (Camera&) const;
@@ -0,0 +1,90 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <algorithm>
+#include <array>
+#include "hash.hpp"
+#include "multi-res.hpp"
+#include "winged/face.hpp"
+#include "winged/mesh.hpp"
+#include "winged/vertex.hpp"
+
+struct MultiRes :: Impl {
+  std::vector <MultiResLevel> levels;
+  unsigned int                currentLevel;
+
+  Impl () 
+    : currentLevel (0)
+  {}
+
+  unsigned int numLevels () const {
+    return this->levels.size () + 1;
+  }
+
+  MultiResLevel& level (unsigned int i) {
+    assert (i < this->levels.size ());
+    return this->levels [i];
+  }
+
+  void addLevel (MultiResLevel&& level) {
+    this->levels.resize    (this->currentLevel);
+    this->levels.push_back (std::move (level));
+    this->currentLevel++;
+  }
+
+  void reset () {
+    this->levels.clear ();
+    this->currentLevel = 0;
+  }
+
+  bool isOutdated (const WingedMesh& mesh) const {
+    if (this->levels.empty ()) {
+      return false;
+    }
+    else if (this->currentLevel < this->levels.size ()) {
+      return MultiRes::topology (mesh) != this->levels [this->currentLevel].coarseTopology;
+    }
+    else {
+      return MultiRes::topology (mesh) != this->levels [this->currentLevel - 1].fineTopology;
+    }
+  }
+};
+
+std::size_t MultiRes :: topology (const WingedMesh& mesh) {
+  typedef std::array <unsigned int, 3> Triangle;
+
+  // triangles are rotated to start at their smallest index and sorted, such that the hash
+  // does not depend on the order of faces (e.g. after `Action::refineMesh`)
+  std::vector <Triangle> triangles;
+  triangles.reserve (mesh.numFaces ());
+
+  mesh.forEachConstFace ([&mesh, &triangles] (const WingedFace& face) {
+    Triangle t = {{ face.vertexRef (0).index ()
+                  , face.vertexRef (1).index ()
+                  , face.vertexRef (2).index () }};
+
+    std::rotate (t.begin (), std::min_element (t.begin (), t.end ()), t.end ());
+    triangles.push_back (t);
+  });
+  std::sort (triangles.begin (), triangles.end ());
+
+  std::size_t seed = 0;
+
+  Hash::combine (seed, mesh.numVertices ());
+  for (const Triangle& t : triangles) {
+    Hash::combine (seed, t [0]);
+    Hash::combine (seed, t [1]);
+    Hash::combine (seed, t [2]);
+  }
+  return seed;
+}
+
+DELEGATE_BIG6   (MultiRes)
+DELEGATE_CONST  (unsigned int  , MultiRes, numLevels)
+GETTER_CONST    (unsigned int  , MultiRes, currentLevel)
+DELEGATE1       (MultiResLevel&, MultiRes, level, unsigned int)
+SETTER          (unsigned int  , MultiRes, currentLevel)
+DELEGATE1       (void          , MultiRes, addLevel, MultiResLevel&&)
+DELEGATE        (void          , MultiRes, reset)
+DELEGATE1_CONST (bool          , MultiRes, isOutdated, const WingedMesh&)
@@ -0,0 +1,63 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_MULTI_RES
+#define DILAY_MULTI_RES
+
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+#include "macro.hpp"
+#include "mesh.hpp"
+
+class WingedMesh;
+
+/** `MultiResLevel` stores how a finer level of a mesh is obtained from a coarser level:
+ * vertex `i` of the finer level is vertex `i` of `coarse` if `i < coarse.numVertices ()`.
+ * Otherwise, it subdivides the edge between `parents [j]` with
+ * `j = i - coarse.numVertices ()` and is displaced by `details [j]` from the butterfly
+ * subdivision of that edge, such that edits of the coarser level propagate smoothly.
+ * `coarseTopology` and `fineTopology` are hashes of the topologies of both levels. */
+struct MultiResLevel {
+  Mesh                                                 coarse;
+  std::vector <std::pair <unsigned int, unsigned int>> parents;
+  std::vector <glm::vec3>                              details;
+  std::size_t                                          coarseTopology;
+  std::size_t                                          fineTopology;
+};
+
+/** `MultiRes` stores the subdivision levels of a mesh.
+ * `level (i)` relates the `i`-th level to the `(i+1)`-th level, where the 0-th level
+ * is the base mesh.
+ * Levels are switched with `Action::coarsenMesh` and `Action::refineMesh`; the mesh always
+ * holds the current level only, but renders the finest level (cf. `Action::finestLevel`).
+ * Any change of the mesh's topology (e.g. by dynamic topology sculpting) outdates them.
+ * Levels are part of the undo history, but not of saved files. */
+class MultiRes {
+  public:
+    DECLARE_BIG6 (MultiRes)
+
+    unsigned int   numLevels    () const;
+    unsigned int   currentLevel () const;
+    MultiResLevel& level        (unsigned int);
+
+    void           currentLevel (unsigned int);
+
+    /** `addLevel (l)` discards all levels above the current level, adds `l` and makes
+     * the level above `l` the current level. */
+    void           addLevel     (MultiResLevel&&);
+    void           reset        ();
+
+    /** `isOutdated (m)` checks if the topology of `m` differs from the topology of the
+     * current level. Returns `false` if there are no levels. */
+    bool           isOutdated   (const WingedMesh&) const;
+
+    /** `topology (m)` hashes the topology of `m`. */
+    static std::size_t topology (const WingedMesh&);
+
+  private:
+    IMPLEMENTATION
+};
+
+#endif
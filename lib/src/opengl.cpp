@@ -106,6 +106,7 @@ namespace OpenGL {
   DELEGATE1_GL (void, glBlendEquation, unsigned int)
   DELEGATE2_GL (void, glBlendFunc, unsigned int, unsigned int)
   DELEGATE4_GL (void, glBufferData, unsigned int, unsigned int, const void*, unsigned int)
+  DELEGATE4_GL (void, glBufferSubData, unsigned int, unsigned int, unsigned int, const void*)
   DELEGATE1_GL (void, glClear, unsigned int)
   DELEGATE4_GL (void, glClearColor, float, float, float, float)
   DELEGATE1_GL (void, glClearStencil, int)
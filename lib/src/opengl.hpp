@@ -57,6 +57,7 @@ namespace OpenGL {
   void glBlendEquation            (unsigned int);
   void glBlendFunc                (unsigned int, unsigned);
   void glBufferData               (unsigned int, unsigned int, const void*, unsigned int);
+  void glBufferSubData            (unsigned int, unsigned int, unsigned int, const void*);
   void glClear                    (unsigned int);
   void glClearColor               (float, float, float, float);
   void glClearStencil             (int);
@@ -0,0 +1,283 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include "parallel-util.hpp"
+
+namespace {
+  // each thread gets several ranges, such that idle threads can steal from busy ones
+  constexpr unsigned int rangesPerThread = 4;
+
+  // larger pools only add scheduling overhead
+  constexpr unsigned int maxThreadsPerHardwareThread = 4;
+
+  struct Job {
+    const std::function <void (unsigned int, unsigned int)>& f;
+    unsigned int                                             numPending;
+    std::mutex                                               mutex;
+    std::condition_variable                                  done;
+
+    Job (const std::function <void (unsigned int, unsigned int)>& fn, unsigned int n)
+      : f          (fn)
+      , numPending (n)
+    {}
+  };
+
+  struct Task {
+    Job*         job;
+    unsigned int begin;
+    unsigned int end;
+
+    void run () {
+      this->job->f (this->begin, this->end);
+
+      std::lock_guard <std::mutex> lock (this->job->mutex);
+      if (--this->job->numPending == 0) {
+        this->job->done.notify_all ();
+      }
+    }
+  };
+
+  struct Queue {
+    std::mutex        mutex;
+    std::deque <Task> tasks;
+  };
+
+  // set while a thread runs tasks: nested jobs are run by the calling task's thread
+  thread_local bool isInLoop = false;
+
+  /* A pool of worker threads with one task queue per worker.
+   * A worker takes tasks from the back of its own queue and steals tasks from the front of
+   * other queues when its own queue is empty.
+   * Threads that submit a job take tasks of their own job too, until none is left, and
+   * then wait for the workers. They never run tasks of other jobs, which may have been
+   * submitted by other threads. */
+  class Pool {
+    public:
+      Pool (unsigned int numWorkers)
+        : queues    (numWorkers)
+        , numQueued (0)
+        , stop      (false)
+      {
+        for (std::unique_ptr <Queue>& q : this->queues) {
+          q.reset (new Queue);
+        }
+        for (unsigned int i = 0; i < numWorkers; i++) {
+          this->workers.emplace_back (&Pool::work, this, i);
+        }
+      }
+
+      ~Pool () {
+        {
+          std::lock_guard <std::mutex> lock (this->mutex);
+          this->stop = true;
+        }
+        this->wakeUp.notify_all ();
+
+        for (std::thread& w : this->workers) {
+          w.join ();
+        }
+      }
+
+      unsigned int numWorkers () const {
+        return this->workers.size ();
+      }
+
+      void run ( unsigned int n, unsigned int numRanges
+               , const std::function <void (unsigned int, unsigned int)>& f )
+      {
+        const unsigned int rangeSize = (n + numRanges - 1) / numRanges;
+        std::vector <Task> tasks;
+        Job                job (f, 0);
+
+        for (unsigned int begin = 0; begin < n; begin += rangeSize) {
+          tasks.push_back ({ &job, begin, std::min (n, begin + rangeSize) });
+        }
+        job.numPending = tasks.size ();
+
+        {
+          std::lock_guard <std::mutex> lock (this->mutex);
+          this->numQueued += tasks.size ();
+        }
+        for (unsigned int i = 0; i < tasks.size (); i++) {
+          Queue& queue = *this->queues [i % this->queues.size ()];
+
+          std::lock_guard <std::mutex> lock (queue.mutex);
+          queue.tasks.push_back (tasks [i]);
+        }
+        this->wakeUp.notify_all ();
+
+        Task task;
+        isInLoop = true;
+        while (this->takeOwn (job, task)) {
+          task.run ();
+        }
+        isInLoop = false;
+
+        std::unique_lock <std::mutex> lock (job.mutex);
+        job.done.wait (lock, [&job] () { return job.numPending == 0; });
+      }
+
+    private:
+      bool take (Queue& queue, bool back, Task& task) {
+        std::lock_guard <std::mutex> lock (queue.mutex);
+
+        if (queue.tasks.empty ()) {
+          return false;
+        }
+        else if (back) {
+          task = queue.tasks.back ();
+          queue.tasks.pop_back ();
+        }
+        else {
+          task = queue.tasks.front ();
+          queue.tasks.pop_front ();
+        }
+        this->numQueued--;
+        return true;
+      }
+
+      bool takeOwn (const Job& job, Task& task) {
+        for (std::unique_ptr <Queue>& queue : this->queues) {
+          std::lock_guard <std::mutex> lock (queue->mutex);
+
+          auto it = std::find_if ( queue->tasks.begin (), queue->tasks.end ()
+                                 , [&job] (const Task& t) { return t.job == &job; } );
+          if (it != queue->tasks.end ()) {
+            task = *it;
+            queue->tasks.erase (it);
+            this->numQueued--;
+            return true;
+          }
+        }
+        return false;
+      }
+
+      bool steal (unsigned int first, Task& task) {
+        for (unsigned int i = 0; i < this->queues.size (); i++) {
+          if (this->take (*this->queues [(first + i) % this->queues.size ()], false, task)) {
+            return true;
+          }
+        }
+        return false;
+      }
+
+      void work (unsigned int id) {
+        isInLoop = true;
+
+        while (true) {
+          Task task;
+
+          if (this->take (*this->queues [id], true, task) || this->steal (id + 1, task)) {
+            task.run ();
+          }
+          else {
+            std::unique_lock <std::mutex> lock (this->mutex);
+            this->wakeUp.wait (lock, [this] () { return this->stop || this->numQueued > 0; });
+
+            if (this->stop) {
+              return;
+            }
+          }
+        }
+      }
+
+      std::vector <std::unique_ptr <Queue>> queues;
+      std::vector <std::thread>             workers;
+      std::atomic <unsigned int>            numQueued;
+      bool                                  stop;
+      std::mutex                            mutex;
+      std::condition_variable               wakeUp;
+  };
+
+  unsigned int defaultNumThreads () {
+    return std::max (1u, std::thread::hardware_concurrency ());
+  }
+
+  std::unique_ptr <Pool>& pool () {
+    static std::unique_ptr <Pool> pool (new Pool (defaultNumThreads () - 1));
+    return pool;
+  }
+
+  // running loops share the pool, resizing it waits for them
+  std::shared_timed_mutex& poolMutex () {
+    static std::shared_timed_mutex mutex;
+    return mutex;
+  }
+
+  // a pending resize holds the gate, such that loops of other threads can not starve it
+  std::mutex& poolGate () {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  std::shared_lock <std::shared_timed_mutex> sharePool () {
+    std::lock_guard <std::mutex> gate (poolGate ());
+    return std::shared_lock <std::shared_timed_mutex> (poolMutex ());
+  }
+}
+
+unsigned int ParallelUtil :: numThreads () {
+  auto lock = sharePool ();
+  return pool ()->numWorkers () + 1;
+}
+
+void ParallelUtil :: numThreads (unsigned int n) {
+  assert (isInLoop == false);
+
+  const unsigned int numWorkers = (n == 0 ? defaultNumThreads ()
+                                          : std::min (n, ParallelUtil::maxNumThreads ())) - 1;
+
+  std::lock_guard <std::mutex>              gate (poolGate ());
+  std::lock_guard <std::shared_timed_mutex> lock (poolMutex ());
+
+  if (numWorkers != pool ()->numWorkers ()) {
+    pool ().reset (new Pool (numWorkers));
+  }
+}
+
+unsigned int ParallelUtil :: maxNumThreads () {
+  return maxThreadsPerHardwareThread * defaultNumThreads ();
+}
+
+void ParallelUtil :: forEachRange ( unsigned int n
+                                  , const std::function <void (unsigned int, unsigned int)>& f
+                                  , unsigned int minRangeSize )
+{
+  assert (minRangeSize > 0);
+
+  if (isInLoop == false && n >= 2 * minRangeSize) {
+    auto lock = sharePool ();
+
+    const unsigned int numThreads = pool ()->numWorkers () + 1;
+    const unsigned int numRanges  = std::min ( numThreads * rangesPerThread
+                                             , n / minRangeSize );
+    if (numThreads > 1) {
+      pool ()->run (n, numRanges, f);
+      return;
+    }
+  }
+  if (n > 0) {
+    f (0, n);
+  }
+}
+
+void ParallelUtil :: forEach ( unsigned int n, const std::function <void (unsigned int)>& f
+                             , unsigned int minRangeSize )
+{
+  ParallelUtil::forEachRange (n, [&f] (unsigned int begin, unsigned int end) {
+    for (unsigned int i = begin; i < end; i++) {
+      f (i);
+    }
+  }, minRangeSize);
+}
@@ -0,0 +1,40 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_PARALLEL_UTIL
+#define DILAY_PARALLEL_UTIL
+
+#include <functional>
+
+namespace ParallelUtil {
+
+  /** All parallel loops share a pool of `numThreads () - 1` worker threads. The calling
+   * thread of a loop helps with the ranges of its own loop. Idle threads steal ranges from
+   * busy ones.
+   * Loops that are started from within another loop run sequentially.
+   * Loops may be started from several threads at once. */
+  unsigned int numThreads    ();
+
+  /** `numThreads (n)` resizes the pool to `n` threads, or to the number of hardware threads
+   * if `n` is 0, where `n` is clamped to `maxNumThreads ()`.
+   * The pool is only rebuilt if its size changes, after all running loops have finished.
+   * It must not be called from within a loop. */
+  void         numThreads    (unsigned int);
+
+  /** `maxNumThreads ()` is a multiple of the number of hardware threads. */
+  unsigned int maxNumThreads ();
+
+  /** `forEachRange (n,f,m)` partitions `[0,n)` into contiguous ranges of at least `m`
+   * elements and calls `f (b,e)` for each range `[b,e)` in parallel.
+   * `f` must not write to data that is shared between ranges. */
+  void         forEachRange  ( unsigned int, const std::function <void (unsigned int, unsigned int)>&
+                             , unsigned int = 256 );
+
+  /** `forEach (n,f,m)` calls `f (i)` for each `i` in `[0,n)` in parallel, where ranges of at
+   * least `m` consecutive elements are run by the same thread. */
+  void         forEach       ( unsigned int, const std::function <void (unsigned int)>&
+                             , unsigned int = 256 );
+}
+
+#endif
@@ -30,10 +30,21 @@ namespace {
     }
     return false;
   }
+
+  // cheaper than `v.valence () == 3` because at most four adjacent edges are visited
+  bool isValence3 (const WingedVertex& v) {
+    unsigned int i             = 0;
+    AdjEdges     adjacentEdges = v.adjacentEdges ();
+    for (auto it = adjacentEdges.begin (); it != adjacentEdges.end () && i < 4; ++it) {
+      ++i;
+    }
+    return i == 3;
+  }
 }
 
 bool PartialAction::collapseEdge ( WingedMesh& mesh, WingedEdge& edge
-                                 , AffectedFaces& affectedFaces ) 
+                                 , AffectedFaces& affectedFaces, const glm::vec3* position
+                                 , WingedVertex** newVertexPtr )
 {
   assert (edge.leftFaceRef  ().numEdges () == 3);
   assert (edge.rightFaceRef ().numEdges () == 3);
@@ -46,34 +57,30 @@ bool PartialAction::collapseEdge ( WingedMesh& mesh, WingedEdge& edge
   WingedVertex& vertex4       = edgeToDelete2.otherVertexRef (vertex1);
 
   const unsigned int edgeIndex = edge.index ();
-  const unsigned int valence1  = vertex1.valence ();
-  const unsigned int valence2  = vertex2.valence ();
-  const unsigned int valence3  = vertex3.valence ();
-  const unsigned int valence4  = vertex4.valence ();
 
-  if (valence1 == 3) {
+  if (isValence3 (vertex1)) {
     PartialAction::deleteValence3Vertex (mesh, vertex1, affectedFaces);
     return true;
   }
-  else if (valence2 == 3) {
+  else if (isValence3 (vertex2)) {
     PartialAction::deleteValence3Vertex (mesh, vertex2, affectedFaces);
     return true;
   }
-  else if (valence3 == 3) {
+  else if (isValence3 (vertex3)) {
     PartialAction::deleteValence3Vertex (mesh, vertex3, affectedFaces);
 
     if (mesh.edge (edgeIndex)) {
-      return PartialAction::collapseEdge (mesh, edge, affectedFaces);
+      return PartialAction::collapseEdge (mesh, edge, affectedFaces, position, newVertexPtr);
     }
     else {
       return true;
     }
   }
-  else if (valence4 == 3) {
+  else if (isValence3 (vertex4)) {
     PartialAction::deleteValence3Vertex (mesh, vertex4, affectedFaces);
 
     if (mesh.edge (edgeIndex)) {
-      return PartialAction::collapseEdge (mesh, edge, affectedFaces);
+      return PartialAction::collapseEdge (mesh, edge, affectedFaces, position, newVertexPtr);
     }
     else {
       return true;
@@ -83,7 +90,11 @@ bool PartialAction::collapseEdge ( WingedMesh& mesh, WingedEdge& edge
     return false;
   }
   else {
-    WingedVertex& newVertex = mesh.addVertex (edge.middle (mesh));
+#ifndef NDEBUG
+    const unsigned int valence1 = vertex1.valence ();
+    const unsigned int valence2 = vertex2.valence ();
+#endif
+    WingedVertex& newVertex = mesh.addVertex (position ? *position : edge.middle (mesh));
 
     PartialAction::deleteEdgeFace (mesh, edgeToDelete1, affectedFaces);
     PartialAction::deleteEdgeFace (mesh, edgeToDelete2, affectedFaces);
@@ -133,6 +144,9 @@ bool PartialAction::collapseEdge ( WingedMesh& mesh, WingedEdge& edge
       assert (v.valence () > 2);
     }
 #endif
+    if (newVertexPtr) {
+      *newVertexPtr = &newVertex;
+    }
     return true;
   }
 }
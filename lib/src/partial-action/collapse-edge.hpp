@@ -5,13 +5,21 @@
 #ifndef DILAY_PARTIAL_ACTION_COLLAPSE_EDGE
 #define DILAY_PARTIAL_ACTION_COLLAPSE_EDGE
 
+#include <glm/fwd.hpp>
+
 class AffectedFaces;
 class WingedEdge;
 class WingedMesh;
+class WingedVertex;
 
 namespace PartialAction {
 
-  bool collapseEdge (WingedMesh&, WingedEdge&, AffectedFaces&);
+  /** `collapseEdge (m,e,a,p,v)` merges the vertices of `e` into a new vertex at `p`, or at
+   * the middle of `e` if `p` is not given.
+   * If a vertex of `e` or of its adjacent faces has valence 3, it is deleted instead.
+   * `v` is set to the new vertex, if any. */
+  bool collapseEdge ( WingedMesh&, WingedEdge&, AffectedFaces&
+                    , const glm::vec3* = nullptr, WingedVertex** = nullptr );
 };
 
 #endif
@@ -0,0 +1,121 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <algorithm>
+#include <queue>
+#include "adjacent-iterator.hpp"
+#include "affected-faces.hpp"
+#include "parallel-util.hpp"
+#include "partial-action/collapse-edge.hpp"
+#include "partial-action/collapse-edges.hpp"
+#include "winged/edge.hpp"
+#include "winged/face.hpp"
+#include "winged/mesh.hpp"
+
+namespace {
+  struct Candidate {
+    float        cost;
+    unsigned int index;
+    unsigned int stamp;
+
+    bool operator< (const Candidate& other) const {
+      return this->cost > other.cost;
+    }
+  };
+
+  /** `Stamps` maps the index of each candidate edge to its current stamp.
+   * A candidate is invalidated by increasing the stamp of its edge. */
+  class Stamps {
+    public:
+      Stamps (const EdgePtrVec& edges) {
+        this->stamps.reserve (edges.size ());
+
+        for (WingedEdge* e : edges) {
+          this->stamps.emplace_back (e->index (), 0);
+        }
+        std::sort (this->stamps.begin (), this->stamps.end ());
+      }
+
+      unsigned int* find (unsigned int index) {
+        auto it = std::lower_bound ( this->stamps.begin (), this->stamps.end ()
+                                   , std::make_pair (index, 0u) );
+
+        return (it != this->stamps.end () && it->first == index) ? &it->second : nullptr;
+      }
+
+    private:
+      std::vector <std::pair <unsigned int, unsigned int>> stamps;
+  };
+}
+
+void PartialAction :: collapseEdges ( WingedMesh& mesh, const EdgePtrVec& edges
+                                    , const CollapseCost& cost, float maxCost
+                                    , unsigned int minNumFaces, AffectedFaces& affectedFaces )
+{
+  auto collapse = [&mesh] (WingedEdge& edge, AffectedFaces& faces) {
+    return PartialAction::collapseEdge (mesh, edge, faces);
+  };
+  PartialAction::collapseEdges (mesh, edges, cost, collapse, maxCost, minNumFaces, affectedFaces);
+}
+
+void PartialAction :: collapseEdges ( WingedMesh& mesh, const EdgePtrVec& edges
+                                    , const CollapseCost& cost, const Collapse& collapse
+                                    , float maxCost, unsigned int minNumFaces
+                                    , AffectedFaces& affectedFaces )
+{
+  Stamps                 stamps (edges);
+  std::vector <Candidate> initialCandidates (edges.size ());
+
+  ParallelUtil::forEach (edges.size (), [&edges, &cost, &initialCandidates] (unsigned int i) {
+    initialCandidates [i] = Candidate {cost (*edges [i]), edges [i]->index (), 0};
+  });
+
+  std::priority_queue <Candidate> candidates ( std::less <Candidate> ()
+                                             , std::move (initialCandidates) );
+
+  auto update = [&] (const WingedEdge& edge) {
+    unsigned int* stamp = stamps.find (edge.index ());
+
+    if (stamp) {
+      (*stamp)++;
+      candidates.push (Candidate {cost (edge), edge.index (), *stamp});
+    }
+  };
+
+  affectedFaces.commit ();
+
+  while (candidates.empty () == false && mesh.numFaces () > minNumFaces) {
+    const Candidate candidate = candidates.top ();
+
+    if (candidate.cost >= maxCost) {
+      break;
+    }
+    candidates.pop ();
+
+    WingedEdge*   edge  = mesh.edge (candidate.index);
+    unsigned int* stamp = stamps.find (candidate.index);
+
+    if (edge == nullptr || *stamp != candidate.stamp) {
+      continue;
+    }
+    (*stamp)++;
+
+    if (collapse (*edge, affectedFaces)) {
+      if (mesh.isEmpty ()) {
+        return;
+      }
+      EdgePtrSet adjacentEdges;
+
+      for (WingedFace* f : affectedFaces.uncommitedFaces ()) {
+        for (WingedEdge& e : f->adjacentEdges ()) {
+          adjacentEdges.insert (&e);
+        }
+      }
+      for (WingedEdge* e : adjacentEdges) {
+        update (*e);
+      }
+    }
+    affectedFaces.commit ();
+  }
+}
@@ -0,0 +1,31 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_PARTIAL_ACTION_COLLAPSE_EDGES
+#define DILAY_PARTIAL_ACTION_COLLAPSE_EDGES
+
+#include <functional>
+#include "winged/fwd.hpp"
+
+class AffectedFaces;
+
+namespace PartialAction {
+
+  typedef std::function <float (const WingedEdge&)>          CollapseCost;
+  typedef std::function <bool  (WingedEdge&, AffectedFaces&)> Collapse;
+
+  /** `collapseEdges (m,es,c,maxC,minF,a)` collapses edges of `es` in order of increasing
+   * cost `c` until the cheapest remaining edge costs at least `maxC` or until `m` has
+   * at most `minF` faces.
+   * The costs of edges of `es` that are adjacent to a collapsed edge are re-evaluated. */
+  void collapseEdges ( WingedMesh&, const EdgePtrVec&, const CollapseCost&
+                     , float, unsigned int, AffectedFaces& );
+
+  /** `collapseEdges (m,es,c,col,maxC,minF,a)` collapses edges by `col` rather than by
+   * `collapseEdge`. */
+  void collapseEdges ( WingedMesh&, const EdgePtrVec&, const CollapseCost&, const Collapse&
+                     , float, unsigned int, AffectedFaces& );
+};
+
+#endif
@@ -2,6 +2,7 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <limits>
 #include "affected-faces.hpp"
 #include "partial-action/collapse-edge.hpp"
 #include "partial-action/collapse-face.hpp"
@@ -42,9 +43,17 @@ void PartialAction :: collapseFace ( WingedMesh& mesh, WingedFace& face
                           , face.edgeRef ().successor (face)
                           , face.edgeRef ().successor (face, 1) };
 
-    float distances[] = { edges[0]->lengthSqr (mesh)
-                        , edges[1]->lengthSqr (mesh)
-                        , edges[2]->lengthSqr (mesh) };
+    // edges of masked vertices are collapsed last
+    auto distance = [&mesh] (const WingedEdge& edge) -> float {
+      return mesh.isMasked (edge.vertex1Ref ().index ())
+          || mesh.isMasked (edge.vertex2Ref ().index ())
+           ? std::numeric_limits <float>::max ()
+           : edge.lengthSqr (mesh);
+    };
+
+    float distances[] = { distance (*edges[0])
+                        , distance (*edges[1])
+                        , distance (*edges[2]) };
 
     for (unsigned int i = 0; i < 2; i++) {
       if (distances[1] < distances[0]) {
@@ -11,6 +11,8 @@ class WingedMesh;
 
 namespace PartialAction {
 
+  /** `collapseFace (m,f,a)` collapses the shortest edge of `f` that can be collapsed.
+   * Edges of masked vertices are collapsed only if there is no other edge. */
   void collapseFace (WingedMesh&, WingedFace&, AffectedFaces&);
 };
 
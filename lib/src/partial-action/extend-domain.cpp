@@ -0,0 +1,82 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <unordered_map>
+#include "adjacent-iterator.hpp"
+#include "affected-faces.hpp"
+#include "partial-action/extend-domain.hpp"
+#include "winged/face.hpp"
+#include "winged/mesh.hpp"
+#include "winged/vertex.hpp"
+
+namespace {
+  void addRings (const WingedMesh& mesh, AffectedFaces& domain, unsigned int numRings) {
+    FacePtrVec ring (domain.faces ().begin (), domain.faces ().end ());
+    FacePtrVec nextRing;
+
+    for (unsigned int i = 0; i < numRings && ring.empty () == false; i++) {
+      for (WingedFace* f : ring) {
+        for (WingedFace& a : f->adjacentFaces ()) {
+          if (domain.contains (a) == false && mesh.isMasked (a) == false) {
+            domain.insert (a);
+            nextRing.push_back (&a);
+          }
+        }
+      }
+      ring.swap (nextRing);
+      nextRing.clear ();
+    }
+    domain.commit ();
+  }
+
+  void extendToNeighbourhood (const WingedMesh& mesh, AffectedFaces& domain) {
+    // number of adjacent faces in the domain of each visited face outside of the domain
+    std::unordered_map <WingedFace*, unsigned int> numInDomain;
+    std::unordered_map <WingedVertex*, bool>       isPole;
+
+    auto isPoleVertex = [&isPole] (WingedVertex& vertex) -> bool {
+      auto it = isPole.find (&vertex);
+
+      if (it == isPole.end ()) {
+        it = isPole.emplace (&vertex, vertex.valence () > 9).first;
+      }
+      return it->second;
+    };
+
+    auto hasPoleVertex = [&isPoleVertex] (WingedFace& face) -> bool {
+      for (WingedVertex& v : face.adjacentVertices ()) {
+        if (isPoleVertex (v)) {
+          return true;
+        }
+      }
+      return false;
+    };
+
+    FacePtrVec worklist (domain.faces ().begin (), domain.faces ().end ());
+
+    while (worklist.empty () == false) {
+      WingedFace* face = worklist.back ();
+      worklist.pop_back ();
+
+      for (WingedFace& a : face->adjacentFaces ()) {
+        if (domain.contains (a) == false && mesh.isMasked (a) == false) {
+          const unsigned int n = ++numInDomain [&a];
+
+          if (n >= 2 || (n == 1 && hasPoleVertex (a))) {
+            domain.insert (a);
+            worklist.push_back (&a);
+          }
+        }
+      }
+    }
+    domain.commit ();
+  }
+}
+
+void PartialAction :: extendDomain ( const WingedMesh& mesh, AffectedFaces& domain
+                                   , unsigned int numRings )
+{
+  addRings              (mesh, domain, numRings);
+  extendToNeighbourhood (mesh, domain);
+}
@@ -0,0 +1,20 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_PARTIAL_ACTION_EXTEND_DOMAIN
+#define DILAY_PARTIAL_ACTION_EXTEND_DOMAIN
+
+class AffectedFaces;
+class WingedMesh;
+
+namespace PartialAction {
+
+  /** `extendDomain (m,d,n)` adds `n` rings of adjacent faces of mesh `m` to `d`.
+   * Afterwards, `d` is closed under its neighbourhood: each face that has at least two
+   * adjacent faces in `d` or that has a pole vertex is added to `d`.
+   * Masked faces are never added. */
+  void extendDomain (const WingedMesh&, AffectedFaces&, unsigned int);
+};
+
+#endif
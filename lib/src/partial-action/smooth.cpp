@@ -5,6 +5,7 @@
 #include "adjacent-iterator.hpp"
 #include "affected-faces.hpp"
 #include "intersection.hpp"
+#include "parallel-util.hpp"
 #include "partial-action/smooth.hpp"
 #include "primitive/ray.hpp"
 #include "primitive/triangle.hpp"
@@ -14,87 +15,121 @@
 #include "winged/vertex.hpp"
 
 namespace {
-  void iteration (WingedMesh& mesh, const VertexPtrSet& vertices) {
-    typedef std::vector <PrimTriangle> AdjTriangles;
+  /** `OneRings` stores the adjacent vertices and faces of a set of vertices as
+   * compressed rows: the one-ring of the `i`-th vertex is stored in
+   * `[offsets [i], offsets [i+1])` of `adjVertices` and `adjFaces`.
+   * `triangles` stores three vertex indices per adjacent face. */
+  struct OneRings {
+    std::vector <unsigned int> vertices;
+    std::vector <unsigned int> offsets;
+    std::vector <unsigned int> adjVertices;
+    std::vector <WingedFace*>  adjFaces;
+    std::vector <unsigned int> triangles;
+    std::vector <glm::vec3>    newPositions;
+
+    OneRings (const VertexPtrSet& vs) {
+      this->vertices    .reserve (vs.size ());
+      this->offsets     .reserve (vs.size () + 1);
+      this->newPositions.resize  (vs.size ());
+
+      for (WingedVertex* v : vs) {
+        AdjFaces adjacent (v->adjacentFaces ());
+
+        this->vertices.push_back (v->index ());
+        this->offsets .push_back (this->adjFaces.size ());
+
+        for (auto it = adjacent.begin (); it != adjacent.end (); ++it) {
+          this->adjVertices.push_back (it.edge ()->otherVertexRef (*v).index ());
+          this->adjFaces   .push_back (&*it);
+          this->triangles  .push_back (it->vertexRef (0).index ());
+          this->triangles  .push_back (it->vertexRef (1).index ());
+          this->triangles  .push_back (it->vertexRef (2).index ());
+        }
+      }
+      this->offsets.push_back (this->adjFaces.size ());
+    }
 
-    auto getData = [&mesh] ( const WingedVertex& v
-                           , glm::vec3& position, glm::vec3& delta, AdjTriangles& adjTriangles ) 
-    {
-      assert (adjTriangles.empty ());
+    unsigned int numVertices () const {
+      return this->vertices.size ();
+    }
 
-      position = v.position (mesh);
-      delta    = glm::vec3 (0.0f);
+    PrimTriangle triangle (const WingedMesh& mesh, unsigned int k) const {
+      return PrimTriangle ( mesh.vector (this->triangles [(3 * k) + 0])
+                          , mesh.vector (this->triangles [(3 * k) + 1])
+                          , mesh.vector (this->triangles [(3 * k) + 2]) );
+    }
 
-      AdjFaces     adjFaces (v.adjacentFaces ());
-      unsigned int valence  (0);
+    glm::vec3 delta (const WingedMesh& mesh, unsigned int i) const {
+      const glm::vec3 position = mesh.vector (this->vertices [i]);
+      glm::vec3       delta    = glm::vec3 (0.0f);
 
-      for (auto it = adjFaces.begin (); it != adjFaces.end (); ++it) {
-        adjTriangles.push_back (it->triangle (mesh));
-        delta += it.edge ()->otherVertexRef (v).position (mesh) - position;
-        valence++;
+      for (unsigned int k = this->offsets [i]; k < this->offsets [i+1]; k++) {
+        delta += mesh.vector (this->adjVertices [k]) - position;
       }
-      delta /= float (valence);
-    };
+      return delta / float (this->offsets [i+1] - this->offsets [i]);
+    }
+  };
 
-    auto getInterpolatedNormal = [] (const AdjTriangles& triangles) -> glm::vec3 {
-      glm::vec3    normal = glm::vec3 (0.0f);
-      unsigned int n      = 0;
+  // records all vertices of `r` in the log of `m` once, before they are moved in parallel
+  void logVertices (WingedMesh& mesh, const OneRings& rings) {
+    for (unsigned int i : rings.vertices) {
+      mesh.logVertex (i);
+    }
+  }
 
-      for (const PrimTriangle& tri : triangles) {
-        if (tri.isDegenerated () == false) {
-          normal += tri.normal ();
-          n++;
-        }
-      }
-      return n == 0 ? glm::vec3 (0.0f) : normal / float (n);
-    };
+  /** `iteration (m,r,f)` computes the new position `f (i)` of each vertex of `r` in
+   * parallel, before any position of `m` is updated. */
+  void iteration ( WingedMesh& mesh, OneRings& rings
+                 , const std::function <glm::vec3 (unsigned int)>& newPosition )
+  {
+    ParallelUtil::forEach (rings.numVertices (), [&rings, &newPosition] (unsigned int i) {
+      rings.newPositions [i] = newPosition (i);
+    });
+    ParallelUtil::forEach (rings.numVertices (), [&mesh, &rings] (unsigned int i) {
+      mesh.setLoggedVertex (rings.vertices [i], rings.newPositions [i]);
+    });
+  }
 
-    std::vector <glm::vec3> newPositions;
-    newPositions.reserve (vertices.size ());
+  glm::vec3 tangentialPosition (const WingedMesh& mesh, const OneRings& rings, unsigned int i) {
+    const glm::vec3 position = mesh.vector (rings.vertices [i]);
+    const glm::vec3 delta    = rings.delta (mesh, i);
+    glm::vec3       normal   = glm::vec3 (0.0f);
+    unsigned int    n        = 0;
 
-    for (WingedVertex* v : vertices) {
-      glm::vec3    position;
-      glm::vec3    delta;
-      AdjTriangles adjTriangles;
+    for (unsigned int k = rings.offsets [i]; k < rings.offsets [i+1]; k++) {
+      const PrimTriangle tri = rings.triangle (mesh, k);
 
-      getData (*v, position, delta, adjTriangles);
+      if (tri.isDegenerated () == false) {
+        normal += tri.normal ();
+        n++;
+      }
+    }
 
-      const glm::vec3 normal (getInterpolatedNormal (adjTriangles));
+    if (n == 0 || normal == glm::vec3 (0.0f)) {
+      return position;
+    }
+    else {
+      normal /= float (n);
 
-      if (normal == glm::vec3 (0.0f)) {
-        newPositions.push_back (position);
-      }
-      else {
-        const float     dot  (glm::dot (normal, delta));
-        const glm::vec3 newP ((position + delta) - (normal * dot));
-        const PrimRay   ray  (true, newP, normal);
-
-        bool intersected (false);
-        for (const PrimTriangle& tri : adjTriangles) {
-          if (tri.isDegenerated ()) {
-            continue;
-          }
-          else {
-            float t;
-            if (IntersectionUtil::intersects (ray, tri, &t)) {
-              newPositions.push_back (ray.pointAt (t));
-              intersected = true;
-              break;
-            }
-          }
-        }
-        if (intersected == false) {
-          newPositions.push_back (newP);
+      const float     dot  (glm::dot (normal, delta));
+      const glm::vec3 newP ((position + delta) - (normal * dot));
+      const PrimRay   ray  (true, newP, normal);
+
+      for (unsigned int k = rings.offsets [i]; k < rings.offsets [i+1]; k++) {
+        const PrimTriangle tri = rings.triangle (mesh, k);
+        float              t;
+
+        if (tri.isDegenerated () == false && IntersectionUtil::intersects (ray, tri, &t)) {
+          return ray.pointAt (t);
         }
       }
+      return newP;
     }
+  }
 
-    auto posIt = newPositions.begin ();
-    for (WingedVertex* v : vertices) {
-      assert (posIt != newPositions.end ());
-
-      mesh.setVertex (v->index (), *posIt);
-      ++posIt;
+  void insertAffectedFaces (const OneRings& rings, AffectedFaces& affectedFaces) {
+    for (WingedFace* f : rings.adjFaces) {
+      affectedFaces.insert (*f);
     }
   }
 }
@@ -102,13 +137,35 @@ namespace {
 void PartialAction :: smooth ( WingedMesh& mesh, const VertexPtrSet& vertices
                              , unsigned int numIterations, AffectedFaces& affectedFaces ) 
 {
+  OneRings rings (vertices);
+
+  logVertices (mesh, rings);
   for (unsigned int i = 0; i < numIterations; i++) {
-    iteration (mesh, vertices);
+    iteration (mesh, rings, [&mesh, &rings] (unsigned int j) {
+      return tangentialPosition (mesh, rings, j);
+    });
   }
+  insertAffectedFaces (rings, affectedFaces);
+}
 
+void PartialAction :: smooth ( WingedMesh& mesh, const VertexPtrSet& vertices
+                             , unsigned int numIterations, const SmoothWeight& weight
+                             , AffectedFaces& affectedFaces )
+{
+  OneRings            rings (vertices);
+  std::vector <float> weights;
+
+  // `rings.vertices` has the same order as `vertices`
+  weights.reserve (rings.numVertices ());
   for (WingedVertex* v : vertices) {
-    for (WingedFace& f : v->adjacentFaces ()) {
-      affectedFaces.insert (f);
-    }
+    weights.push_back (weight (*v));
+  }
+
+  logVertices (mesh, rings);
+  for (unsigned int i = 0; i < numIterations; i++) {
+    iteration (mesh, rings, [&mesh, &rings, &weights] (unsigned int j) {
+      return mesh.vector (rings.vertices [j]) + (weights [j] * rings.delta (mesh, j));
+    });
   }
+  insertAffectedFaces (rings, affectedFaces);
 }
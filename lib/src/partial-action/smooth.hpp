@@ -5,13 +5,22 @@
 #ifndef DILAY_PARTIAL_ACTION_SMOOTH
 #define DILAY_PARTIAL_ACTION_SMOOTH
 
+#include <functional>
 #include "winged/fwd.hpp"
 
 class AffectedFaces;
 
 namespace PartialAction {
 
+  typedef std::function <float (const WingedVertex&)> SmoothWeight;
+
   void smooth (WingedMesh&, const VertexPtrSet&, unsigned int, AffectedFaces&);
+
+  /** `smooth (m,vs,n,w,a)` moves each vertex `v` of `vs` towards the center of its
+   * adjacent vertices by factor `w (v)`, which is evaluated once before the first of
+   * `n` iterations. */
+  void smooth ( WingedMesh&, const VertexPtrSet&, unsigned int, const SmoothWeight&
+              , AffectedFaces& );
 };
 
 #endif
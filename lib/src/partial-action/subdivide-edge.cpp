@@ -3,8 +3,6 @@
  * Use and redistribute under the terms of the GNU General Public License
  */
 #include <glm/glm.hpp>
-#include "adjacent-iterator.hpp"
-#include "affected-faces.hpp"
 #include "partial-action/insert-edge-vertex.hpp"
 #include "partial-action/triangulate-quad.hpp"
 #include "partial-action/subdivide-edge.hpp"
@@ -13,63 +11,6 @@
 #include "winged/face.hpp"
 #include "winged/vertex.hpp"
 
-namespace {
-  void addOneRing (AffectedFaces& domain) {
-    for (WingedFace* d : domain.faces ()) {
-      for (WingedFace& f : d->adjacentFaces ()) {
-        domain.insert (f);
-      }
-    }
-    domain.commit ();
-  }
-
-  void extendToNeighbourhood (AffectedFaces& domain) {
-    auto hasAtLeast2NeighboursInDomain = [&domain] (WingedFace& face) -> bool {
-      unsigned int numInDomain = 0;
-
-      for (WingedFace& a : face.adjacentFaces ()) {
-        if (domain.contains (a)) {
-          numInDomain++;
-        }
-      }
-      return numInDomain >= 2;
-    };
-
-    auto hasPoleVertex = [] (WingedFace& face) -> bool {
-      for (WingedVertex& v : face.adjacentVertices ()) {
-        if (v.valence () > 9) {
-          return true;
-        }
-      }
-      return false;
-    };
-
-    auto extendTo = [&] (WingedFace& face) -> bool {
-      return hasAtLeast2NeighboursInDomain (face) || hasPoleVertex (face);
-    };
-
-    std::function <void (WingedFace&)> checkAdjacents = [&] (WingedFace& face) -> void {
-      for (WingedFace& a : face.adjacentFaces ()) {
-        if (domain.contains (a) == false && extendTo (a)) {
-          domain.insert  (a);
-          checkAdjacents (a);
-        }
-      }
-    };
-
-    for (WingedFace* f : domain.faces ()) {
-      checkAdjacents (*f);
-    }
-    domain.commit ();
-  }
-}
-
-void PartialAction :: extendDomain (AffectedFaces& domain) {
-  addOneRing            (domain);
-  addOneRing            (domain);
-  extendToNeighbourhood (domain);
-}
-
 void PartialAction :: subdivideEdge ( WingedMesh& mesh, WingedEdge& edge
                                     , AffectedFaces& affectedFaces )
 {
@@ -11,7 +11,6 @@ class AffectedFaces;
 
 namespace PartialAction {
 
-  void extendDomain  (AffectedFaces&);
   void subdivideEdge (WingedMesh&, WingedEdge&, AffectedFaces&);
 }
 
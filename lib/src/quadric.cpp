@@ -0,0 +1,65 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include "primitive/plane.hpp"
+#include "quadric.hpp"
+#include "util.hpp"
+
+Quadric :: Quadric ()
+  : diagonal    (0.0f)
+  , offDiagonal (0.0f)
+  , linear      (0.0f)
+  , constant    (0.0f)
+{}
+
+Quadric :: Quadric (const PrimPlane& plane, float weight) {
+  const glm::vec3& n = plane.normal ();
+  const float      d = glm::dot (n, plane.point ());
+
+  this->diagonal    = weight * n * n;
+  this->offDiagonal = weight * glm::vec3 (n.x * n.y, n.x * n.z, n.y * n.z);
+  this->linear      = weight * d * n;
+  this->constant    = weight * d * d;
+}
+
+void Quadric :: add (const Quadric& other) {
+  this->diagonal    += other.diagonal;
+  this->offDiagonal += other.offDiagonal;
+  this->linear      += other.linear;
+  this->constant    += other.constant;
+}
+
+float Quadric :: error (const glm::vec3& p) const {
+  const glm::vec3& d = this->diagonal;
+  const glm::vec3& o = this->offDiagonal;
+  const glm::vec3  a = glm::vec3 ( (d.x * p.x) + (o.x * p.y) + (o.y * p.z)
+                                 , (o.x * p.x) + (d.y * p.y) + (o.z * p.z)
+                                 , (o.y * p.x) + (o.z * p.y) + (d.z * p.z) );
+
+  return glm::max (0.0f, glm::dot (p, a) - (2.0f * glm::dot (p, this->linear)) + this->constant);
+}
+
+bool Quadric :: minimize (glm::vec3& p) const {
+  const glm::vec3& d     = this->diagonal;
+  const glm::vec3& o     = this->offDiagonal;
+  const glm::vec3  r0    = glm::vec3 (d.x, o.x, o.y);
+  const glm::vec3  r1    = glm::vec3 (o.x, d.y, o.z);
+  const glm::vec3  r2    = glm::vec3 (o.y, o.z, d.z);
+  const glm::vec3  c0    = glm::cross (r1, r2);
+  const glm::vec3  c1    = glm::cross (r2, r0);
+  const glm::vec3  c2    = glm::cross (r0, r1);
+  const float      det   = glm::dot (r0, c0);
+  const float      trace = d.x + d.y + d.z;
+
+  // the determinant is compared to the largest determinant of a matrix with the same trace
+  if (glm::abs (det) <= Util::epsilon () * trace * trace * trace) {
+    return false;
+  }
+  else {
+    const glm::vec3& b = this->linear;
+
+    p = ((c0 * b.x) + (c1 * b.y) + (c2 * b.z)) / det;
+    return true;
+  }
+}
@@ -0,0 +1,35 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_QUADRIC
+#define DILAY_QUADRIC
+
+#include <glm/glm.hpp>
+
+class PrimPlane;
+
+/** A `Quadric` measures the weighted sum of squared distances of a position to a set of
+ * planes (cf. Garland and Heckbert: Surface simplification using quadric error metrics).
+ * The quadric of a set of planes is the sum of the quadrics of its planes. */
+class Quadric {
+  public:
+    Quadric ();
+    Quadric (const PrimPlane&, float);
+
+    void  add   (const Quadric&);
+    float error (const glm::vec3&) const;
+
+    /** `minimize (p)` sets `p` to the position of minimal error and returns `true`, if this
+     * position is unique.
+     * Otherwise, e.g. if all planes are parallel, `p` remains unchanged. */
+    bool  minimize (glm::vec3&) const;
+
+  private:
+    glm::vec3 diagonal;
+    glm::vec3 offDiagonal;
+    glm::vec3 linear;
+    float     constant;
+};
+
+#endif
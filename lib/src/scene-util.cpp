@@ -15,6 +15,8 @@
 #include "util.hpp"
 
 namespace {
+  typedef std::vector <bool> MeshMask;
+
   void toDlyFile (std::ostream& stream, const Mesh& mesh) {
     stream << "o\n";
     for (unsigned int i = 0; i < mesh.numVertices (); i++) {
@@ -27,6 +29,21 @@ namespace {
     }
   }
 
+  // masked vertices are stored as ranges of (1-based) indices
+  void toDlyFile (std::ostream& stream, const MeshMask& mask) {
+    for (unsigned int i = 0; i < mask.size (); i++) {
+      if (mask [i]) {
+        unsigned int j = i;
+
+        while (j + 1 < mask.size () && mask [j + 1]) {
+          j++;
+        }
+        stream << "dly_mask " << i + 1 << " " << j + 1 << std::endl;
+        i = j;
+      }
+    }
+  }
+
   unsigned int toDlyFile ( std::ostream& stream, const SketchNode& node
                          , unsigned int parentIndex, unsigned nodeIndex )
   {
@@ -80,8 +97,12 @@ namespace {
 namespace SceneUtil {
 
   void toDlyFile (std::ostream& stream, const Scene& scene, bool isObjFile) {
-    scene.forEachConstMesh ([&stream] (const WingedMesh& mesh) {
+    scene.forEachConstMesh ([&stream, isObjFile] (const WingedMesh& mesh) {
       ::toDlyFile (stream, mesh.makePrunedMesh ());
+
+      if (isObjFile == false) {
+        ::toDlyFile (stream, mesh.makePrunedMask ());
+      }
     });
 
     if (isObjFile == false) {
@@ -109,6 +130,7 @@ namespace SceneUtil {
     std::istringstream        lineStream;
 
     std::vector <Mesh>        meshes;
+    std::vector <MeshMask>    masks;
     std::vector <SketchNode*> nodes;
     SketchMesh*               sketch;
     SketchPath*               sketchPath;
@@ -195,6 +217,27 @@ namespace SceneUtil {
             }
           }
         }
+        else if (keyword == "dly_mask") {
+          unsigned int first, last;
+          lineStream >> first >> last;
+
+          if ( lineStream.fail () || meshes.empty () || first == 0 || first > last
+                                  || last > meshes.back ().numVertices () )
+          {
+            DILAY_WARN ("could not parse mask at line %u", lineNumber)
+            return false;
+          }
+          else {
+            masks.resize (meshes.size ());
+
+            MeshMask& mask = masks.back ();
+
+            if (mask.size () < last) {
+              mask.resize (last, false);
+            }
+            std::fill (mask.begin () + first - 1, mask.begin () + last, true);
+          }
+        }
         else if (keyword == "dly_sketch_mesh") {
           nodes.clear ();
           sketch = &scene.newSketchMesh (config, SketchTree ());
@@ -274,16 +317,20 @@ namespace SceneUtil {
         }
       }
     }
-    meshes.erase ( std::remove_if ( meshes.begin ()
-                                  , meshes.end   ()
-                                  , [] (Mesh& m) { return m.numVertices () == 0; } )
-                 , meshes.end () );
+    masks.resize (meshes.size ());
+
+    for (unsigned int i = meshes.size (); i > 0; i--) {
+      if (meshes [i - 1].numVertices () == 0) {
+        meshes.erase (meshes.begin () + i - 1);
+        masks .erase (masks .begin () + i - 1);
+      }
+    }
 
     if (std::all_of ( meshes.begin (), meshes.end ()
                     , [] (Mesh& m) { return MeshUtil::checkConsistency (m); } ))
     {
-      for (Mesh& m : meshes) {
-        scene.newWingedMesh (config, m);
+      for (unsigned int i = 0; i < meshes.size (); i++) {
+        scene.newWingedMesh (config, meshes [i]).mask (masks [i]);
       }
       return true;
     }
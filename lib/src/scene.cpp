@@ -12,6 +12,7 @@
 #include "sketch/mesh-intersection.hpp"
 #include "sketch/node-intersection.hpp"
 #include "sketch/path-intersection.hpp"
+#include "sketch/preview.hpp"
 #include "winged/face-intersection.hpp"
 #include "winged/mesh.hpp"
 #include "winged/util.hpp"
@@ -20,6 +21,7 @@ struct Scene :: Impl {
   Scene*                            self;
   IntrusiveIndexedList <WingedMesh> wingedMeshes;
   IntrusiveIndexedList <SketchMesh> sketchMeshes;
+  SketchPreview                     sketchPreview;
   RenderMode                        commonRenderMode;
   std::string                       fileName;
 
@@ -42,6 +44,19 @@ struct Scene :: Impl {
     return wingedMesh;
   }
 
+  WingedMesh& newWingedMesh ( const Config& config, unsigned int index, const Mesh& mesh
+                            , const std::vector <bool>& liveVertices
+                            , const std::vector <bool>& liveFaces )
+  {
+    WingedMesh& wingedMesh = this->wingedMeshes.emplaceAt (index);
+
+    wingedMesh.fromMesh (mesh, liveVertices, liveFaces);
+    wingedMesh.renderMode () = this->commonRenderMode;
+
+    this->runFromConfig (config, wingedMesh);
+    return wingedMesh;
+  }
+
   SketchMesh& newSketchMesh (const Config& config, const SketchTree& tree) {
     SketchMesh& mesh = this->sketchMeshes.emplaceBack ();
 
@@ -58,6 +73,7 @@ struct Scene :: Impl {
   }
 
   void deleteMesh (SketchMesh& mesh) {
+    this->sketchPreview.remove (mesh);
     this->sketchMeshes.deleteElement (mesh);
     this->resetIfEmpty ();
   }
@@ -67,6 +83,7 @@ struct Scene :: Impl {
   }
 
   void deleteSketchMeshes () {
+    this->sketchPreview.reset ();
     this->sketchMeshes.reset ();
   }
 
@@ -98,6 +115,7 @@ struct Scene :: Impl {
     this->forEachMesh ([&] (SketchMesh& m) {
       m.render (camera);
     });
+    this->sketchPreview.render (camera);
   }
 
   template <typename TMesh, typename TIntersection, typename ... Ts>
@@ -269,6 +287,7 @@ struct Scene :: Impl {
     this->fileName = newFileName;
 
     if (SceneUtil::fromDlyFile (this->fileName, config, *this->self)) {
+      this->updateSketchPreviews ();
       return true;
     }
     else {
@@ -277,6 +296,12 @@ struct Scene :: Impl {
     }
   }
   
+  void updateSketchPreviews () {
+    this->forEachMesh ([this] (SketchMesh& mesh) {
+      this->sketchPreview.update (mesh);
+    });
+  }
+
   void runFromConfig (const Config& config, WingedMesh& mesh) {
     ConfigProxy wingedMeshConfig (config, "editor/mesh/");
 
@@ -291,12 +316,14 @@ struct Scene :: Impl {
     this->forEachMesh ([this, &config] (SketchMesh& mesh) {
       mesh.fromConfig (config);
     });
+    this->sketchPreview.fromConfig (config);
   }
 };
 
 DELEGATE1_BIG3_SELF (Scene, const Config&)
 
 DELEGATE2       (WingedMesh&       , Scene, newWingedMesh, const Config&, const Mesh&)
+DELEGATE5       (WingedMesh&       , Scene, newWingedMesh, const Config&, unsigned int, const Mesh&, const std::vector <bool>&, const std::vector <bool>&)
 DELEGATE2       (SketchMesh&       , Scene, newSketchMesh, const Config&, const SketchTree&)
 DELEGATE1       (void              , Scene, deleteMesh, WingedMesh&)
 DELEGATE1       (void              , Scene, deleteMesh, SketchMesh&)
@@ -333,4 +360,6 @@ GETTER_CONST    (const std::string&, Scene, fileName)
 DELEGATE1       (bool              , Scene, toDlyFile, bool)
 DELEGATE2       (bool              , Scene, toDlyFile, const std::string&, bool)
 DELEGATE2       (bool              , Scene, fromDlyFile, const Config&, const std::string&)
+GETTER          (SketchPreview&    , Scene, sketchPreview)
+DELEGATE        (void              , Scene, updateSketchPreviews)
 DELEGATE1       (void              , Scene, runFromConfig, const Config&)
@@ -6,6 +6,7 @@
 #define DILAY_SCENE
 
 #include <string>
+#include <vector>
 #include "configurable.hpp"
 #include "macro.hpp"
 #include "sketch/fwd.hpp"
@@ -15,6 +16,7 @@ class Intersection;
 class Mesh;
 class PrimRay;
 class RenderMode;
+class SketchPreview;
 class WingedFaceIntersection;
 class WingedMesh;
 
@@ -23,6 +25,11 @@ class Scene : public Configurable {
     DECLARE_BIG3 (Scene, const Config&)
 
     WingedMesh&        newWingedMesh      (const Config&, const Mesh&);
+
+    /** `newWingedMesh (c,i,m,v,f)` adds a mesh with index `i`, which must be free.
+     * The slots of `m` are kept (cf. `WingedMesh::fromMesh (m,v,f)`). */
+    WingedMesh&        newWingedMesh      ( const Config&, unsigned int, const Mesh&
+                                          , const std::vector <bool>&, const std::vector <bool>& );
     SketchMesh&        newSketchMesh      (const Config&, const SketchTree&);
     void               deleteMesh         (WingedMesh&);
     void               deleteMesh         (SketchMesh&);
@@ -59,6 +66,10 @@ class Scene : public Configurable {
     bool               toDlyFile          (bool);
     bool               toDlyFile          (const std::string&, bool);
     bool               fromDlyFile        (const Config&, const std::string&);
+    SketchPreview&     sketchPreview      ();
+
+    /** `updateSketchPreviews ()` reconverts the previews of all sketch meshes. */
+    void               updateSketchPreviews ();
 
     SAFE_REF1 (WingedMesh, wingedMesh, unsigned int)
     SAFE_REF1 (SketchMesh, sketchMesh, unsigned int)
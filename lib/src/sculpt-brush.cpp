@@ -2,13 +2,19 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <algorithm>
 #include <glm/gtx/norm.hpp>
+#include "adjacent-iterator.hpp"
 #include "affected-faces.hpp"
+#include "index-octree.hpp"
 #include "intersection.hpp"
+#include "partial-action/smooth.hpp"
 #include "primitive/plane.hpp"
 #include "primitive/sphere.hpp"
+#include "primitive/triangle.hpp"
 #include "sculpt-brush.hpp"
 #include "util.hpp"
+#include "winged/face.hpp"
 #include "winged/mesh.hpp"
 #include "winged/util.hpp"
 #include "winged/vertex.hpp"
@@ -46,12 +52,25 @@ struct SculptBrush :: Impl {
   float         detailFactor;
   float         stepWidthFactor;
   bool          subdivide;
+  unsigned int  faceBudget;
+  float         timeBudget;
+  unsigned int  domainRings;
   WingedMesh*   mesh;
   bool          hasPosition;
   glm::vec3    _lastPosition;
   glm::vec3    _position;
   glm::vec3    _direction;
 
+  std::vector <SBPendingEdge> pendingEdges;
+  std::vector <unsigned int>  lastDomain;
+  glm::vec3                   lastDomainCenter;
+  std::vector <unsigned int>  lastMirroredDomain;
+  glm::vec3                   lastMirroredDomainCenter;
+
+  // a face has been tested by the current call of `intersects` if its stamp is `stamp`
+  std::vector <unsigned int>  faceStamps;
+  unsigned int                stamp;
+
   Variant < SBCarveParameters
           , SBDraglikeParameters
           , SBSmoothParameters
@@ -66,10 +85,15 @@ struct SculptBrush :: Impl {
     , detailFactor    (0.0f)
     , stepWidthFactor (0.0f)
     , subdivide       (false)
+    , faceBudget      (0)
+    , timeBudget      (0.0f)
+    , domainRings     (2)
+    , mesh            (nullptr)
     , hasPosition     (false)
+    , stamp           (0)
   {}
 
-  void sculpt (AffectedFaces& faces) const {
+  void sculpt (AffectedFaces& faces) {
     assert (this->parameters.isSet ());
 
     this->parameters.caseOf <void>
@@ -83,11 +107,82 @@ struct SculptBrush :: Impl {
       );
   }
 
-  void sculpt (const SBCarveParameters& parameters, AffectedFaces& faces) const {
+  /** `intersects (s,fs)` inserts all unmasked faces of the brush's mesh that intersect `s`
+   * into `fs`.
+   * Consecutive dabs overlap, so faces are gathered by a flood fill across face adjacency,
+   * starting at the faces of the previous dab's domain that intersect `s`. Masked faces
+   * are walked through, but not inserted.
+   * Components of the mesh that are not connected to those faces inside of `s`, e.g.
+   * nearby folds, are gathered by querying the mesh's octree afterwards. Faces that have
+   * already been tested by the flood fill are skipped, such that each face is tested
+   * once and the result does not depend on the previous domain. */
+  void intersects (const PrimSphere& sphere, AffectedFaces& faces) {
+    WingedMesh&                mesh = this->self->meshRef ();
+    FacePtrVec                 stack;
+    std::vector <unsigned int> domain;
+
+    if (++this->stamp == 0) {
+      std::fill (this->faceStamps.begin (), this->faceStamps.end (), 0);
+      this->stamp = 1;
+    }
+    this->faceStamps.resize (mesh.numIndices () / 3, 0);
+
+    // degenerated faces are skipped, since they are not kept in the octree either
+    auto visit = [this, &mesh, &sphere, &faces, &domain] (WingedFace& face) -> bool {
+      if (this->faceStamps [face.index ()] == this->stamp) {
+        return false;
+      }
+      this->faceStamps [face.index ()] = this->stamp;
+
+      const PrimTriangle tri = face.triangle (mesh);
+
+      if (tri.isDegenerated () || IntersectionUtil::intersects (sphere, tri) == false) {
+        return false;
+      }
+      if (mesh.isMasked (face) == false) {
+        faces.insert (face);
+      }
+      domain.push_back (face.index ());
+      return true;
+    };
+
+    if ( this->lastDomain.empty () == false
+      && glm::distance (sphere.center (), this->lastDomainCenter) <= sphere.radius () )
+    {
+      for (unsigned int i : this->lastDomain) {
+        WingedFace* face = 3 * i < mesh.numIndices () ? mesh.face (i) : nullptr;
+
+        if (face && visit (*face)) {
+          stack.push_back (face);
+        }
+      }
+    }
+
+    while (stack.empty () == false) {
+      WingedFace* face = stack.back ();
+      stack.pop_back ();
+
+      for (WingedFace& a : face->adjacentFaces ()) {
+        if (visit (a)) {
+          stack.push_back (&a);
+        }
+      }
+    }
+
+    mesh.octree ().intersects (sphere, [&mesh, &visit] (unsigned int i) {
+      visit (mesh.faceRef (i));
+    });
+    faces.commit ();
+
+    this->lastDomain       = std::move (domain);
+    this->lastDomainCenter = sphere.center ();
+  }
+
+  void sculpt (const SBCarveParameters& parameters, AffectedFaces& faces) {
     PrimSphere  sphere (this->position (), this->radius);
     WingedMesh& mesh   (this->self->meshRef ());
 
-    mesh.intersects (sphere, faces);
+    this->intersects (sphere, faces);
     faces.discardBackfaces (mesh, this->direction ());
 
     if (faces.isEmpty () == false) {
@@ -113,11 +208,11 @@ struct SculptBrush :: Impl {
     }
   }
 
-  void sculpt (const SBDraglikeParameters& parameters, AffectedFaces& faces) const {
+  void sculpt (const SBDraglikeParameters& parameters, AffectedFaces& faces) {
     PrimSphere  sphere (this->lastPosition (), this->radius);
     WingedMesh& mesh   (this->self->meshRef ());
 
-    mesh.intersects (sphere, faces);
+    this->intersects (sphere, faces);
 
     if (parameters.discardBackfaces ()) {
       faces.discardBackfaces (mesh, this->direction ());
@@ -141,33 +236,28 @@ struct SculptBrush :: Impl {
     }
   }
 
-  void sculpt (const SBSmoothParameters& parameters, AffectedFaces& faces) const {
+  void sculpt (const SBSmoothParameters& parameters, AffectedFaces& faces) {
     PrimSphere  sphere (this->_position, this->radius);
     WingedMesh& mesh   (this->self->meshRef ());
 
-    mesh .intersects (sphere, faces);
+    this->intersects (sphere, faces);
     faces.discardBackfaces (mesh, this->direction ());
 
     if (faces.isEmpty () == false && parameters.relaxOnly () == false) {
-      VertexPtrSet vertices (faces.toVertexSet ());
-
-      for (WingedVertex* v : vertices) {
-        const glm::vec3 oldPos = v->position (mesh);
-        const float     factor = parameters.intensity ()
-                               * Util::smoothStep ( oldPos, this->position ()
-                                                  , 0.0f, this->radius );
-        const glm::vec3 newPos = oldPos + (factor * (WingedUtil::center (mesh, *v) - oldPos));
-
-        v->writePosition (mesh, newPos);
-      }
+      auto weight = [this, &parameters, &mesh] (const WingedVertex& v) -> float {
+        return parameters.intensity ()
+             * Util::smoothStep (v.position (mesh), this->position (), 0.0f, this->radius);
+      };
+      PartialAction::smooth (mesh, faces.toVertexSet (), 1, weight, faces);
+      faces.commit ();
     }
   }
 
-  void sculpt (const SBFlattenParameters& parameters, AffectedFaces& faces) const {
+  void sculpt (const SBFlattenParameters& parameters, AffectedFaces& faces) {
     PrimSphere  sphere (this->_position, this->radius);
     WingedMesh& mesh   (this->self->meshRef ());
 
-    mesh.intersects (sphere, faces);
+    this->intersects (sphere, faces);
     faces.discardBackfaces (mesh, this->direction ());
 
     if (faces.isEmpty () == false) {
@@ -188,11 +278,11 @@ struct SculptBrush :: Impl {
     }
   }
 
-  void sculpt (const SBCreaseParameters& parameters, AffectedFaces& faces) const {
+  void sculpt (const SBCreaseParameters& parameters, AffectedFaces& faces) {
     PrimSphere  sphere (this->position (), this->radius);
     WingedMesh& mesh   (this->self->meshRef ());
 
-    mesh.intersects (sphere, faces);
+    this->intersects (sphere, faces);
 
     faces.discardBackfaces (mesh, this->direction ());
 
@@ -220,11 +310,11 @@ struct SculptBrush :: Impl {
     }
   }
 
-  void sculpt (const SBPinchParameters& parameters, AffectedFaces& faces) const {
+  void sculpt (const SBPinchParameters& parameters, AffectedFaces& faces) {
     PrimSphere  sphere (this->position (), this->radius);
     WingedMesh& mesh   (this->self->meshRef ());
 
-    mesh.intersects (sphere, faces);
+    this->intersects (sphere, faces);
 
     faces.discardBackfaces (mesh, this->direction ());
 
@@ -271,8 +361,8 @@ struct SculptBrush :: Impl {
       );
   }
 
-  void sculpt (const SBReduceParameters&, AffectedFaces& faces) const {
-    this->self->meshRef ().intersects (PrimSphere (this->position (), this->radius), faces);
+  void sculpt (const SBReduceParameters&, AffectedFaces& faces) {
+    this->intersects (PrimSphere (this->position (), this->radius), faces);
   }
 
   float subdivThreshold () const {
@@ -300,6 +390,10 @@ struct SculptBrush :: Impl {
   }
 
   void setPointOfAction (const glm::vec3& p, const glm::vec3& d) {
+    this->pendingEdges      .clear ();
+    this->lastDomain        .clear ();
+    this->lastMirroredDomain.clear ();
+
     this->hasPosition   = true;
     this->_lastPosition = p;
     this->_position     = p;
@@ -328,6 +422,9 @@ struct SculptBrush :: Impl {
 
   void resetPointOfAction () {
     this->hasPosition = false;
+    this->pendingEdges      .clear ();
+    this->lastDomain        .clear ();
+    this->lastMirroredDomain.clear ();
   }
 
   bool reduce () const {
@@ -340,23 +437,31 @@ struct SculptBrush :: Impl {
       this->_position     = plane.mirror          (this->_position);
       this->_direction    = plane.mirrorDirection (this->_direction);
     }
+    // each side of a mirrored stroke reuses its own previous domain
+    std::swap (this->lastDomain      , this->lastMirroredDomain);
+    std::swap (this->lastDomainCenter, this->lastMirroredDomainCenter);
   }
 };
 
 DELEGATE_BIG6_SELF (SculptBrush)
   
-DELEGATE1_CONST (void             , SculptBrush, sculpt, AffectedFaces&)
+DELEGATE1       (void             , SculptBrush, sculpt, AffectedFaces&)
 GETTER_CONST    (float            , SculptBrush, radius)
 GETTER_CONST    (float            , SculptBrush, detailFactor)
 GETTER_CONST    (float            , SculptBrush, stepWidthFactor)
 GETTER_CONST    (bool             , SculptBrush, subdivide)
+GETTER_CONST    (unsigned int     , SculptBrush, faceBudget)
+GETTER_CONST    (float            , SculptBrush, timeBudget)
+GETTER_CONST    (unsigned int     , SculptBrush, domainRings)
 GETTER_CONST    (WingedMesh*      , SculptBrush, mesh)
 DELEGATE_CONST  (float            , SculptBrush, intensity)
 SETTER          (float            , SculptBrush, radius)
 SETTER          (float            , SculptBrush, detailFactor)
 SETTER          (float            , SculptBrush, stepWidthFactor)
 SETTER          (bool             , SculptBrush, subdivide)
-SETTER          (WingedMesh*      , SculptBrush, mesh)
+SETTER          (unsigned int     , SculptBrush, faceBudget)
+SETTER          (float            , SculptBrush, timeBudget)
+SETTER          (unsigned int     , SculptBrush, domainRings)
 DELEGATE1       (void             , SculptBrush, intensity, float)
 DELEGATE_CONST  (float            , SculptBrush, subdivThreshold)
 GETTER_CONST    (bool             , SculptBrush, hasPosition)
@@ -369,6 +474,16 @@ DELEGATE2       (bool             , SculptBrush, updatePointOfAction, const glm:
 DELEGATE        (void             , SculptBrush, resetPointOfAction)
 DELEGATE_CONST  (bool             , SculptBrush, reduce)
 DELEGATE1       (void             , SculptBrush, mirror, const PrimPlane&)
+GETTER          (std::vector <SBPendingEdge>&, SculptBrush, pendingEdges)
+
+void SculptBrush :: mesh (WingedMesh* m) {
+  if (this->impl->mesh != m) {
+    this->impl->pendingEdges      .clear ();
+    this->impl->lastDomain        .clear ();
+    this->impl->lastMirroredDomain.clear ();
+  }
+  this->impl->mesh = m;
+}
 
 template <typename T> 
 const T& SculptBrush::constParameters () const {
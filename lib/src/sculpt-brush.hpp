@@ -6,6 +6,7 @@
 #define DILAY_SCULPT_BRUSH
 
 #include <glm/glm.hpp>
+#include <vector>
 #include "macro.hpp"
 
 class AffectedFaces;
@@ -84,16 +85,27 @@ class SBCreaseParameters : public SBIntensityParameters, public SBInvertParamete
 class SBPinchParameters : public SBInvertParameters {};
 class SBReduceParameters : public SBIntensityParameters {};
 
+/** A pending edge is identified by its index and the indices of its vertices, such that a
+ * slot that has been reused by another edge is not mistaken for it. */
+struct SBPendingEdge {
+  unsigned int edge;
+  unsigned int vertex1;
+  unsigned int vertex2;
+};
+
 class SculptBrush {
   public:
     DECLARE_BIG6 (SculptBrush)
 
-    void             sculpt              (AffectedFaces&) const;
+    void             sculpt              (AffectedFaces&);
 
     float            radius              () const;
     float            detailFactor        () const;
     float            stepWidthFactor     () const;
     bool             subdivide           () const;
+    unsigned int     faceBudget          () const;
+    float            timeBudget          () const;
+    unsigned int     domainRings         () const;
     WingedMesh*      mesh                () const;
     float            intensity           () const;
 
@@ -101,6 +113,9 @@ class SculptBrush {
     void             detailFactor        (float);
     void             stepWidthFactor     (float);
     void             subdivide           (bool);
+    void             faceBudget          (unsigned int);
+    void             timeBudget          (float);
+    void             domainRings         (unsigned int);
     void             mesh                (WingedMesh*);
     void             intensity           (float);
 
@@ -116,6 +131,11 @@ class SculptBrush {
     bool             reduce              () const;
     void             mirror              (const PrimPlane&);
 
+    /** `pendingEdges ()` are indices of edges that exceeded the topology budget of
+     * a previous step and still need to be subdivided.
+     * They are dropped if the point of action is (re)set or if the mesh changes. */
+    std::vector <SBPendingEdge>& pendingEdges ();
+
     template <typename T> const T& constParameters () const;
     template <typename T>       T& parameters      ();
 
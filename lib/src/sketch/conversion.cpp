@@ -2,13 +2,21 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <algorithm>
+#include <array>
+#include <functional>
 #include <glm/glm.hpp>
 #include <glm/gtx/norm.hpp>
-#include <thread>
+#include <iterator>
+#include <limits>
+#include <unordered_map>
 #include <vector>
 #include "../mesh.hpp"
 #include "distance.hpp"
+#include "hash.hpp"
 #include "mesh-util.hpp"
+#include "parallel-util.hpp"
+#include "primitive/aabox.hpp"
 #include "primitive/cone-sphere.hpp"
 #include "sketch/conversion.hpp"
 #include "sketch/mesh.hpp"
@@ -323,16 +331,21 @@ namespace {
     }
   }
 
+  /* A cube of a collapsed cell of `cellSize`^3 cubes (cf. `simplifyBrick`) has no vertices.
+   * The cell is represented by its first cube, which holds the cell's configuration and
+   * vertex. */
   struct Cube {
     unsigned int               configuration;
     glm::vec3                  vertex;
     std::vector <unsigned int> vertexInstanceIndices;
     bool                       collapseWhenAmbiguous;
+    unsigned int               cellSize;
 
     Cube ()
       : configuration         (Util::invalidIndex ())  
       , vertex                (invalidVec3)
       , collapseWhenAmbiguous (false)
+      , cellSize              (1)
     {}
 
     void initializeVertexInstanceIndices () {
@@ -348,6 +361,12 @@ namespace {
     unsigned int vertexInstanceIndex (unsigned int edge) const {
       assert (edge <= 11);
       assert (this->configuration <= 255);
+
+      // collapsed cells are simple, i.e. they have a single vertex
+      if (this->cellSize > 1) {
+        assert (this->vertexInstanceIndices.size () == 1);
+        return this->vertexInstanceIndices.at (0);
+      }
       assert (edgeVertexIndices[this->configuration][edge] >= 0);
       assert (this->collapseWhenAmbiguous == false || this->isAmbiguous ());
 
@@ -420,18 +439,89 @@ namespace {
     }
   };
 
-  struct Parameters {
-    float               resolution;
-    glm::vec3           sampleOrigin;
-    glm::uvec3          numSamples;
+  static const unsigned int brickSize = 8;
+
+  // a brick of `brickSize`^3 cubes and the `brickSize+1`^3 samples at their corners, i.e.
+  // samples on a brick's upper boundary are shared with the neighbouring brick
+  struct Brick {
+    const glm::uvec3    origin;
     std::vector <float> samples;
-    glm::uvec3          numCubes;
-    std::vector <Cube>  grid;
+    std::vector <Cube>  cubes;
+
+    Brick (const glm::uvec3& o)
+      : origin  (o)
+      , samples ((brickSize + 1) * (brickSize + 1) * (brickSize + 1), 0.0f)
+      , cubes   (brickSize * brickSize * brickSize)
+    {}
+
+    // moves brick `b` of a previous conversion to `o`
+    Brick (Brick&& b, const glm::uvec3& o)
+      : origin  (o)
+      , samples (std::move (b.samples))
+      , cubes   (std::move (b.cubes))
+    {}
+
+    float& sample (unsigned int x, unsigned int y, unsigned int z) {
+      assert (x >= this->origin.x && x <= this->origin.x + brickSize);
+      assert (y >= this->origin.y && y <= this->origin.y + brickSize);
+      assert (z >= this->origin.z && z <= this->origin.z + brickSize);
+
+      const unsigned int n = brickSize + 1;
+      return this->samples.at ( ((z - this->origin.z) * n * n)
+                              + ((y - this->origin.y) * n)
+                              +  (x - this->origin.x) );
+    }
+
+    Cube& cube (unsigned int x, unsigned int y, unsigned int z) {
+      assert (x >= this->origin.x && x < this->origin.x + brickSize);
+      assert (y >= this->origin.y && y < this->origin.y + brickSize);
+      assert (z >= this->origin.z && z < this->origin.z + brickSize);
+
+      const unsigned int n = brickSize;
+      return this->cubes.at ( ((z - this->origin.z) * n * n)
+                            + ((y - this->origin.y) * n)
+                            +  (x - this->origin.x) );
+    }
+  };
+
+  // hashes the world coordinates of a brick (cf. `Parameters::worldBrick`)
+  struct WorldBrickHash {
+    std::size_t operator () (const glm::ivec3& brick) const {
+      std::size_t seed = 0;
+      Hash::combine (seed, brick.x);
+      Hash::combine (seed, brick.y);
+      Hash::combine (seed, brick.z);
+      return seed;
+    }
+  };
+
+  template <typename T>
+  using WorldBrickMap = std::unordered_map <glm::ivec3, T, WorldBrickHash>;
+
+  /* Only bricks that may be crossed by the surface are stored, such that memory scales
+   * with the surface's area rather than the sketch's volume.
+   * Cubes of other bricks are either inside or outside of the surface: they neither have
+   * vertices nor adjacent faces.
+   * The grid is aligned to bricks of the world: the sample `(x,y,z)` of the grid is the
+   * sample `(x,y,z) + brickSize * brickOffset` of the world, and its position is computed from
+   * the latter. Hence, a sample has the same position in all grids of the same resolution. */
+  struct Parameters {
+    float                                    resolution;
+    bool                                     adaptive;
+    glm::ivec3                               brickOffset;
+    glm::uvec3                               numSamples;
+    glm::uvec3                               numCubes;
+    glm::uvec3                               numBricks;
+    std::unordered_map <unsigned int, Brick> bricks;
+    std::vector <unsigned int>               brickIndices;
 
     Parameters ()
       : resolution   (0.0f)
-      , sampleOrigin (glm::vec3 (0.0f))
+      , adaptive     (false)
+      , brickOffset  (glm::ivec3 (0))
       , numSamples   (glm::uvec3 (0))
+      , numCubes     (glm::uvec3 (0))
+      , numBricks    (glm::uvec3 (0))
     {}
 
     glm::vec3 samplePos (unsigned int x, unsigned int y, unsigned int z) const {
@@ -439,150 +529,775 @@ namespace {
       assert (y < (unsigned int) this->numSamples.y);
       assert (z < (unsigned int) this->numSamples.z);
 
-      return sampleOrigin + ( glm::vec3 (this->resolution) 
-                            * glm::vec3 (float (x), float (y), float (z)) );
+      const glm::ivec3 world = (this->brickOffset * int (brickSize))
+                             + glm::ivec3 (int (x), int (y), int (z));
+
+      return glm::vec3 (this->resolution) * glm::vec3 (world);
     }
 
-    glm::vec3 samplePos (unsigned int i) const {
-      const std::div_t divZ = std::div (int (i), int (this->numSamples.x * this->numSamples.y));
-      const std::div_t divY = std::div (divZ.rem, int (this->numSamples.x));
+    glm::vec3 samplePos (const glm::uvec3& p) const {
+      return this->samplePos (p.x, p.y, p.z);
+    }
 
-      return this->samplePos ( (unsigned int) (divY.rem)
-                             , (unsigned int) (divY.quot)
-                             , (unsigned int) (divZ.quot) );
+    unsigned int brickIndex (unsigned int x, unsigned int y, unsigned int z) const {
+      return (z * this->numBricks.x * this->numBricks.y) + (y * this->numBricks.x) + x;
     }
 
-    unsigned int sampleIndex (unsigned int x, unsigned int y, unsigned int z) const {
-      return (z * this->numSamples.x * this->numSamples.y) + (y * this->numSamples.x) + x;
+    glm::uvec3 brickOrigin (unsigned int index) const {
+      const std::div_t divZ = std::div (int (index), int (this->numBricks.x * this->numBricks.y));
+      const std::div_t divY = std::div (divZ.rem, int (this->numBricks.x));
+
+      return glm::uvec3 (divY.rem, divY.quot, divZ.quot) * glm::uvec3 (brickSize);
     }
 
-    unsigned int sampleIndex (unsigned int cubeIndex, unsigned int vertex) const {
-      assert (vertex < 8);
+    glm::ivec3 worldBrick (unsigned int index) const {
+      return this->brickOffset + glm::ivec3 (this->brickOrigin (index) / glm::uvec3 (brickSize));
+    }
 
-      const std::div_t   divZ = std::div ( int (cubeIndex)
-                                         , int (this->numCubes.x * this->numCubes.y));
-      const std::div_t   divY = std::div (divZ.rem, int (this->numCubes.x));
-      const unsigned int x    = (unsigned int) (divY.rem);
-      const unsigned int y    = (unsigned int) (divY.quot);
-      const unsigned int z    = (unsigned int) (divZ.quot);
+    // exclusive upper bound of the cubes of the brick at `origin`
+    glm::uvec3 brickEnd (const glm::uvec3& origin) const {
+      return glm::min (origin + glm::uvec3 (brickSize), this->numCubes);
+    }
 
-      switch (vertex) {
-        case 0 : return this->sampleIndex (x  , y  , z  );
-        case 1 : return this->sampleIndex (x+1, y  , z  );
-        case 2 : return this->sampleIndex (x  , y+1, z  );
-        case 3 : return this->sampleIndex (x+1, y+1, z  );
-        case 4 : return this->sampleIndex (x  , y  , z+1);
-        case 5 : return this->sampleIndex (x+1, y  , z+1);
-        case 6 : return this->sampleIndex (x  , y+1, z+1);
-        case 7 : return this->sampleIndex (x+1, y+1, z+1);
-        default: DILAY_IMPOSSIBLE
+    Brick* brick (unsigned int x, unsigned int y, unsigned int z) {
+      auto it = this->bricks.find (this->brickIndex (x / brickSize, y / brickSize, z / brickSize));
+      return it == this->bricks.end () ? nullptr : &it->second;
+    }
+
+    Cube* cube (unsigned int x, unsigned int y, unsigned int z) {
+      Brick* b = this->brick (x, y, z);
+      return b ? &b->cube (x, y, z) : nullptr;
+    }
+
+    // the first cube of the cell of cube `(x,y,z)`: cells are aligned to their size
+    Cube* cell (unsigned int x, unsigned int y, unsigned int z) {
+      Brick* b = this->brick (x, y, z);
+
+      if (b) {
+        const unsigned int size = b->cube (x, y, z).cellSize;
+        return &b->cube (x - (x % size), y - (y % size), z - (z % size));
+      }
+      else {
+        return nullptr;
       }
     }
 
-    unsigned int cubeIndex (unsigned int x, unsigned int y, unsigned int z) const {
-      return (z * this->numCubes.x * this->numCubes.y) + (y * this->numCubes.x) + x;
+    void forEachCube ( Brick& brick, const std::function <void ( Brick&, unsigned int
+                                                               , unsigned int, unsigned int )>& f )
+    {
+      const glm::uvec3 end = this->brickEnd (brick.origin);
+
+      for (unsigned int z = brick.origin.z; z < end.z; z++) {
+        for (unsigned int y = brick.origin.y; y < end.y; y++) {
+          for (unsigned int x = brick.origin.x; x < end.x; x++) {
+            f (brick, x, y, z);
+          }
+        }
+      }
+    }
+
+    void forEachCube (const std::function <void ( Brick&, unsigned int, unsigned int
+                                                , unsigned int )>& f)
+    {
+      for (unsigned int i : this->brickIndices) {
+        this->forEachCube (this->bricks.at (i), f);
+      }
+    }
+
+    // bricks are processed in parallel: `f` must only write to its brick
+    void forEachCubeParallel ( const std::vector <unsigned int>& indices
+                             , const std::function <void ( Brick&, unsigned int, unsigned int
+                                                         , unsigned int )>& f )
+    {
+      ParallelUtil::forEach (indices.size (), [this, &indices, &f] (unsigned int i) {
+        this->forEachCube (this->bricks.at (indices [i]), f);
+      }, 1);
     }
   };
 
-  void setupSampling (const SketchMesh& mesh, Parameters& params) {
-    glm::vec3 min, max;
-    mesh.minMax (min, max);
+  PrimAABox boundingBox (const PrimSphere& sphere) {
+    return PrimAABox ( sphere.center () - glm::vec3 (sphere.radius ())
+                     , sphere.center () + glm::vec3 (sphere.radius ()) );
+  }
 
-    min = min - glm::vec3 (Util::epsilon ());
-    max = max + glm::vec3 (Util::epsilon ());
+  PrimAABox boundingBox (const PrimConeSphere& coneSphere) {
+    const PrimAABox box1 = boundingBox (coneSphere.sphere1 ());
+    const PrimAABox box2 = boundingBox (coneSphere.sphere2 ());
 
-    params.sampleOrigin = min;
-    params.numSamples   = glm::vec3 (1.0f) + glm::ceil ((max - min) / glm::vec3 (params.resolution));
+    return PrimAABox ( glm::min (box1.minimum (), box2.minimum ())
+                     , glm::max (box1.maximum (), box2.maximum ()) );
   }
 
-  float sampleAt (const SketchMesh& mesh, const glm::vec3& pos) {
-    float distance = std::numeric_limits <float>::max ();
-      
-    if (mesh.tree ().hasRoot ()) {
-      mesh.tree ().root ().forEachConstNode ([&pos, &distance] (const SketchNode& node) {
-        const float d = node.parent ()
-                      ? Distance::distance ( PrimConeSphere ( node.data ()
-                                                            , node.parent ()->data () )
-                                           , pos )
-                      : Distance::distance (node.data (), pos);
+  float distance (const PrimAABox& box1, const PrimAABox& box2) {
+    const glm::vec3 delta = glm::max ( glm::vec3 (0.0f)
+                                     , glm::max ( box1.minimum () - box2.maximum ()
+                                                , box2.minimum () - box1.maximum () ) );
+    return glm::length (delta);
+  }
 
-        distance = glm::min (distance, d);
-      });
+  /* `PrimitiveGrid` is a uniform grid over the bounding boxes of primitives, whose cells
+   * list all primitives with overlapping boxes.
+   * Primitive `i` is the `i`-th box of `boxes1` if `i < boxes1.size ()`, and the
+   * `(i - boxes1.size ())`-th box of `boxes2` otherwise.
+   * Cells are at least as wide as the average box, and there are at most about four cells
+   * per primitive. */
+  struct PrimitiveGrid {
+    glm::vec3                  minimum;
+    float                      cellWidth;
+    glm::ivec3                 numCells;
+    std::vector <glm::ivec3>   firstCells;
+    std::vector <glm::ivec3>   lastCells;
+    std::vector <unsigned int> cellOffsets;
+    std::vector <unsigned int> cellPrimitives;
+
+    PrimitiveGrid ()
+      : minimum   (0.0f)
+      , cellWidth (1.0f)
+      , numCells  (0)
+    {}
+
+    PrimitiveGrid (const std::vector <PrimAABox>& boxes1, const std::vector <PrimAABox>& boxes2) {
+      const unsigned int numPrimitives = boxes1.size () + boxes2.size ();
+
+      auto box = [&boxes1, &boxes2] (unsigned int i) -> const PrimAABox& {
+        return i < boxes1.size () ? boxes1 [i] : boxes2 [i - boxes1.size ()];
+      };
+
+      assert (numPrimitives > 0);
+
+      glm::vec3 min (std::numeric_limits <float>::max ());
+      glm::vec3 max (std::numeric_limits <float>::lowest ());
+      float     meanWidth = 0.0f;
+
+      for (unsigned int i = 0; i < numPrimitives; i++) {
+        const glm::vec3 width = box (i).maximum () - box (i).minimum ();
+
+        min        = glm::min (min, box (i).minimum ());
+        max        = glm::max (max, box (i).maximum ());
+        meanWidth += glm::max (width.x, glm::max (width.y, width.z)) / float (numPrimitives);
+      }
+
+      const glm::vec3 extent = max - min;
+      const float     volume = extent.x * extent.y * extent.z;
+
+      this->minimum   = min;
+      this->cellWidth = glm::max ( glm::max (meanWidth, Util::epsilon ())
+                                 , glm::pow (volume / float (4 * numPrimitives), 1.0f / 3.0f) );
+      this->numCells  = glm::max ( glm::ivec3 (1)
+                                 , glm::ivec3 (glm::ceil (extent / this->cellWidth)) );
+
+      const unsigned int numAllCells = this->numCells.x * this->numCells.y * this->numCells.z;
+
+      this->firstCells .resize (numPrimitives);
+      this->lastCells  .resize (numPrimitives);
+      this->cellOffsets.assign (numAllCells + 1, 0);
+
+      for (unsigned int i = 0; i < numPrimitives; i++) {
+        this->firstCells [i] = this->cell (box (i).minimum ());
+        this->lastCells  [i] = this->cell (box (i).maximum ());
+
+        this->forEachCell (this->firstCells [i], this->lastCells [i], [this] (unsigned int c) {
+          this->cellOffsets [c + 1]++;
+        });
+      }
+      for (unsigned int c = 0; c < numAllCells; c++) {
+        this->cellOffsets [c + 1] += this->cellOffsets [c];
+      }
+
+      std::vector <unsigned int> cellSizes (numAllCells, 0);
+      this->cellPrimitives.resize (this->cellOffsets.back ());
+
+      for (unsigned int i = 0; i < numPrimitives; i++) {
+        this->forEachCell ( this->firstCells [i], this->lastCells [i]
+                          , [this, i, &cellSizes] (unsigned int c)
+        {
+          this->cellPrimitives [this->cellOffsets [c] + cellSizes [c]] = i;
+          cellSizes [c]++;
+        });
+      }
+    }
+
+    // the cell of `pos`, which is clamped to the grid
+    glm::ivec3 cell (const glm::vec3& pos) const {
+      const glm::ivec3 c = glm::ivec3 (glm::floor ((pos - this->minimum) / this->cellWidth));
+
+      return glm::clamp (c, glm::ivec3 (0), this->numCells - glm::ivec3 (1));
+    }
+
+    unsigned int cellIndex (const glm::ivec3& c) const {
+      return (c.z * this->numCells.x * this->numCells.y) + (c.y * this->numCells.x) + c.x;
+    }
+
+    template <typename F>
+    void forEachCell (const glm::ivec3& first, const glm::ivec3& last, const F& f) const {
+      for (int z = first.z; z <= last.z; z++) {
+        for (int y = first.y; y <= last.y; y++) {
+          for (int x = first.x; x <= last.x; x++) {
+            f (this->cellIndex (glm::ivec3 (x, y, z)));
+          }
+        }
+      }
+    }
+
+    /* `forEachPrimitive (first,last,f)` calls `f (i)` once for each primitive `i` that
+     * overlaps the cells `[first,last]`, at the first of its cells in `[first,last]`. */
+    template <typename F>
+    void forEachPrimitive (const glm::ivec3& first, const glm::ivec3& last, const F& f) const {
+      this->forEachPrimitive ( first, last, glm::ivec3 (std::numeric_limits <int>::max ())
+                             , glm::ivec3 (std::numeric_limits <int>::lowest ()), f );
+    }
+
+    /* `forEachPrimitive (first,last,skipFirst,skipLast,f)` is like
+     * `forEachPrimitive (first,last,f)` but skips all primitives that overlap the cells
+     * `[skipFirst,skipLast]`, which must be inside `[first,last]`. */
+    template <typename F>
+    void forEachPrimitive ( const glm::ivec3& first, const glm::ivec3& last
+                          , const glm::ivec3& skipFirst, const glm::ivec3& skipLast
+                          , const F& f ) const
+    {
+      auto overlaps = [] ( const glm::ivec3& first1, const glm::ivec3& last1
+                         , const glm::ivec3& first2, const glm::ivec3& last2 )
+      {
+        return glm::all (glm::lessThanEqual (first1, last2))
+            && glm::all (glm::lessThanEqual (first2, last1));
+      };
+
+      for (int z = first.z; z <= last.z; z++) {
+        for (int y = first.y; y <= last.y; y++) {
+          const bool isSkippedRow = z >= skipFirst.z && z <= skipLast.z
+                                 && y >= skipFirst.y && y <= skipLast.y;
+
+          for (int x = first.x; x <= last.x; x++) {
+            if (isSkippedRow && x == skipFirst.x) {
+              x = skipLast.x;
+              continue;
+            }
+            const glm::ivec3   c (x, y, z);
+            const unsigned int index = this->cellIndex (c);
+
+            for (unsigned int j = this->cellOffsets [index]; j < this->cellOffsets [index+1]; j++) {
+              const unsigned int i     = this->cellPrimitives [j];
+              const bool         isNew = overlaps ( this->firstCells [i], this->lastCells [i]
+                                                  , skipFirst, skipLast ) == false;
+
+              if (isNew && glm::max (this->firstCells [i], first) == c) {
+                f (i);
+              }
+            }
+          }
+        }
+      }
+    }
+
+    /* `distanceToOutside (first,last,pos)` bounds the distance between `pos` and any
+     * primitive that does not overlap the cells `[first,last]` from below (up to rounding). */
+    float distanceToOutside ( const glm::ivec3& first, const glm::ivec3& last
+                            , const glm::vec3& pos ) const
+    {
+      float d = std::numeric_limits <float>::max ();
+
+      for (unsigned int a = 0; a < 3; a++) {
+        if (first [a] > 0) {
+          const float border = this->minimum [a] + (float (first [a]) * this->cellWidth);
+          d = glm::min (d, glm::max (0.0f, pos [a] - border));
+        }
+        if (last [a] < this->numCells [a] - 1) {
+          const float border = this->minimum [a] + (float (last [a] + 1) * this->cellWidth);
+          d = glm::min (d, glm::max (0.0f, border - pos [a]));
+        }
+      }
+      return d;
+    }
+  };
+
+  struct Primitives {
+    std::vector <PrimConeSphere> coneSpheres;
+    std::vector <PrimAABox>      coneSphereBoxes;
+    std::vector <PrimSphere>     spheres;
+    std::vector <PrimAABox>      sphereBoxes;
+    float                        blending;
+    PrimitiveGrid                grid;
+
+    Primitives (const SketchTree& tree, const SketchPaths& paths, float b)
+      : blending (b)
+    {
+      assert (b >= 0.0f);
+
+      if (tree.hasRoot ()) {
+        tree.root ().forEachConstNode ([this] (const SketchNode& node) {
+          if (node.parent ()) {
+            this->addConeSphere (PrimConeSphere (node.data (), node.parent ()->data ()));
+          }
+          else {
+            this->addSphere (node.data ());
+          }
+        });
+      }
+      for (const SketchPath& p : paths) {
+        for (const PrimSphere& s : p.spheres ()) {
+          this->addSphere (s);
+        }
+      }
+      if (this->coneSpheres.empty () == false || this->spheres.empty () == false) {
+        this->grid = PrimitiveGrid (this->coneSphereBoxes, this->sphereBoxes);
+      }
+    }
+
+    void addConeSphere (const PrimConeSphere& coneSphere) {
+      this->coneSpheres    .push_back (coneSphere);
+      this->coneSphereBoxes.push_back (boundingBox (coneSphere));
+    }
+
+    void addSphere (const PrimSphere& sphere) {
+      this->spheres    .push_back (sphere);
+      this->sphereBoxes.push_back (boundingBox (sphere));
+    }
+
+    // primitives are indexed as by `grid`
+    const PrimAABox& box (unsigned int i) const {
+      return i < this->coneSpheres.size () ? this->coneSphereBoxes [i]
+                                           : this->sphereBoxes [i - this->coneSpheres.size ()];
+    }
+
+    float distance (unsigned int i, const glm::vec3& pos) const {
+      return i < this->coneSpheres.size ()
+           ? Distance::distance (this->coneSpheres [i], pos)
+           : Distance::distance (this->spheres [i - this->coneSpheres.size ()], pos);
+    }
+  };
+
+  // identifies a primitive by its type and spheres: the sphere of a sphere is repeated
+  using PrimitiveKey = std::array <float, 9>;
+
+  PrimitiveKey primitiveKey (bool isConeSphere, const PrimSphere& s1, const PrimSphere& s2) {
+    return {{ isConeSphere ? 1.0f : 0.0f
+            , s1.center ().x, s1.center ().y, s1.center ().z, s1.radius ()
+            , s2.center ().x, s2.center ().y, s2.center ().z, s2.radius () }};
+  }
+
+  PrimAABox boundingBox (const PrimitiveKey& key) {
+    const PrimAABox box1 = boundingBox (PrimSphere (glm::vec3 (key[1], key[2], key[3]), key[4]));
+    const PrimAABox box2 = boundingBox (PrimSphere (glm::vec3 (key[5], key[6], key[7]), key[8]));
+
+    return PrimAABox ( glm::min (box1.minimum (), box2.minimum ())
+                     , glm::max (box1.maximum (), box2.maximum ()) );
+  }
+
+  std::vector <PrimitiveKey> primitiveKeys (const Primitives& primitives) {
+    std::vector <PrimitiveKey> keys;
+    keys.reserve (primitives.coneSpheres.size () + primitives.spheres.size ());
+
+    for (const PrimConeSphere& c : primitives.coneSpheres) {
+      keys.push_back (primitiveKey (true, c.sphere1 (), c.sphere2 ()));
     }
-    for (const SketchPath& p : mesh.paths ()) {
-      for (const PrimSphere& s : p.spheres ()) {
-        distance = glm::min (distance, Distance::distance (s, pos));
+    for (const PrimSphere& s : primitives.spheres) {
+      keys.push_back (primitiveKey (false, s, s));
+    }
+    std::sort (keys.begin (), keys.end ());
+    return keys;
+  }
+
+  // bounding boxes of all primitives that are in either of the sorted `keys1` and `keys2`
+  std::vector <PrimAABox> changedBoxes ( const std::vector <PrimitiveKey>& keys1
+                                       , const std::vector <PrimitiveKey>& keys2 )
+  {
+    std::vector <PrimitiveKey> changed;
+    std::set_symmetric_difference ( keys1.begin (), keys1.end ()
+                                  , keys2.begin (), keys2.end ()
+                                  , std::back_inserter (changed) );
+
+    std::vector <PrimAABox> boxes;
+    boxes.reserve (changed.size ());
+
+    for (const PrimitiveKey& key : changed) {
+      boxes.push_back (boundingBox (key));
+    }
+    return boxes;
+  }
+
+  void setupSampling (const Primitives& primitives, Parameters& params) {
+    glm::vec3 min (std::numeric_limits <float>::max ());
+    glm::vec3 max (std::numeric_limits <float>::lowest ());
+
+    for (const PrimAABox& box : primitives.coneSphereBoxes) {
+      min = glm::min (min, box.minimum ());
+      max = glm::max (max, box.maximum ());
+    }
+    for (const PrimAABox& box : primitives.sphereBoxes) {
+      min = glm::min (min, box.minimum ());
+      max = glm::max (max, box.maximum ());
+    }
+
+    // blending extends the surface beyond the primitives by at most a quarter of its radius
+    min = min - glm::vec3 ((0.25f * primitives.blending) + Util::epsilon ());
+    max = max + glm::vec3 ((0.25f * primitives.blending) + Util::epsilon ());
+
+    // the grid consists of all bricks of the world that overlap `[min,max]`
+    const glm::vec3  brickWidth = glm::vec3 (float (brickSize) * params.resolution);
+    const glm::ivec3 first      = glm::ivec3 (glm::floor (min / brickWidth));
+    const glm::ivec3 last       = glm::ivec3 (glm::floor (max / brickWidth));
+
+    params.brickOffset = first;
+    params.numBricks   = glm::uvec3 (last - first + glm::ivec3 (1));
+    params.numCubes    = params.numBricks * glm::uvec3 (brickSize);
+    params.numSamples  = params.numCubes + glm::uvec3 (1);
+  }
+
+  // updates the smallest distance `d1` and the second smallest distance `d2` with `d`
+  void updateMinDistances (float d, float& d1, float& d2) {
+    d2 = glm::min (d2, glm::max (d1, d));
+    d1 = glm::min (d1, d);
+  }
+
+  /* `smoothMin (d1,d2,k)` blends the smallest distance `d1` and the second smallest
+   * distance `d2` of a sample if they differ by less than the blending radius `k`.
+   * The result does not depend on the order of primitives and lies between `d1 - k/4` and
+   * `d1`. */
+  float smoothMin (float d1, float d2, float k) {
+    if (k > 0.0f) {
+      const float h = glm::max (k - (d2 - d1), 0.0f) / k;
+      return d1 - (0.25f * k * h * h);
+    }
+    else {
+      return d1;
+    }
+  }
+
+  /* Cells of `primitives.grid` are searched in growing shells around `pos` until no
+   * primitive of the remaining cells can be closer than the second smallest distance `d2`,
+   * or than `d1` plus the blending radius, which bounds the distances that are blended
+   * (cf. `smoothMin`). The sample is the same as if all primitives had been evaluated. */
+  float sampleAt (const Primitives& primitives, const glm::vec3& pos) {
+    const PrimitiveGrid& grid   = primitives.grid;
+    const glm::ivec3     center = grid.cell (pos);
+    const glm::ivec3     last   = grid.numCells - glm::ivec3 (1);
+    glm::ivec3           skipFirst (std::numeric_limits <int>::max ());
+    glm::ivec3           skipLast  (std::numeric_limits <int>::lowest ());
+    float                d1 = std::numeric_limits <float>::max ();
+    float                d2 = std::numeric_limits <float>::max ();
+
+    for (int r = 0; ; r++) {
+      const glm::ivec3 first = glm::max (center - glm::ivec3 (r), glm::ivec3 (0));
+      const glm::ivec3 shell = glm::min (center + glm::ivec3 (r), last);
+
+      grid.forEachPrimitive (first, shell, skipFirst, skipLast, [&] (unsigned int i) {
+        updateMinDistances (primitives.distance (i, pos), d1, d2);
+      });
+
+      if (first == glm::ivec3 (0) && shell == last) {
+        break;
       }
+      const float blended = glm::min (d2, d1 + primitives.blending);
+
+      if (blended < grid.distanceToOutside (first, shell, pos) - Util::epsilon ()) {
+        break;
+      }
+      skipFirst = first;
+      skipLast  = shell;
     }
-    return distance;
+    return smoothMin (d1, d2, primitives.blending);
+  }
+
+  /* Primitives whose distance exceeds the smallest distance by the blending radius do not
+   * contribute to a sample. The smallest distance exceeds the sample by at most a quarter of
+   * the blending radius. */
+  float blendingMargin (float blending) {
+    return 1.25f * blending;
+  }
+
+  // indices of all primitives that may be closest to some sample of a brick
+  struct Candidates {
+    std::vector <unsigned int> coneSpheres;
+    std::vector <unsigned int> spheres;
+  };
+
+  // `sampleAt (p,c,pos)` equals `sampleAt (p,pos)` for positions of the brick of candidates `c`
+  float sampleAt (const Primitives& primitives, const Candidates& candidates, const glm::vec3& pos) {
+    float d1 = std::numeric_limits <float>::max ();
+    float d2 = std::numeric_limits <float>::max ();
+
+    for (unsigned int i : candidates.coneSpheres) {
+      updateMinDistances (Distance::distance (primitives.coneSpheres [i], pos), d1, d2);
+    }
+    for (unsigned int i : candidates.spheres) {
+      updateMinDistances (Distance::distance (primitives.spheres [i], pos), d1, d2);
+    }
+    return smoothMin (d1, d2, primitives.blending);
+  }
+
+  /* Samples are distances, i.e. the distance to the closest primitive is bounded from above
+   * by its distance to the brick's center plus half of the brick's diagonal.
+   * The distance between the bounding boxes of a primitive and the brick bounds its
+   * distance from below, as long as the boxes do not overlap.
+   * Primitives whose lower bound exceeds the upper bound can not be closest to any sample of
+   * the brick, which thus remains unaffected by culling them.
+   * The upper bound is extended by the blending margin (cf. `blendingMargin`). */
+  void cull (const Primitives& primitives, const PrimAABox& brick, Candidates& candidates) {
+    const float halfDiagonal = 0.5f * glm::distance (brick.minimum (), brick.maximum ());
+    const float upperBound   = sampleAt (primitives, brick.center ()) + halfDiagonal
+                             + blendingMargin (primitives.blending);
+
+    auto isCandidate = [&brick, upperBound] (const PrimAABox& box) -> bool {
+      const float lowerBound = distance (brick, box);
+
+      return lowerBound <= 0.0f || lowerBound <= upperBound + Util::epsilon ();
+    };
+
+    candidates.coneSpheres.clear ();
+    candidates.spheres    .clear ();
+
+    // candidates overlap the brick extended by the upper bound
+    const glm::vec3  margin (upperBound + Util::epsilon ());
+    const glm::ivec3 first = primitives.grid.cell (brick.minimum () - margin);
+    const glm::ivec3 last  = primitives.grid.cell (brick.maximum () + margin);
+
+    primitives.grid.forEachPrimitive (first, last, [&] (unsigned int i) {
+      if (isCandidate (primitives.box (i))) {
+        if (i < primitives.coneSpheres.size ()) {
+          candidates.coneSpheres.push_back (i);
+        }
+        else {
+          candidates.spheres.push_back (i - primitives.coneSpheres.size ());
+        }
+      }
+    });
+    std::sort (candidates.coneSpheres.begin (), candidates.coneSpheres.end ());
+    std::sort (candidates.spheres    .begin (), candidates.spheres    .end ());
   }
 
-  void sampleThread ( const SketchMesh& mesh, Parameters& params
-                    , unsigned int numThreads, unsigned int threadId )
+  PrimAABox sampleBox (const Parameters& params, const glm::uvec3& origin) {
+    return PrimAABox (params.samplePos (origin), params.samplePos (params.brickEnd (origin)));
+  }
+
+  float centerDistance (const Primitives& primitives, const Parameters& params, unsigned int index) {
+    return sampleAt (primitives, sampleBox (params, params.brickOrigin (index)).center ());
+  }
+
+  /* A brick can only be crossed by the surface if the distance at its center does not
+   * exceed half of its diagonal, because samples are distances. */
+  bool isNearSurface (const Parameters& params, unsigned int index, float centerDistance) {
+    const PrimAABox box          = sampleBox (params, params.brickOrigin (index));
+    const float     halfDiagonal = 0.5f * glm::distance (box.minimum (), box.maximum ());
+
+    return glm::abs (centerDistance) <= halfDiagonal + Util::epsilon ();
+  }
+
+  /* `previous` are the center distances of the bricks of the previous conversion, whose
+   * primitives differ from the current ones by the primitives bounded by `changed`.
+   * A brick is clean, i.e. none of its samples change, if it has been part of the previous
+   * conversion and none of these primitives can be closest to any of its samples before or
+   * after the change (cf. `cull`).
+   * The previous center distance also bounds the distance to the unchanged primitives from
+   * above, because it is not attained by a changed primitive in that case.
+   * The previous center distances of clean bricks are copied to `centerDistances`. */
+  void findCleanBricks ( const Parameters& params, float blending
+                       , const std::vector <PrimAABox>& changed
+                       , const WorldBrickMap <float>& previous
+                       , std::vector <float>& centerDistances
+                       , std::vector <unsigned char>& isClean )
   {
-    for (unsigned int z = 0; z < params.numSamples.z; z++) {
-      for (unsigned int y = 0; y < params.numSamples.y; y++) {
-        for (unsigned int x = 0; x < params.numSamples.x; x++) {
-          const unsigned int index = params.sampleIndex (x,y,z);
+    ParallelUtil::forEach (isClean.size (), [&] (unsigned int i) {
+      const auto it = previous.find (params.worldBrick (i));
+
+      if (it == previous.end ()) {
+        isClean [i] = 0;
+        return;
+      }
+      const PrimAABox box          = sampleBox (params, params.brickOrigin (i));
+      const float     halfDiagonal = 0.5f * glm::distance (box.minimum (), box.maximum ());
+      const float     upperBound   = it->second + halfDiagonal + blendingMargin (blending);
 
-          if (index % numThreads == threadId) {
-            const glm::vec3    pos   = params.samplePos   (x,y,z);
+      centerDistances [i] = it->second;
+      isClean         [i] = 1;
+      for (const PrimAABox& c : changed) {
+        const float lowerBound = distance (box, c);
 
-            params.samples.at (index) = sampleAt (mesh, pos);
+        if (lowerBound <= 0.0f || lowerBound <= upperBound + Util::epsilon ()) {
+          isClean [i] = 0;
+          break;
+        }
+      }
+    }, 16);
+  }
 
-            assert ((x > 0 && x < params.numSamples.x-1) || params.samples.at (index) > 0.0f);
-            assert ((y > 0 && y < params.numSamples.y-1) || params.samples.at (index) > 0.0f);
-            assert ((z > 0 && z < params.numSamples.z-1) || params.samples.at (index) > 0.0f);
+  // the size of the cells of a brick that are checked for homogeneity by `sampleBrick`
+  static const unsigned int homogeneousCellSize = 4;
+
+  /* Samples are distances, i.e. all samples of a cell of `homogeneousCellSize`^3 cubes have
+   * the sign of the distance `d` at the cell's center if `|d|` exceeds half of the cell's
+   * diagonal. If `|d|` also exceeds the resolution, so do all samples that share an edge with
+   * them. Neither these edges nor the cell's cubes are crossed by the surface, i.e. only the
+   * signs of the cell's samples are used. They are set to `d` instead of being computed.
+   * The samples of all other cells are exact, such that the mesh is the same as if all
+   * samples had been computed.
+   * Each candidate is evaluated at all exact samples of the brick at once, such that its
+   * distances are computed in batches by `Distance::distances`. */
+  void sampleBrick (const Primitives& primitives, Parameters& params, Brick& brick) {
+    static_assert (brickSize % homogeneousCellSize == 0, "cells must not exceed bricks");
+
+    const glm::uvec3            end = params.brickEnd (brick.origin);
+    const unsigned int          m   = brickSize + 1;
+    Candidates                  candidates;
+    std::vector <unsigned char> isExact (brick.samples.size (), 0);
+    std::vector <unsigned int>  indices;
+    std::vector <float>         xs, ys, zs;
+
+    cull (primitives, sampleBox (params, brick.origin), candidates);
+
+    auto sampleIndex = [&brick, m] (unsigned int x, unsigned int y, unsigned int z) {
+      return ((z - brick.origin.z) * m * m) + ((y - brick.origin.y) * m) + (x - brick.origin.x);
+    };
+
+    for (unsigned int cz = brick.origin.z; cz < end.z; cz += homogeneousCellSize) {
+      for (unsigned int cy = brick.origin.y; cy < end.y; cy += homogeneousCellSize) {
+        for (unsigned int cx = brick.origin.x; cx < end.x; cx += homogeneousCellSize) {
+          const glm::uvec3 cellOrigin (cx, cy, cz);
+          const glm::uvec3 cellEnd    (cellOrigin + glm::uvec3 (homogeneousCellSize));
+          const PrimAABox  box        (params.samplePos (cellOrigin), params.samplePos (cellEnd));
+          const float      d          = sampleAt (primitives, candidates, box.center ());
+          const float      bound      = (0.5f * glm::distance (box.minimum (), box.maximum ()))
+                                      + params.resolution + Util::epsilon ();
+          const bool       isHomogeneous = glm::abs (d) > bound;
+
+          assert (glm::all (glm::lessThanEqual (cellEnd, end)));
+
+          for (unsigned int z = cz; z <= cellEnd.z; z++) {
+            for (unsigned int y = cy; y <= cellEnd.y; y++) {
+              for (unsigned int x = cx; x <= cellEnd.x; x++) {
+                if (isHomogeneous) {
+                  brick.sample (x,y,z) = d;
+                }
+                else {
+                  isExact [sampleIndex (x,y,z)] = 1;
+                }
+              }
+            }
           }
         }
       }
     }
-  }
 
-  void sample (const SketchMesh& mesh, Parameters& params) {
-    params.samples.resize (params.numSamples.x * params.numSamples.y * params.numSamples.z, 0.0f);
+    for (unsigned int z = brick.origin.z; z <= end.z; z++) {
+      for (unsigned int y = brick.origin.y; y <= end.y; y++) {
+        for (unsigned int x = brick.origin.x; x <= end.x; x++) {
+          if (isExact [sampleIndex (x,y,z)]) {
+            const glm::vec3 pos = params.samplePos (x,y,z);
 
-    const unsigned int        numThreads = std::thread::hardware_concurrency();
-    std::vector <std::thread> threads;
+            indices.push_back (sampleIndex (x,y,z));
+            xs.push_back (pos.x);
+            ys.push_back (pos.y);
+            zs.push_back (pos.z);
+          }
+        }
+      }
+    }
+
+    const unsigned int  n = xs.size ();
+    std::vector <float> distances (n);
+    std::vector <float> min1 (n, std::numeric_limits <float>::max ());
+    std::vector <float> min2 (n, std::numeric_limits <float>::max ());
+
+    auto update = [n, &distances, &min1, &min2] () {
+      for (unsigned int i = 0; i < n; i++) {
+        updateMinDistances (distances [i], min1 [i], min2 [i]);
+      }
+    };
+
+    if (n > 0) {
+      for (unsigned int i : candidates.coneSpheres) {
+        Distance::distances ( primitives.coneSpheres [i], n
+                            , xs.data (), ys.data (), zs.data (), distances.data () );
+        update ();
+      }
+      for (unsigned int i : candidates.spheres) {
+        Distance::distances ( primitives.spheres [i], n
+                            , xs.data (), ys.data (), zs.data (), distances.data () );
+        update ();
+      }
+    }
+
+    for (unsigned int i = 0; i < n; i++) {
+      brick.samples [indices [i]] = smoothMin (min1 [i], min2 [i], primitives.blending);
+    }
 
-    for (unsigned int i = 0; i < numThreads; i++) {
-      threads.emplace_back (sampleThread, std::ref (mesh), std::ref (params), numThreads, i);
+#ifndef NDEBUG
+    for (unsigned int z = brick.origin.z; z <= end.z; z++) {
+      for (unsigned int y = brick.origin.y; y <= end.y; y++) {
+        for (unsigned int x = brick.origin.x; x <= end.x; x++) {
+          const float sample = brick.sample (x,y,z);
+
+          assert ((x > 0 && x < params.numSamples.x-1) || sample > 0.0f);
+          assert ((y > 0 && y < params.numSamples.y-1) || sample > 0.0f);
+          assert ((z > 0 && z < params.numSamples.z-1) || sample > 0.0f);
+        }
+      }
     }
-    for (unsigned int i = 0; i < numThreads; i++) {
-      threads.at (i).join ();
+#endif
+  }
+
+  /* Center distances of clean bricks are taken from `centerDistances` and their samples
+   * from `cachedBricks` of the previous conversion, all other bricks are sampled.
+   * `centerDistances` is updated and `cachedBricks` is consumed. */
+  void sample ( const Primitives& primitives, Parameters& params
+              , const std::vector <unsigned char>& isClean, std::vector <float>& centerDistances
+              , WorldBrickMap <Brick>& cachedBricks )
+  {
+    assert (isClean.size () == params.numBricks.x * params.numBricks.y * params.numBricks.z);
+    assert (isClean.size () == centerDistances.size ());
+
+    ParallelUtil::forEach (isClean.size (), [&] (unsigned int i) {
+      if (isClean [i] == 0) {
+        centerDistances [i] = centerDistance (primitives, params, i);
+      }
+    }, 16);
+
+    for (unsigned int i = 0; i < isClean.size (); i++) {
+      if (isNearSurface (params, i, centerDistances [i])) {
+        if (isClean [i]) {
+          params.bricks.emplace (i, Brick ( std::move (cachedBricks.at (params.worldBrick (i)))
+                                          , params.brickOrigin (i) ));
+        }
+        else {
+          params.bricks.emplace (i, Brick (params.brickOrigin (i)));
+        }
+        params.brickIndices.push_back (i);
+      }
     }
+    cachedBricks.clear ();
+
+    ParallelUtil::forEach (params.brickIndices.size (), [&] (unsigned int i) {
+      const unsigned int index = params.brickIndices [i];
+
+      if (isClean [index] == 0) {
+        sampleBrick (primitives, params, params.bricks.at (index));
+      }
+    }, 1);
   }
 
   bool isIntersecting (float s1, float s2) {
     return (s1 < 0.0f && s2 >= 0.0f) || (s1 >= 0.0f && s2 < 0.0f);
   }
 
-  void setCubeVertex (Parameters& params, unsigned int cubeIndex) {
+  void setCubeVertex ( const Parameters& params, Brick& brick
+                     , unsigned int x, unsigned int y, unsigned int z )
+  {
     glm::vec3    vertex          = glm::vec3 (0.0f);
     unsigned int numCrossedEdges = 0;
-    Cube&        cube            = params.grid.at (cubeIndex);
-
-    const unsigned int indices[] = { params.sampleIndex (cubeIndex, 0)
-                                   , params.sampleIndex (cubeIndex, 1)
-                                   , params.sampleIndex (cubeIndex, 2)
-                                   , params.sampleIndex (cubeIndex, 3)
-                                   , params.sampleIndex (cubeIndex, 4)
-                                   , params.sampleIndex (cubeIndex, 5)
-                                   , params.sampleIndex (cubeIndex, 6)
-                                   , params.sampleIndex (cubeIndex, 7)
-                                   };
-
-    const float samples[] = { params.samples.at (indices [0]), params.samples.at (indices [1])
-                            , params.samples.at (indices [2]), params.samples.at (indices [3])
-                            , params.samples.at (indices [4]), params.samples.at (indices [5])
-                            , params.samples.at (indices [6]), params.samples.at (indices [7])
-                            };
-
-    const glm::vec3 positions[] = { params.samplePos (indices [0]), params.samplePos (indices [1])
-                                  , params.samplePos (indices [2]), params.samplePos (indices [3])
-                                  , params.samplePos (indices [4]), params.samplePos (indices [5])
-                                  , params.samplePos (indices [6]), params.samplePos (indices [7])
-                                  };
+    Cube&        cube            = brick.cube (x,y,z);
+
+    const glm::uvec3 corners[] = { glm::uvec3 (x  , y  , z  ), glm::uvec3 (x+1, y  , z  )
+                                 , glm::uvec3 (x  , y+1, z  ), glm::uvec3 (x+1, y+1, z  )
+                                 , glm::uvec3 (x  , y  , z+1), glm::uvec3 (x+1, y  , z+1)
+                                 , glm::uvec3 (x  , y+1, z+1), glm::uvec3 (x+1, y+1, z+1)
+                                 };
+
+    float     samples[8];
+    glm::vec3 positions[8];
+
+    for (unsigned int i = 0; i < 8; i++) {
+      samples[i]   = brick.sample    (corners[i].x, corners[i].y, corners[i].z);
+      positions[i] = params.samplePos (corners[i]);
+    }
 
     auto checkEdge = [&numCrossedEdges, &vertex, &samples, &positions]
                      (unsigned short vertex1, unsigned short vertex2)
@@ -625,33 +1340,321 @@ namespace {
     }
   }
 
-  void makeGrid (Parameters& params) {
-    params.numCubes = params.numSamples - glm::uvec3 (1);
-    params.grid.resize (params.numCubes.x * params.numCubes.y * params.numCubes.z);
+  // maximal error of the vertex of a collapsed cell per crossed edge, relative to the resolution
+  static const float adaptiveTolerance = 0.1f;
+
+  /* A `Qef` accumulates the squared distances to the tangent planes at the crossings of
+   * crossed edges, i.e. its minimizer is the vertex of a cell (cf. dual contouring). */
+  struct Qef {
+    glm::vec3    ataDiagonal;
+    glm::vec3    ataOffDiagonal;
+    glm::vec3    atb;
+    float        btb;
+    glm::vec3    pointSum;
+    unsigned int numPoints;
+
+    Qef ()
+      : ataDiagonal    (0.0f)
+      , ataOffDiagonal (0.0f)
+      , atb            (0.0f)
+      , btb            (0.0f)
+      , pointSum       (0.0f)
+      , numPoints      (0)
+    {}
+
+    void add (const glm::vec3& point, const glm::vec3& normal) {
+      const float d = glm::dot (normal, point);
+
+      this->ataDiagonal    += normal * normal;
+      this->ataOffDiagonal += glm::vec3 ( normal.x * normal.y, normal.x * normal.z
+                                        , normal.y * normal.z );
+      this->atb            += normal * d;
+      this->btb            += d * d;
+      this->pointSum       += point;
+      this->numPoints++;
+    }
+
+    void add (const Qef& other) {
+      this->ataDiagonal    += other.ataDiagonal;
+      this->ataOffDiagonal += other.ataOffDiagonal;
+      this->atb            += other.atb;
+      this->btb            += other.btb;
+      this->pointSum       += other.pointSum;
+      this->numPoints      += other.numPoints;
+    }
+
+    glm::vec3 multiply (const glm::vec3& v) const {
+      const glm::vec3& d = this->ataDiagonal;
+      const glm::vec3& o = this->ataOffDiagonal;
+
+      return glm::vec3 ( (d.x * v.x) + (o.x * v.y) + (o.y * v.z)
+                       , (o.x * v.x) + (d.y * v.y) + (o.z * v.z)
+                       , (o.y * v.x) + (o.z * v.y) + (d.z * v.z) );
+    }
+
+    float error (const glm::vec3& v) const {
+      return glm::max ( 0.0f, glm::dot (v, this->multiply (v))
+                            - (2.0f * glm::dot (v, this->atb)) + this->btb );
+    }
+
+    /* The error is regularized by the squared distance to the mass point of all points, such
+     * that the minimizer is stable in flat regions, where the error alone is underdetermined. */
+    glm::vec3 minimize () const {
+      assert (this->numPoints > 0);
+
+      const glm::vec3& d         = this->ataDiagonal;
+      const glm::vec3& o         = this->ataOffDiagonal;
+      const float      w         = 0.05f * float (this->numPoints);
+      const glm::vec3  massPoint = this->pointSum / float (this->numPoints);
+      const glm::vec3  b         = this->atb - this->multiply (massPoint);
+      const glm::vec3  r0        = glm::vec3 (d.x + w, o.x, o.y);
+      const glm::vec3  r1        = glm::vec3 (o.x, d.y + w, o.z);
+      const glm::vec3  r2        = glm::vec3 (o.y, o.z, d.z + w);
+      const glm::vec3  c0        = glm::cross (r1, r2);
+      const glm::vec3  c1        = glm::cross (r2, r0);
+      const glm::vec3  c2        = glm::cross (r0, r1);
+
+      return massPoint + (((c0 * b.x) + (c1 * b.y) + (c2 * b.z)) / glm::dot (r0, c0));
+    }
+  };
+
+  // a configuration is simple if its surface has a single vertex and no ambiguous faces
+  bool isSimple (unsigned int configuration) {
+    assert (configuration <= 255);
+
+    for (unsigned int i = 0; i < 12; i++) {
+      if (edgeVertexIndices[configuration][i] > 0) {
+        return false;
+      }
+    }
+    for (unsigned int i = 0; i < 6; i++) {
+      unsigned int edge1, edge2, edge3, edge4;
+      edgeIndices (i, edge1, edge2, edge3, edge4);
+
+      if ( edgeVertexIndices[configuration][edge1] >= 0
+        && edgeVertexIndices[configuration][edge2] >= 0
+        && edgeVertexIndices[configuration][edge3] >= 0
+        && edgeVertexIndices[configuration][edge4] >= 0 )
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /* The crossings of a cube's crossed edges relative to `origin`, and the normals of the
+   * trilinear interpolation of its samples at these crossings. */
+  Qef cubeQef ( const Parameters& params, Brick& brick, const glm::vec3& origin
+              , unsigned int x, unsigned int y, unsigned int z )
+  {
+    Qef   qef;
+    float s[8];
+
+    for (unsigned int i = 0; i < 8; i++) {
+      s[i] = brick.sample (x + (i & 1), y + ((i >> 1) & 1), z + ((i >> 2) & 1));
+    }
+
+    for (unsigned int edge = 0; edge < 12; edge++) {
+      unsigned int vertex1, vertex2;
+      vertexIndices (edge, vertex1, vertex2);
+
+      if (isIntersecting (s[vertex1], s[vertex2])) {
+        const float     factor = s[vertex1] / (s[vertex1] - s[vertex2]);
+        const glm::vec3 p1     = glm::vec3 (vertex1 & 1, (vertex1 >> 1) & 1, (vertex1 >> 2) & 1);
+        const glm::vec3 p2     = glm::vec3 (vertex2 & 1, (vertex2 >> 1) & 1, (vertex2 >> 2) & 1);
+        const glm::vec3 p      = p1 + ((p2 - p1) * factor);
+        const glm::vec3 q      = glm::vec3 (1.0f) - p;
+
+        const glm::vec3 gradient (
+            (q.y * q.z * (s[1] - s[0])) + (p.y * q.z * (s[3] - s[2]))
+          + (q.y * p.z * (s[5] - s[4])) + (p.y * p.z * (s[7] - s[6]))
+          , (q.x * q.z * (s[2] - s[0])) + (p.x * q.z * (s[3] - s[1]))
+          + (q.x * p.z * (s[6] - s[4])) + (p.x * p.z * (s[7] - s[5]))
+          , (q.x * q.y * (s[4] - s[0])) + (p.x * q.y * (s[5] - s[1]))
+          + (q.x * p.y * (s[6] - s[2])) + (p.x * p.y * (s[7] - s[3])) );
+
+        if (glm::length2 (gradient) > 0.0f) {
+          qef.add ( params.samplePos (x, y, z) - origin + (p * params.resolution)
+                  , glm::normalize (gradient) );
+        }
+      }
+    }
+    return qef;
+  }
+
+  /* Collapses the cell of `size`^3 cubes at `(x,y,z)` into its first cube, if
+   * - its children are collapsed cells of half its size and they are simple,
+   * - its configuration is simple,
+   * - the sign at each corner of its children agrees with the sign at one of its corners
+   *   that are nearest, i.e. coarsening preserves the surface's topology
+   *   (cf. Ju et al.: Dual contouring of Hermite data), and
+   * - the minimizer of its children's QEFs lies within the cell and its error is bounded
+   *   by `adaptiveTolerance`. */
+  bool collapseCell ( const Parameters& params, Brick& brick, const glm::vec3& origin
+                    , std::vector <Qef>& qefs, unsigned int x, unsigned int y, unsigned int z
+                    , unsigned int size )
+  {
+    const unsigned int half = size / 2;
+
+    auto qefIndex = [&brick] (unsigned int cx, unsigned int cy, unsigned int cz) {
+      return ((cz - brick.origin.z) * brickSize * brickSize)
+           + ((cy - brick.origin.y) * brickSize)
+           +  (cx - brick.origin.x);
+    };
+
+    auto isNegative = [&brick, x, y, z, half] (unsigned int i, unsigned int j, unsigned int k) {
+      return brick.sample (x + (i * half), y + (j * half), z + (k * half)) < 0.0f;
+    };
+
+    Qef qef;
+    for (unsigned int i = 0; i < 8; i++) {
+      const unsigned int cx    = x + ((i & 1) * half);
+      const unsigned int cy    = y + (((i >> 1) & 1) * half);
+      const unsigned int cz    = z + (((i >> 2) & 1) * half);
+      const Cube&        child = brick.cube (cx, cy, cz);
 
-    for (unsigned int z = 0; z < params.numCubes.z; z++) {
-      for (unsigned int y = 0; y < params.numCubes.y; y++) {
-        for (unsigned int x = 0; x < params.numCubes.x; x++) {
-          setCubeVertex (params, params.cubeIndex (x,y,z));
+      if (child.cellSize != half || isSimple (child.configuration) == false) {
+        return false;
+      }
+      qef.add (qefs [qefIndex (cx, cy, cz)]);
+    }
+
+    unsigned int configuration = 0;
+    for (unsigned int i = 0; i < 8; i++) {
+      configuration |= int (isNegative (2 * (i & 1), 2 * ((i >> 1) & 1), 2 * ((i >> 2) & 1))) << i;
+    }
+    if (isSimple (configuration) == false) {
+      return false;
+    }
+
+    for (unsigned int k = 0; k <= 2; k++) {
+      for (unsigned int j = 0; j <= 2; j++) {
+        for (unsigned int i = 0; i <= 2; i++) {
+          // midpoints of edges and faces and the center are compared with the corners that
+          // are obtained by moving their centered coordinates to either side
+          bool agrees = false;
+
+          for (unsigned int c = 0; c < 8 && agrees == false; c++) {
+            const unsigned int ci = i == 1 ? 2 * (c & 1)        : i;
+            const unsigned int cj = j == 1 ? 2 * ((c >> 1) & 1) : j;
+            const unsigned int ck = k == 1 ? 2 * ((c >> 2) & 1) : k;
+
+            agrees = isNegative (i, j, k) == isNegative (ci, cj, ck);
+          }
+          if (agrees == false) {
+            return false;
+          }
         }
       }
     }
+
+    glm::vec3 vertex = invalidVec3;
+    if (qef.numPoints > 0) {
+      const glm::vec3 v   = qef.minimize ();
+      const glm::vec3 min = params.samplePos (x, y, z) - origin;
+      const glm::vec3 max = params.samplePos (x + size, y + size, z + size) - origin;
+      const float     tol = adaptiveTolerance * params.resolution;
+
+      if ( glm::any (glm::lessThan (v, min)) || glm::any (glm::greaterThan (v, max))
+        || qef.error (v) > float (qef.numPoints) * tol * tol )
+      {
+        return false;
+      }
+      vertex = origin + v;
+    }
+    assert ((qef.numPoints > 0) == (configuration != 0 && configuration != 255));
+
+    for (unsigned int cz = z; cz < z + size; cz++) {
+      for (unsigned int cy = y; cy < y + size; cy++) {
+        for (unsigned int cx = x; cx < x + size; cx++) {
+          Cube& cube = brick.cube (cx, cy, cz);
+
+          cube.cellSize = size;
+          cube.vertexInstanceIndices.clear ();
+        }
+      }
+    }
+    Cube& cell = brick.cube (x, y, z);
+
+    cell.configuration = configuration;
+    cell.vertex        = vertex;
+    cell.vertexInstanceIndices.resize (qef.numPoints > 0 ? 1 : 0, Util::invalidIndex ());
+    qefs [qefIndex (x, y, z)] = qef;
+    return true;
+  }
+
+  /* Cells of a brick are collapsed bottom-up, such that regions where the surface is flat,
+   * or that are not crossed by the surface at all, are represented by fewer cubes.
+   * Cells do not exceed a brick. Bricks cover whole cells, because the grid consists of
+   * whole bricks (cf. `setupSampling`). */
+  void simplifyBrick (const Parameters& params, Brick& brick) {
+    const glm::vec3   origin = params.samplePos (brick.origin);
+    const glm::uvec3  end    = params.brickEnd (brick.origin);
+    std::vector <Qef> qefs (brickSize * brickSize * brickSize);
+
+    for (unsigned int z = brick.origin.z; z < end.z; z++) {
+      for (unsigned int y = brick.origin.y; y < end.y; y++) {
+        for (unsigned int x = brick.origin.x; x < end.x; x++) {
+          const Cube& cube = brick.cube (x, y, z);
+
+          if (cube.configuration != 0 && cube.configuration != 255) {
+            qefs [ ((z - brick.origin.z) * brickSize * brickSize)
+                 + ((y - brick.origin.y) * brickSize)
+                 +  (x - brick.origin.x) ] = cubeQef (params, brick, origin, x, y, z);
+          }
+        }
+      }
+    }
+
+    for (unsigned int size = 2; size <= brickSize; size *= 2) {
+      for (unsigned int z = brick.origin.z; z + size <= end.z; z += size) {
+        for (unsigned int y = brick.origin.y; y + size <= end.y; y += size) {
+          for (unsigned int x = brick.origin.x; x + size <= end.x; x += size) {
+            collapseCell (params, brick, origin, qefs, x, y, z, size);
+          }
+        }
+      }
+    }
+  }
+
+  void setupCubes (Parameters& params, Brick& brick) {
+    params.forEachCube (brick, [&params] ( Brick& b, unsigned int x
+                                         , unsigned int y, unsigned int z )
+    {
+      setCubeVertex (params, b, x, y, z);
+    });
+    if (params.adaptive) {
+      simplifyBrick (params, brick);
+    }
   }
 
-  void resolveAmbiguities (Parameters& params) {
+  // the cubes of a brick only depend on its samples, i.e. cubes of clean bricks are kept
+  void makeGrid (Parameters& params, const std::vector <unsigned char>& isClean) {
+    ParallelUtil::forEach (params.brickIndices.size (), [&params, &isClean] (unsigned int i) {
+      const unsigned int index = params.brickIndices [i];
+
+      if (isClean [index] == 0) {
+        setupCubes (params, params.bricks.at (index));
+      }
+    }, 1);
+  }
+
+  // resolves ambiguities of the cubes of bricks `indices`, whose neighbouring bricks must be set up
+  void resolveAmbiguities (Parameters& params, const std::vector <unsigned int>& indices) {
     auto check = [&params] ( const Cube& cube, unsigned int x, unsigned int y, unsigned int z
                            , unsigned int ambiguousFace, int dim ) -> bool
     {
       assert (cube.isAmbiguous ());
       assert (dim == -3 || dim == -2 || dim == -1 || dim == 1 || dim == 2 || dim == 3);
 
-      Cube& other = params.grid.at ( params.cubeIndex 
-                                   ( dim == -1 ? x-1 : (dim == 1 ? x+1 : x)
-                                   , dim == -2 ? y-1 : (dim == 2 ? y+1 : y)
-                                   , dim == -3 ? z-1 : (dim == 3 ? z+1 : z) ) );
-      if (other.isAmbiguous ()) {
+      const Cube* other = params.cube ( dim == -1 ? x-1 : (dim == 1 ? x+1 : x)
+                                      , dim == -2 ? y-1 : (dim == 2 ? y+1 : y)
+                                      , dim == -3 ? z-1 : (dim == 3 ? z+1 : z) );
+
+      // cubes of bricks without samples are never ambiguous
+      if (other && other->isAmbiguous ()) {
         unsigned int otherAmbiguousFace = Util::invalidIndex ();
-        const bool   hasOtherAmbiguousFace = other.hasAmbiguousFaces (&otherAmbiguousFace);
+        const bool   hasOtherAmbiguousFace = other->hasAmbiguousFaces (&otherAmbiguousFace);
 
         assert (hasOtherAmbiguousFace);
 
@@ -667,75 +1670,189 @@ namespace {
       }
     };
 
-    for (unsigned int z = 0; z < params.numCubes.z; z++) {
-      for (unsigned int y = 0; y < params.numCubes.y; y++) {
-        for (unsigned int x = 0; x < params.numCubes.x; x++) {
-          Cube& cube = params.grid.at (params.cubeIndex (x,y,z));
-
-          if (cube.isAmbiguous ()) {
-            unsigned int ambiguousFace = Util::invalidIndex ();
-            const bool   hasAmbiguousFace = cube.hasAmbiguousFaces (&ambiguousFace);
-
-            assert (hasAmbiguousFace);
-
-            if ( (x > 0                   && check (cube, x, y, z, ambiguousFace, -1))
-              || (x < params.numCubes.x-1 && check (cube, x, y, z, ambiguousFace,  1))
-              || (y > 0                   && check (cube, x, y, z, ambiguousFace, -2))
-              || (y < params.numCubes.y-1 && check (cube, x, y, z, ambiguousFace,  2))
-              || (z > 0                   && check (cube, x, y, z, ambiguousFace, -3))
-              || (z < params.numCubes.z-1 && check (cube, x, y, z, ambiguousFace,  3)) )
-            {
-              cube.collapseWhenAmbiguous = false;
-            }
-            else {
-              cube.collapseWhenAmbiguous = true;
-            }
-          }
-          else {
-            cube.collapseWhenAmbiguous = false;
-          }
+    params.forEachCubeParallel (indices, [&params, &check] ( Brick& brick, unsigned int x
+                                                           , unsigned int y, unsigned int z )
+    {
+      Cube& cube = brick.cube (x,y,z);
+
+      if (cube.isAmbiguous ()) {
+        unsigned int ambiguousFace = Util::invalidIndex ();
+        const bool   hasAmbiguousFace = cube.hasAmbiguousFaces (&ambiguousFace);
+
+        assert (hasAmbiguousFace);
+
+        if ( (x > 0                   && check (cube, x, y, z, ambiguousFace, -1))
+          || (x < params.numCubes.x-1 && check (cube, x, y, z, ambiguousFace,  1))
+          || (y > 0                   && check (cube, x, y, z, ambiguousFace, -2))
+          || (y < params.numCubes.y-1 && check (cube, x, y, z, ambiguousFace,  2))
+          || (z > 0                   && check (cube, x, y, z, ambiguousFace, -3))
+          || (z < params.numCubes.z-1 && check (cube, x, y, z, ambiguousFace,  3)) )
+        {
+          cube.collapseWhenAmbiguous = false;
+        }
+        else {
+          cube.collapseWhenAmbiguous = true;
         }
       }
-    }
+      else {
+        cube.collapseWhenAmbiguous = false;
+      }
+    });
   }
 
-  Mesh makeMesh (Parameters& params) {
-    Mesh mesh;
-
-    for (Cube& cube : params.grid) {
-      for (unsigned int i = 0; i < cube.vertexInstanceIndices.size (); i++) {
-        assert (cube.vertex != invalidVec3);
-        cube.vertexInstanceIndices.at (i) = mesh.addVertex (cube.vertex);
+  unsigned int numVertexInstances (const Cube& cube) {
+    return cube.collapseWhenAmbiguous ? glm::min (1u, (unsigned int) cube.vertexInstanceIndices.size ())
+                                      : (unsigned int) cube.vertexInstanceIndices.size ();
+  }
 
-        if (cube.collapseWhenAmbiguous) {
-          break;
+  // calls `f (dim,x,y,z)` for each edge of `brick` that is crossed by the surface and that
+  // starts at sample `(x,y,z)` in dimension `dim`: each such edge yields a face
+  void forEachCrossedEdge ( Parameters& params, Brick& brick
+                          , const std::function <void ( unsigned int, unsigned int
+                                                      , unsigned int, unsigned int )>& f )
+  {
+    params.forEachCube (brick, [&f] (Brick& b, unsigned int x, unsigned int y, unsigned int z) {
+      auto check = [&] (unsigned int dim) {
+        const float s1 = b.sample (x,y,z);
+        const float s2 = b.sample ( dim == 0 ? x+1 : x
+                                  , dim == 1 ? y+1 : y
+                                  , dim == 2 ? z+1 : z );
+        if (isIntersecting (s1, s2)) {
+          f (dim, x, y, z);
         }
-      }
+      };
+      if (y > 0 && z > 0) { check (0); }
+      if (x > 0 && z > 0) { check (1); }
+      if (x > 0 && y > 0) { check (2); }
+    });
+  }
+
+  /* The cells of the four cubes around the edge that starts at sample `(x,y,z)` in dimension
+   * `dim`, in the order of the vertices of the edge's face.
+   * Adjacent cells coincide if they are part of the same collapsed cell: the face is a quad
+   * if all cells differ, a triangle if two cells coincide, and empty otherwise. */
+  struct EdgeCells {
+    const Cube* c;
+    const Cube* cu;
+    const Cube* cuv;
+    const Cube* cv;
+
+    EdgeCells (Parameters& params, unsigned int dim, unsigned int x, unsigned int y, unsigned int z)
+    {
+      const unsigned int u = (dim + 1) % 3;
+      const unsigned int v = (dim + 2) % 3;
+
+      this->c   = params.cell (x, y, z);
+      this->cu  = params.cell ( u == 0 ? x-1 : x
+                              , u == 1 ? y-1 : y
+                              , u == 2 ? z-1 : z );
+      this->cv  = params.cell ( v == 0 ? x-1 : x
+                              , v == 1 ? y-1 : y
+                              , v == 2 ? z-1 : z );
+      this->cuv = dim == 0 ? params.cell (x  , y-1, z-1)
+                : ( dim == 1 ? params.cell (x-1, y  , z-1)
+                : (            params.cell (x-1, y-1, z  ) ));
+
+      // cubes adjacent to a crossed edge are crossed too, i.e. their bricks are sampled
+      assert (this->c && this->cu && this->cv && this->cuv);
     }
 
-    auto makeQuad = [&params, &mesh] ( unsigned int dim, bool swap
-                                     , unsigned int i, unsigned int iu
-                                     , unsigned int iv, unsigned int iuv )
+    unsigned int numTriangles () const {
+      const unsigned int numDistinct = (this->c   != this->cu  ? 1 : 0)
+                                     + (this->cu  != this->cuv ? 1 : 0)
+                                     + (this->cuv != this->cv  ? 1 : 0)
+                                     + (this->cv  != this->c   ? 1 : 0);
+      return numDistinct > 2 ? numDistinct - 2 : 0;
+    }
+  };
+
+  /* Appends the vertices and faces of bricks `indices` to `mesh`.
+   * Faces also refer to vertices of cubes that precede a brick, i.e. these cubes must have
+   * been appended before.
+   * Bricks are processed in parallel.
+   * The vertices and quads of each brick are counted first, such that their prefix sums
+   * give each brick its range of the mesh's buffers, which are filled in parallel
+   * afterwards. */
+  void makeMesh (Parameters& params, const std::vector <unsigned int>& indices, Mesh& mesh) {
+    const unsigned int         numBricks = indices.size ();
+    std::vector <unsigned int> vertexOffsets (numBricks + 1, mesh.numVertices ());
+    std::vector <unsigned int> indexOffsets  (numBricks + 1, mesh.numIndices  ());
+
+    auto forEachBrick = [&params, &indices, numBricks]
+                        (const std::function <void (unsigned int, Brick&)>& f)
+    {
+      ParallelUtil::forEach (numBricks, [&params, &indices, &f] (unsigned int i) {
+        f (i, params.bricks.at (indices [i]));
+      }, 1);
+    };
+
+    forEachBrick ([&params, &vertexOffsets, &indexOffsets] (unsigned int i, Brick& brick) {
+      unsigned int numVertices  = 0;
+      unsigned int numTriangles = 0;
+
+      params.forEachCube (brick, [&numVertices] ( Brick& b, unsigned int x, unsigned int y
+                                                , unsigned int z )
+      {
+        numVertices += numVertexInstances (b.cube (x,y,z));
+      });
+      forEachCrossedEdge (params, brick, [&params, &numTriangles] ( unsigned int dim
+                                                                  , unsigned int x
+                                                                  , unsigned int y
+                                                                  , unsigned int z )
+      {
+        numTriangles += EdgeCells (params, dim, x, y, z).numTriangles ();
+      });
+      vertexOffsets [i+1] = numVertices;
+      indexOffsets  [i+1] = 3 * numTriangles;
+    });
+
+    for (unsigned int i = 0; i < numBricks; i++) {
+      vertexOffsets [i+1] += vertexOffsets [i];
+      indexOffsets  [i+1] += indexOffsets  [i];
+    }
+    mesh.resizeVertices (vertexOffsets.back ());
+    mesh.resizeIndices  (indexOffsets .back ());
+
+    forEachBrick ([&params, &vertexOffsets, &mesh] (unsigned int i, Brick& brick) {
+      unsigned int vertex = vertexOffsets [i];
+
+      params.forEachCube (brick, [&mesh, &vertex] ( Brick& b, unsigned int x, unsigned int y
+                                                  , unsigned int z )
+      {
+        Cube& cube = b.cube (x,y,z);
+
+        for (unsigned int j = 0; j < numVertexInstances (cube); j++) {
+          assert (cube.vertex != invalidVec3);
+          cube.vertexInstanceIndices.at (j) = vertex;
+          mesh.setVertex (vertex++, cube.vertex);
+        }
+      });
+      assert (vertex == vertexOffsets [i+1]);
+    });
+
+    auto makeQuad = [&mesh] ( unsigned int dim, bool swap
+                            , const Cube& c, const Cube& cu
+                            , const Cube& cv, const Cube& cuv, unsigned int& index )
     {
       unsigned int v1, v2, v3, v4;
 
       if (dim == 0) {
-        v1 = params.grid.at (i)  .vertexInstanceIndex (0);
-        v2 = params.grid.at (iu) .vertexInstanceIndex (3);
-        v3 = params.grid.at (iuv).vertexInstanceIndex (9);
-        v4 = params.grid.at (iv) .vertexInstanceIndex (6);
+        v1 = c  .vertexInstanceIndex (0);
+        v2 = cu .vertexInstanceIndex (3);
+        v3 = cuv.vertexInstanceIndex (9);
+        v4 = cv .vertexInstanceIndex (6);
       }
       else if (dim == 1) {
-        v1 = params.grid.at (i)  .vertexInstanceIndex (1);
-        v2 = params.grid.at (iu) .vertexInstanceIndex (7);
-        v3 = params.grid.at (iuv).vertexInstanceIndex (10);
-        v4 = params.grid.at (iv) .vertexInstanceIndex (4);
+        v1 = c  .vertexInstanceIndex (1);
+        v2 = cu .vertexInstanceIndex (7);
+        v3 = cuv.vertexInstanceIndex (10);
+        v4 = cv .vertexInstanceIndex (4);
       }
       else if (dim == 2) {
-        v1 = params.grid.at (i)  .vertexInstanceIndex (2);
-        v2 = params.grid.at (iu) .vertexInstanceIndex (5);
-        v3 = params.grid.at (iuv).vertexInstanceIndex (11);
-        v4 = params.grid.at (iv) .vertexInstanceIndex (8);
+        v1 = c  .vertexInstanceIndex (2);
+        v2 = cu .vertexInstanceIndex (5);
+        v3 = cuv.vertexInstanceIndex (11);
+        v4 = cv .vertexInstanceIndex (8);
       }
       else {
         DILAY_IMPOSSIBLE
@@ -744,76 +1861,241 @@ namespace {
       if (swap) {
         std::swap (v2, v4);
       }
-      if ( glm::distance2 (mesh.vertex (v1), mesh.vertex (v3))
+      if (v1 == v2 || v2 == v3 || v3 == v4 || v4 == v1) {
+        const unsigned int vs[] = { v1, v2, v3, v4 };
+
+        for (unsigned int i = 0; i < 4; i++) {
+          if (vs [i] != vs [(i + 1) % 4]) {
+            mesh.setIndex (index++, vs [i]);
+          }
+        }
+      }
+      else if ( glm::distance2 (mesh.vertex (v1), mesh.vertex (v3))
         <= glm::distance2 (mesh.vertex (v2), mesh.vertex (v4)) ) 
       {
-        mesh.addIndex (v1); mesh.addIndex (v2); mesh.addIndex (v3);
-        mesh.addIndex (v1); mesh.addIndex (v3); mesh.addIndex (v4);
+        mesh.setIndex (index++, v1); mesh.setIndex (index++, v2); mesh.setIndex (index++, v3);
+        mesh.setIndex (index++, v1); mesh.setIndex (index++, v3); mesh.setIndex (index++, v4);
       }
       else {
-        mesh.addIndex (v2); mesh.addIndex (v3); mesh.addIndex (v4);
-        mesh.addIndex (v2); mesh.addIndex (v4); mesh.addIndex (v1);
+        mesh.setIndex (index++, v2); mesh.setIndex (index++, v3); mesh.setIndex (index++, v4);
+        mesh.setIndex (index++, v2); mesh.setIndex (index++, v4); mesh.setIndex (index++, v1);
       }
     };
 
     auto makeFaces = [&params, &makeQuad]
-                     (unsigned int dim, unsigned int x, unsigned int y, unsigned int z)
+                     ( Brick& brick, unsigned int dim
+                     , unsigned int x, unsigned int y, unsigned int z, unsigned int& index )
     {
-      assert (dim == 0 || dim == 1 || dim == 2);
-
-      const float s1 = params.samples.at (params.sampleIndex (x,y,z));
-      const float s2 = params.samples.at (params.sampleIndex ( dim == 0 ? x+1 : x
-                                                             , dim == 1 ? y+1 : y
-                                                             , dim == 2 ? z+1 : z ));
-      if (isIntersecting (s1, s2)) {
-        const unsigned int i   = params.cubeIndex (x,y,z);
-        const unsigned int u   = (dim + 1) % 3;
-        const unsigned int v   = (dim + 2) % 3;
-        const unsigned int iu  = params.cubeIndex ( u == 0 ? x-1 : x
-                                                  , u == 1 ? y-1 : y
-                                                  , u == 2 ? z-1 : z );
-        const unsigned int iv  = params.cubeIndex ( v == 0 ? x-1 : x
-                                                  , v == 1 ? y-1 : y
-                                                  , v == 2 ? z-1 : z );
-
-        const unsigned int iuv = dim == 0 ? params.cubeIndex (x  , y-1, z-1)
-                             : ( dim == 1 ? params.cubeIndex (x-1, y  , z-1)
-                             : (            params.cubeIndex (x-1, y-1, z  ) ));
-
-        makeQuad (dim, s1 >= 0.0f, i, iu, iv, iuv);
+      const EdgeCells cells (params, dim, x, y, z);
+
+      if (cells.numTriangles () > 0) {
+        makeQuad ( dim, brick.sample (x,y,z) >= 0.0f
+                 , *cells.c, *cells.cu, *cells.cv, *cells.cuv, index );
       }
     };
 
-    for (unsigned int z = 0; z < params.numCubes.z; z++) {
-      for (unsigned int y = 0; y < params.numCubes.y; y++) {
-        for (unsigned int x = 0; x < params.numCubes.x; x++) {
-          if (y > 0 && z > 0) { makeFaces (0,x,y,z); }
-          if (x > 0 && z > 0) { makeFaces (1,x,y,z); }
-          if (x > 0 && y > 0) { makeFaces (2,x,y,z); }
-        }
+    forEachBrick ([&params, &indexOffsets, &makeFaces] (unsigned int i, Brick& brick) {
+      unsigned int index = indexOffsets [i];
+
+      forEachCrossedEdge (params, brick, [&brick, &makeFaces, &index] 
+                                         ( unsigned int dim, unsigned int x
+                                         , unsigned int y, unsigned int z )
+      {
+        makeFaces (brick, dim, x, y, z, index);
+      });
+      assert (index == indexOffsets [i+1]);
+    });
+  }
+
+  // samples the bricks of a layer that may be crossed by the surface and sets up their cubes
+  std::vector <unsigned int> sampleLayer ( const Primitives& primitives, Parameters& params
+                                         , unsigned int layer )
+  {
+    const unsigned int         layerSize = params.numBricks.x * params.numBricks.y;
+    std::vector <float>        centerDistances (layerSize);
+    std::vector <unsigned int> indices;
+
+    ParallelUtil::forEach (layerSize, [&] (unsigned int i) {
+      centerDistances [i] = centerDistance (primitives, params, (layer * layerSize) + i);
+    }, 16);
+
+    for (unsigned int i = 0; i < layerSize; i++) {
+      const unsigned int index = (layer * layerSize) + i;
+
+      if (isNearSurface (params, index, centerDistances [i])) {
+        params.bricks.emplace (index, Brick (params.brickOrigin (index)));
+        indices.push_back (index);
       }
     }
 
+    ParallelUtil::forEach (indices.size (), [&] (unsigned int i) {
+      Brick& brick = params.bricks.at (indices [i]);
+
+      sampleBrick (primitives, params, brick);
+      setupCubes  (params, brick);
+    }, 1);
+    return indices;
+  }
+
+  /* Bricks are processed in layers along the z-axis, such that memory scales with the
+   * surface's area within a layer rather than with its total area.
+   * Ambiguities of a layer's cubes are resolved once the next layer is set up, and faces of
+   * a layer also refer to cubes of the previous layer, i.e. at most three layers of bricks
+   * are kept.
+   * Bricks are appended in the order of their indices, which yields the same mesh as
+   * processing all bricks at once. */
+  Mesh convertLayers (const Primitives& primitives, Parameters& params) {
+    Mesh                       mesh;
+    std::vector <unsigned int> previous;
+    std::vector <unsigned int> current;
+    std::vector <unsigned int> next;
+
+    if (params.numBricks.z > 0) {
+      current = sampleLayer (primitives, params, 0);
+    }
+    for (unsigned int z = 0; z < params.numBricks.z; z++) {
+      if (z + 1 < params.numBricks.z) {
+        next = sampleLayer (primitives, params, z + 1);
+      }
+      resolveAmbiguities (params, current);
+      makeMesh           (params, current, mesh);
+
+      for (unsigned int i : previous) {
+        params.bricks.erase (i);
+      }
+      previous = std::move (current);
+      current  = std::move (next);
+      next.clear ();
+    }
     assert (MeshUtil::checkConsistency (mesh));
     return mesh;
   }
 }
 
-Mesh SketchConversion :: convert (const SketchMesh& mesh, float resolution) {
+/* Center distances and bricks of the previous conversion are keyed by their world
+ * coordinates (cf. `Parameters::worldBrick`), such that they remain valid if the grid is
+ * moved or resized. */
+struct SketchConversionCache::Impl {
+  float                        resolution;
+  float                        blending;
+  bool                         adaptive;
+  std::vector <PrimitiveKey>   keys;
+  WorldBrickMap <float>        centerDistances;
+  WorldBrickMap <Brick>        bricks;
+  unsigned int                 numSampledBricks;
+
+  Impl () {
+    this->reset ();
+  }
+
+  void reset () {
+    this->resolution       = 0.0f;
+    this->blending         = 0.0f;
+    this->adaptive         = false;
+    this->numSampledBricks = 0;
+    this->keys           .clear ();
+    this->centerDistances.clear ();
+    this->bricks         .clear ();
+  }
+
+  // samples of the previous conversion are only reusable on grids of the same resolution
+  bool isCompatible (const Primitives& primitives, const Parameters& params) const {
+    return this->resolution == params.resolution
+        && this->blending   == primitives.blending
+        && this->adaptive   == params.adaptive;
+  }
+
+  Mesh convert ( const SketchTree& tree, const SketchPaths& paths
+               , float resolution, float blending, bool adaptive )
+  {
+    assert (tree.hasRoot () || paths.empty () == false);
+
+    const Primitives primitives (tree, paths, blending);
+    Parameters       params;
+    params.resolution = resolution;
+    params.adaptive   = adaptive;
+
+    setupSampling (primitives, params);
+
+    if (params.numSamples.x == 0 || params.numSamples.y == 0 || params.numSamples.z == 0) {
+      this->reset ();
+      return Mesh ();
+    }
+    const unsigned int          numBricks = params.numBricks.x * params.numBricks.y
+                                          * params.numBricks.z;
+    std::vector <PrimitiveKey>  keys      = primitiveKeys (primitives);
+    std::vector <float>         centerDistances (numBricks, 0.0f);
+    std::vector <unsigned char> isClean         (numBricks, 0);
+
+    if (this->isCompatible (primitives, params)) {
+      findCleanBricks ( params, primitives.blending, changedBoxes (this->keys, keys)
+                      , this->centerDistances, centerDistances, isClean );
+    }
+    else {
+      this->bricks.clear ();
+    }
+
+    sample             (primitives, params, isClean, centerDistances, this->bricks);
+    makeGrid           (params, isClean);
+    resolveAmbiguities (params, params.brickIndices);
+
+    Mesh mesh;
+    makeMesh (params, params.brickIndices, mesh);
+    assert (MeshUtil::checkConsistency (mesh));
+
+    this->resolution       = params.resolution;
+    this->blending         = primitives.blending;
+    this->adaptive         = params.adaptive;
+    this->keys             = std::move (keys);
+    this->numSampledBricks = 0;
+
+    for (unsigned int i : params.brickIndices) {
+      if (isClean [i] == 0) {
+        this->numSampledBricks++;
+      }
+    }
+
+    this->centerDistances.clear ();
+    for (unsigned int i = 0; i < numBricks; i++) {
+      this->centerDistances.emplace (params.worldBrick (i), centerDistances [i]);
+    }
+
+    this->bricks.clear ();
+    for (auto& b : params.bricks) {
+      this->bricks.emplace (params.worldBrick (b.first), std::move (b.second));
+    }
+    return mesh;
+  }
+};
+
+DELEGATE_BIG3 (SketchConversionCache)
+DELEGATE5     ( Mesh, SketchConversionCache, convert, const SketchTree&, const SketchPaths&
+              , float, float, bool )
+DELEGATE      (void, SketchConversionCache, reset)
+GETTER_CONST  (unsigned int, SketchConversionCache, numSampledBricks)
+
+Mesh SketchConversion :: convert ( const SketchMesh& mesh, float resolution, float blending
+                                 , bool adaptive )
+{
   assert (mesh.isEmpty () == false);
 
-  Parameters params;
+  return SketchConversion::convert (mesh.tree (), mesh.paths (), resolution, blending, adaptive);
+}
+
+Mesh SketchConversion :: convert ( const SketchTree& tree, const SketchPaths& paths
+                                 , float resolution, float blending, bool adaptive )
+{
+  assert (tree.hasRoot () || paths.empty () == false);
+
+  const Primitives primitives (tree, paths, blending);
+  Parameters       params;
   params.resolution = resolution;
+  params.adaptive   = adaptive;
 
-  setupSampling (mesh, params);
+  setupSampling (primitives, params);
 
-  if (params.numSamples.x > 0 && params.numSamples.y > 0 && params.numSamples.z > 0) {
-    sample             (mesh, params);
-    makeGrid           (params);
-    resolveAmbiguities (params);
-    return makeMesh    (params);
-  }
-  else {
+  if (params.numSamples.x == 0 || params.numSamples.y == 0 || params.numSamples.z == 0) {
     return Mesh ();
   }
+  return convertLayers (primitives, params);
 }
@@ -5,12 +5,47 @@
 #ifndef DILAY_SKETCH_CONVERSION
 #define DILAY_SKETCH_CONVERSION
 
+#include "macro.hpp"
+#include "sketch/fwd.hpp"
+
 class Mesh;
-class SketchMesh;
 
 namespace SketchConversion {
 
-  Mesh convert (const SketchMesh&, float);
+  /** `convert (m,r,b,a)` converts sketch mesh `m` at resolution `r`.
+   * Primitives are blended by a smooth union with blending radius `b`, i.e. a radius of `0`
+   * yields their plain union.
+   * If `a` is set, the resolution is adaptive: regions where the surface is flat are
+   * represented by fewer but larger faces. */
+  Mesh convert (const SketchMesh&, float, float, bool);
+
+  /** `convert (t,p,r,b,a)` converts the sketch given by tree `t` and paths `p`.
+   * It does not access any OpenGL state and may be called from any thread.
+   * The sketch's volume is converted in slabs, such that only the samples of a few slabs are
+   * kept in memory at once. */
+  Mesh convert (const SketchTree&, const SketchPaths&, float, float, bool);
+};
+
+/** A `SketchConversionCache` keeps the samples of its previous conversion.
+ * Successive conversions of an edited sketch only resample the regions that are affected
+ * by the edited primitives, and yield the same mesh as `SketchConversion::convert`.
+ * Samples are grouped in bricks that are aligned to the world, i.e. they are reused even if
+ * the sketch's bounding box changes, as long as the resolution, the blending radius and the
+ * adaptivity are unchanged.
+ * All samples near the surface are kept, i.e. a cache needs more memory than
+ * `SketchConversion::convert`. */
+class SketchConversionCache {
+  public:
+    DECLARE_BIG3 (SketchConversionCache)
+
+    Mesh         convert          (const SketchTree&, const SketchPaths&, float, float, bool);
+    void         reset            ();
+
+    /** `numSampledBricks ()` is the number of bricks sampled by the last conversion. */
+    unsigned int numSampledBricks () const;
+
+  private:
+    IMPLEMENTATION
 };
 
 #endif
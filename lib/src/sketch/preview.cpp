@@ -0,0 +1,209 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <atomic>
+#include <iterator>
+#include <map>
+#include <thread>
+#include <unordered_map>
+#include "color.hpp"
+#include "config.hpp"
+#include "../mesh.hpp"
+#include "render-mode.hpp"
+#include "sketch/conversion.hpp"
+#include "sketch/mesh.hpp"
+#include "sketch/path.hpp"
+#include "sketch/preview.hpp"
+
+namespace {
+  // the coarsest resolution of `ToolConvertSketch`
+  constexpr float previewResolution = 0.1f;
+
+  struct Job {
+    SketchTree  tree;
+    SketchPaths paths;
+    float       blending;
+    bool        adaptive;
+  };
+}
+
+struct SketchPreview::Impl {
+  bool                                                     isEnabled;
+  float                                                    blending;
+  bool                                                     adaptive;
+  Color                                                    color;
+  Color                                                    wireframeColor;
+  std::function <void ()>                                  onConverted;
+  std::unordered_map <unsigned int, Mesh>                  meshes;
+  std::map <unsigned int, Job>                             pendingJobs;
+  std::unordered_map <unsigned int, SketchConversionCache> caches;
+
+  /* While `thread` is running, it converts the sketch mesh with index `runningIndex`.
+   * It only accesses the conversion cache of that index and `result`.
+   * If the preview of that index is removed in the meantime, `result` is discarded. */
+  std::thread                                              thread;
+  std::atomic <bool>                                       isDone;
+  unsigned int                                             runningIndex;
+  bool                                                     isRunningRemoved;
+  Mesh                                                     result;
+
+  Impl ()
+    : isEnabled        (false)
+    , blending         (0.0f)
+    , adaptive         (false)
+    , isDone           (false)
+    , runningIndex     (0)
+    , isRunningRemoved (false)
+  {}
+
+  ~Impl () {
+    if (this->thread.joinable ()) {
+      this->thread.join ();
+    }
+  }
+
+  void enable (bool e) {
+    this->isEnabled = e;
+
+    if (e == false) {
+      this->reset ();
+    }
+  }
+
+  void update (const SketchMesh& mesh) {
+    if (this->isEnabled == false) {
+      return;
+    }
+    else if (mesh.tree ().hasRoot () == false && mesh.paths ().empty ()) {
+      this->remove (mesh);
+    }
+    else {
+      Job& job = this->pendingJobs [mesh.index ()];
+
+      job.tree     = mesh.tree  ();
+      job.paths    = mesh.paths ();
+      job.blending = this->blending;
+      job.adaptive = this->adaptive;
+
+      this->startNextJob ();
+    }
+  }
+
+  void remove (const SketchMesh& mesh) {
+    const unsigned int index = mesh.index ();
+
+    this->meshes     .erase (index);
+    this->pendingJobs.erase (index);
+
+    if (this->thread.joinable () && this->runningIndex == index) {
+      this->isRunningRemoved = true;
+    }
+    else {
+      this->caches.erase (index);
+    }
+  }
+
+  void reset () {
+    this->meshes     .clear ();
+    this->pendingJobs.clear ();
+
+    if (this->thread.joinable ()) {
+      this->isRunningRemoved = true;
+
+      for (auto it = this->caches.begin (); it != this->caches.end (); ) {
+        it = it->first == this->runningIndex ? std::next (it) : this->caches.erase (it);
+      }
+    }
+    else {
+      this->caches.clear ();
+    }
+  }
+
+  void startNextJob () {
+    if (this->thread.joinable () || this->pendingJobs.empty ()) {
+      return;
+    }
+    auto               it    = this->pendingJobs.begin ();
+    const unsigned int index = it->first;
+    Job                job   = std::move (it->second);
+
+    this->pendingJobs.erase (it);
+
+    SketchConversionCache& cache = this->caches [index];
+
+    this->runningIndex     = index;
+    this->isRunningRemoved = false;
+    this->isDone           = false;
+    this->thread           = std::thread ([this, &cache]
+                                          (const Job job, const std::function <void ()> done)
+    {
+      this->result = cache.convert ( job.tree, job.paths, previewResolution
+                                   , job.blending, job.adaptive );
+      this->isDone = true;
+
+      if (done) {
+        done ();
+      }
+    }, std::move (job), this->onConverted);
+  }
+
+  void finishJob () {
+    this->thread.join ();
+
+    if (this->isRunningRemoved) {
+      if (this->pendingJobs.count (this->runningIndex) == 0) {
+        this->caches.erase (this->runningIndex);
+      }
+    }
+    else {
+      Mesh& mesh = this->meshes [this->runningIndex];
+
+      mesh = std::move (this->result);
+      mesh.renderMode ().flatShading     (true);
+      mesh.renderMode ().renderWireframe (true);
+      mesh.color                         (this->color);
+      mesh.wireframeColor                (this->wireframeColor);
+      mesh.bufferData                    ();
+    }
+  }
+
+  void render (Camera& camera) {
+    if (this->thread.joinable () && this->isDone) {
+      this->finishJob    ();
+      this->startNextJob ();
+    }
+    for (auto& m : this->meshes) {
+      if (m.second.numIndices () > 0) {
+        m.second.render (camera);
+      }
+    }
+  }
+
+  void runFromConfig (const Config& config) {
+    this->color          = config.get <Color> ("editor/mesh/color/normal");
+    this->wireframeColor = config.get <Color> ("editor/mesh/color/wireframe");
+
+    for (auto& m : this->meshes) {
+      m.second.color          (this->color);
+      m.second.wireframeColor (this->wireframeColor);
+    }
+  }
+};
+
+DELEGATE_CONSTRUCTOR (SketchPreview)
+DELEGATE_DESTRUCTOR  (SketchPreview)
+
+// a running conversion refers to the implementation, which must not be moved itself
+SketchPreview :: SketchPreview (SketchPreview&& source) : impl (std::move (source.impl)) {}
+
+GETTER_CONST    (bool, SketchPreview, isEnabled)
+DELEGATE1       (void, SketchPreview, enable, bool)
+SETTER          (float, SketchPreview, blending)
+SETTER          (bool, SketchPreview, adaptive)
+DELEGATE1       (void, SketchPreview, update, const SketchMesh&)
+DELEGATE1       (void, SketchPreview, remove, const SketchMesh&)
+DELEGATE        (void, SketchPreview, reset)
+DELEGATE1       (void, SketchPreview, render, Camera&)
+SETTER          (const std::function <void ()>&, SketchPreview, onConverted)
+DELEGATE1       (void, SketchPreview, runFromConfig, const Config&)
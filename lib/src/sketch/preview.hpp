@@ -0,0 +1,49 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_SKETCH_PREVIEW
+#define DILAY_SKETCH_PREVIEW
+
+#include <functional>
+#include "configurable.hpp"
+#include "macro.hpp"
+#include "sketch/fwd.hpp"
+
+class Camera;
+
+/** A `SketchPreview` keeps a coarse conversion of each sketch mesh of a scene.
+ * Previews are converted one after another on a background thread.
+ * Edits made while a conversion is running are converted as soon as it has finished.
+ * All methods must be called from the thread that renders the scene. */
+class SketchPreview : public Configurable {
+  public:
+    DECLARE_BIG3 (SketchPreview)
+
+    bool isEnabled   () const;
+
+    /** `enable (false)` deletes all previews. */
+    void enable      (bool);
+    void blending    (float);
+    void adaptive    (bool);
+
+    /** `update (m)` reconverts the preview of sketch mesh `m` if previews are enabled. */
+    void update      (const SketchMesh&);
+
+    /** `remove (m)` deletes the preview of sketch mesh `m`.
+     * It must be called before `m` is deleted, since its index may be reused. */
+    void remove      (const SketchMesh&);
+    void reset       ();
+    void render      (Camera&);
+
+    /** `onConverted (f)` sets the function `f` that is called on the background thread
+     * whenever a conversion has finished, e.g. to schedule a redraw. */
+    void onConverted (const std::function <void ()>&);
+
+  private:
+    IMPLEMENTATION
+
+    void runFromConfig (const Config&);
+};
+
+#endif
@@ -9,7 +9,9 @@
 #include "history.hpp"
 #include "mesh.hpp"
 #include "mesh-util.hpp"
+#include "parallel-util.hpp"
 #include "scene.hpp"
+#include "sketch/preview.hpp"
 #include "state.hpp"
 #include "tool.hpp"
 #include "view/gl-widget.hpp"
@@ -36,7 +38,24 @@ struct State::Impl {
     , history    (this->config)
     , scene      (this->config)
   {
+    ParallelUtil::numThreads (this->config.get <int> ("editor/num-threads"));
     this->scene.newWingedMesh (this->config, MeshUtil::icosphere (3));
+    this->setupSketchPreview ();
+  }
+
+  void setupSketchPreview () {
+    SketchPreview& preview = this->scene.sketchPreview ();
+
+    // the preview is toggled by `ToolModifySketch` and converts like `ToolConvertSketch`
+    preview.enable   (this->cache.get <bool>  ("editor/tool/modify-sketch/preview", false));
+    preview.blending (this->cache.get <float> ("editor/tool/convert-sketch/blending", 0.0f));
+    preview.adaptive (this->cache.get <bool>  ("editor/tool/convert-sketch/adaptive", false));
+
+    // previews are converted on a background thread
+    preview.onConverted ([this] () {
+      QMetaObject::invokeMethod ( &this->mainWindow.mainWidget ().glWidget ()
+                                , "update", Qt::QueuedConnection );
+    });
   }
 
   ~Impl () {
@@ -84,6 +103,8 @@ struct State::Impl {
   }
 
   void fromConfig () {
+    ParallelUtil::numThreads (this->config.get <int> ("editor/num-threads"));
+
     this->camera .fromConfig (this->config);
     this->history.fromConfig (this->config);
     this->scene  .fromConfig (this->config);
@@ -11,7 +11,7 @@
 #include "winged/vertex.hpp"
 
 namespace {
-  typedef std::vector <glm::vec3> Adjacents;
+  typedef SubdivisionButterfly::Adjacents Adjacents;
 
   glm::vec3 subdivK6 (const Adjacents& a1, const Adjacents& a2) {
 
@@ -67,43 +67,53 @@ namespace {
     }
   }
 
-  Adjacents adjacents (const WingedMesh& mesh, WingedEdge& edge, const WingedVertex& vertex) {
+  void adjacents ( const WingedMesh& mesh, WingedEdge& edge, const WingedVertex& vertex
+                 , Adjacents& adjacents )
+  {
     const float edgeLength = glm::length (edge.vector (mesh));
 
-    std::function < glm::vec3 (const WingedEdge&, const WingedVertex&, float) > traverse =
-      [&mesh, &traverse, edgeLength] 
-      (const WingedEdge& e, const WingedVertex& o, float oLength) -> glm::vec3 {
-        WingedEdge* sibling = e.adjacentSibling (mesh, o);
-
-        if (sibling) {
-          const float sLength = oLength + glm::length (sibling->vector (mesh));
-          if (glm::abs (edgeLength - oLength) < glm::abs (edgeLength - sLength) ) {
-            return o.position (mesh);
-          }
-          else {
-            return traverse (*sibling, sibling->otherVertexRef (o), sLength);
-          }
-        }
-        else {
-          return o.position (mesh);
+    auto traverse = [&mesh, edgeLength] (const WingedEdge& adjEdge, const WingedVertex& adjVertex) {
+      const WingedEdge*   e       = &adjEdge;
+      const WingedVertex* o       = &adjVertex;
+      float               oLength = glm::length (adjEdge.vector (mesh));
+
+      for (WingedEdge* sibling = e->adjacentSibling (mesh, *o); sibling
+          ; sibling = e->adjacentSibling (mesh, *o))
+      {
+        const float sLength = oLength + glm::length (sibling->vector (mesh));
+
+        if (glm::abs (edgeLength - oLength) < glm::abs (edgeLength - sLength)) {
+          break;
         }
+        e       = sibling;
+        o       = &sibling->otherVertexRef (*o);
+        oLength = sLength;
+      }
+      return o->position (mesh);
     };
 
-    Adjacents adjacents;
+    adjacents.clear ();
     for (WingedEdge& e : vertex.adjacentEdges (edge)) {
-      WingedVertex& a = e.otherVertexRef (vertex);
-
-      adjacents.push_back (traverse (e, a, glm::length (e.vector (mesh))));
+      adjacents.push_back (traverse (e, e.otherVertexRef (vertex)));
     }
-    return adjacents;
   }
 };
 
 glm::vec3 SubdivisionButterfly::subdivideEdge (const WingedMesh& mesh, WingedEdge& edge) {
+  Adjacents a1;
+  Adjacents a2;
+
+  return SubdivisionButterfly::subdivideEdge (mesh, edge, a1, a2);
+}
+
+glm::vec3 SubdivisionButterfly::subdivideEdge ( const WingedMesh& mesh, WingedEdge& edge
+                                              , Adjacents& a1, Adjacents& a2 )
+{
   WingedVertex& v1 = edge.vertex1Ref ();
   WingedVertex& v2 = edge.vertex2Ref ();
-  Adjacents     a1 = adjacents (mesh, edge, v1);
-  Adjacents     a2 = adjacents (mesh, edge, v2);
+
+  adjacents (mesh, edge, v1, a1);
+  adjacents (mesh, edge, v2, a2);
 
   return subdivide (v1.position (mesh), a1, v2.position (mesh), a2);
 }
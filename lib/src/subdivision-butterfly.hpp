@@ -6,12 +6,19 @@
 #define DILAY_SUBDIVISION_BUTTERFLY
 
 #include <glm/fwd.hpp>
+#include <vector>
 
 class WingedMesh;
 class WingedEdge;
 
 namespace SubdivisionButterfly {
+  typedef std::vector <glm::vec3> Adjacents;
+
   glm::vec3 subdivideEdge (const WingedMesh&, WingedEdge&);
+
+  /** `subdivideEdge (m,e,a1,a2)` is `subdivideEdge (m,e)` but uses `a1` and `a2` as
+   * buffers for the positions of adjacent vertices, so that they can be reused. */
+  glm::vec3 subdivideEdge (const WingedMesh&, WingedEdge&, Adjacents&, Adjacents&);
 }
 
 #endif
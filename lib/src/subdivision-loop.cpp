@@ -0,0 +1,34 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <glm/glm.hpp>
+#include "adjacent-iterator.hpp"
+#include "subdivision-loop.hpp"
+#include "winged/edge.hpp"
+#include "winged/vertex.hpp"
+
+glm::vec3 SubdivisionLoop::subdivideEdge (const WingedMesh& mesh, const WingedEdge& edge) {
+  const glm::vec3 v1 = edge.vertex1Ref ().position (mesh);
+  const glm::vec3 v2 = edge.vertex2Ref ().position (mesh);
+  const glm::vec3 v3 = edge.vertexRef (edge.leftFaceRef  (), 2).position (mesh);
+  const glm::vec3 v4 = edge.vertexRef (edge.rightFaceRef (), 2).position (mesh);
+
+  return (0.375f * (v1 + v2)) + (0.125f * (v3 + v4));
+}
+
+glm::vec3 SubdivisionLoop::smoothVertex (const WingedMesh& mesh, const WingedVertex& vertex) {
+  glm::vec3    sum     (0.0f);
+  unsigned int valence (0);
+
+  for (const WingedVertex& a : vertex.adjacentVertices ()) {
+    sum += a.position (mesh);
+    valence++;
+  }
+  assert (valence >= 3);
+
+  const float beta = valence == 3 ? 3.0f / 16.0f
+                                  : 3.0f / (8.0f * float (valence));
+
+  return ((1.0f - (float (valence) * beta)) * vertex.position (mesh)) + (beta * sum);
+}
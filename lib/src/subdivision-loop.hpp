@@ -0,0 +1,21 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_SUBDIVISION_LOOP
+#define DILAY_SUBDIVISION_LOOP
+
+#include <glm/fwd.hpp>
+
+class WingedMesh;
+class WingedEdge;
+class WingedVertex;
+
+namespace SubdivisionLoop {
+  glm::vec3 subdivideEdge (const WingedMesh&, const WingedEdge&);
+
+  /** `smoothVertex (m,v)` is the new position of an existing vertex `v`. */
+  glm::vec3 smoothVertex  (const WingedMesh&, const WingedVertex&);
+}
+
+#endif
@@ -6,14 +6,12 @@
 #include "camera.hpp"
 #include "dimension.hpp"
 #include "history.hpp"
-#include "index-octree.hpp"
 #include "intersection.hpp"
-#include "mesh.hpp"
 #include "mirror.hpp"
 #include "primitive/ray.hpp"
-#include "primitive/triangle.hpp"
 #include "scene.hpp"
 #include "sketch/mesh.hpp"
+#include "sketch/preview.hpp"
 #include "state.hpp"
 #include "tool.hpp"
 #include "view/gl-widget.hpp"
@@ -116,25 +114,12 @@ struct Tool::Impl {
     this->state.history ().snapshotSketchMeshes (this->state.scene ());
   }
 
-  bool intersectsRecentOctree (const ViewPointingEvent& e, Intersection& intersection) const {
-    assert (this->state.history ().hasRecentOctrees ());
-
+  bool intersectsOriginal (const ViewPointingEvent& e, Intersection& intersection) const {
     const PrimRay ray = this->state.camera ().ray (e.ivec2 ());
 
-    this->state.history ().forEachRecentOctree (
-      [&ray, &intersection] (const Mesh& mesh, const IndexOctree& octree) {
-        octree.intersects (ray, [&ray, &mesh, &intersection] (unsigned int i) {
-          const PrimTriangle tri ( mesh.vertex (mesh.index ((3 * i) + 0))
-                                 , mesh.vertex (mesh.index ((3 * i) + 1))
-                                 , mesh.vertex (mesh.index ((3 * i) + 2)) );
-          float t;
-
-          if (IntersectionUtil::intersects (ray, tri, &t)) {
-            intersection.update (t, ray.pointAt (t), tri.normal ());
-          }
-        });
-      }
-    );
+    this->state.scene ().forEachMesh ([&ray, &intersection] (WingedMesh& mesh) {
+      mesh.intersectsOriginal (ray, intersection);
+    });
     return intersection.isIntersection ();
   }
 
@@ -185,6 +170,7 @@ struct Tool::Impl {
         mesh.mirror (*this->mirrorDimension ());
       }
     );
+    this->state.scene ().updateSketchPreviews ();
   }
 
   template <typename T, typename ... Ts>
@@ -230,7 +216,7 @@ DELEGATE_CONST  (glm::ivec2      , Tool, cursorPosition)
 DELEGATE        (void            , Tool, snapshotAll)
 DELEGATE        (void            , Tool, snapshotWingedMeshes)
 DELEGATE        (void            , Tool, snapshotSketchMeshes)
-DELEGATE2_CONST (bool            , Tool, intersectsRecentOctree, const ViewPointingEvent&, Intersection&)
+DELEGATE2_CONST (bool            , Tool, intersectsOriginal, const ViewPointingEvent&, Intersection&)
 DELEGATE_CONST  (bool            , Tool, hasMirror)
 DELEGATE_CONST  (const Mirror&   , Tool, mirror)
 DELEGATE1       (void            , Tool, mirror, bool)
@@ -48,7 +48,7 @@ class Tool {
     void             snapshotAll            ();
     void             snapshotWingedMeshes   ();
     void             snapshotSketchMeshes   ();
-    bool             intersectsRecentOctree (const ViewPointingEvent&, Intersection&) const;
+    bool             intersectsOriginal     (const ViewPointingEvent&, Intersection&) const;
     bool             hasMirror              () const;
     const Mirror&    mirror                 () const;
     void             mirror                 (bool);
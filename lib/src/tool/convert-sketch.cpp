@@ -10,6 +10,7 @@
 #include "sketch/conversion.hpp"
 #include "sketch/mesh.hpp"
 #include "sketch/mesh-intersection.hpp"
+#include "sketch/preview.hpp"
 #include "state.hpp"
 #include "tools.hpp"
 #include "view/double-slider.hpp"
@@ -37,6 +38,9 @@ struct ToolConvertSketch::Impl {
   const float        minResolution;
   const float        maxResolution;
   float              resolution;
+  const float        maxBlending;
+  float              blending;
+  bool               adaptive;
   bool               moveToCenter;
   bool               smoothMesh;
 
@@ -45,6 +49,9 @@ struct ToolConvertSketch::Impl {
     , minResolution (0.01f)
     , maxResolution (0.1f)
     , resolution    (s->cache ().get <float> ("resolution", 0.06))
+    , maxBlending   (0.5f)
+    , blending      (s->cache ().get <float> ("blending", 0.0f))
+    , adaptive      (s->cache ().get <bool>  ("adaptive", false))
     , moveToCenter  (s->cache ().get <bool>  ("move-to-center", true))
     , smoothMesh    (s->cache ().get <bool>  ("smooth-mesh", true))
   {
@@ -66,6 +73,27 @@ struct ToolConvertSketch::Impl {
     });
     properties.addStacked (QObject::tr ("Resolution"), resolutionEdit);
 
+    ViewDoubleSlider& blendingEdit = ViewUtil::slider (2, 0.0f, this->blending
+                                                        , this->maxBlending);
+    ViewUtil::connect (blendingEdit, [this] (float b) {
+      this->blending = b;
+      this->self->cache ().set ("blending", b);
+      this->self->state ().scene ().sketchPreview ().blending (b);
+      this->self->state ().scene ().updateSketchPreviews ();
+      this->self->updateGlWidget ();
+    });
+    properties.addStacked (QObject::tr ("Blending"), blendingEdit);
+
+    QCheckBox& adaptiveEdit = ViewUtil::checkBox (QObject::tr ("Adaptive"), this->adaptive);
+    ViewUtil::connect (adaptiveEdit, [this] (bool a) {
+      this->adaptive = a;
+      this->self->cache ().set ("adaptive", a);
+      this->self->state ().scene ().sketchPreview ().adaptive (a);
+      this->self->state ().scene ().updateSketchPreviews ();
+      this->self->updateGlWidget ();
+    });
+    properties.add (adaptiveEdit);
+
     QCheckBox& moveToCenterEdit = ViewUtil::checkBox ( QObject::tr ("Move to center")
                                                      , this->moveToCenter );
     ViewUtil::connect (moveToCenterEdit, [this] (bool m) {
@@ -101,7 +129,9 @@ struct ToolConvertSketch::Impl {
 
         Mesh mesh = SketchConversion::convert ( sMesh
                                               , this->maxResolution + this->minResolution 
-                                                                    - this->resolution );
+                                                                    - this->resolution
+                                              , this->blending
+                                              , this->adaptive );
         WingedMesh& wMesh = this->self->state ().scene ()
                                                 .newWingedMesh ( this->self->state ().config ()
                                                                , mesh );
@@ -0,0 +1,89 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <QCheckBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <limits>
+#include "action/decimate-mesh.hpp"
+#include "cache.hpp"
+#include "mirror.hpp"
+#include "state.hpp"
+#include "tools.hpp"
+#include "view/pointing-event.hpp"
+#include "view/properties.hpp"
+#include "view/tool-tip.hpp"
+#include "view/util.hpp"
+#include "winged/face-intersection.hpp"
+#include "winged/mesh.hpp"
+
+struct ToolDecimateMesh::Impl {
+  ToolDecimateMesh* self;
+  int               numFaces;
+  QLabel&           statsLabel;
+
+  Impl (ToolDecimateMesh* s)
+    : self       (s)
+    , numFaces   (s->cache ().get <int> ("num-faces", 10000))
+    , statsLabel (*new QLabel)
+  {
+    this->setupProperties ();
+    this->setupToolTip    ();
+  }
+
+  void setupProperties () {
+    ViewTwoColumnGrid& properties = this->self->properties ().body ();
+
+    QCheckBox& mirrorEdit = ViewUtil::checkBox ( QObject::tr ("Mirror")
+                                               , this->self->hasMirror () );
+    ViewUtil::connect (mirrorEdit, [this] (bool m) {
+      this->self->mirror (m);
+    });
+    properties.add (mirrorEdit);
+
+    QLineEdit& numFacesEdit = ViewUtil::lineEdit ( 4, this->numFaces
+                                                 , std::numeric_limits <int>::max () );
+    ViewUtil::connectInt (numFacesEdit, [this] (int n) {
+      this->numFaces = n;
+      this->self->cache ().set ("num-faces", n);
+    });
+    properties.add (QObject::tr ("Faces"), numFacesEdit);
+    properties.add (this->statsLabel);
+  }
+
+  void setupToolTip () {
+    ViewToolTip toolTip;
+    toolTip.add (ViewToolTip::MouseEvent::Left, QObject::tr ("Decimate selection"));
+    this->self->showToolTip (toolTip);
+  }
+
+  ToolResponse runReleaseEvent (const ViewPointingEvent& e) {
+    if (e.primaryButton ()) {
+      WingedFaceIntersection intersection;
+      if (this->self->intersectsScene (e, intersection)) {
+        WingedMesh& mesh = intersection.mesh ();
+
+        this->self->snapshotWingedMeshes ();
+
+        const Action::DecimateStats stats = Action::decimateMesh
+          ( mesh, (unsigned int) (this->numFaces)
+          , this->self->hasMirror () ? &this->self->mirror ().plane () : nullptr );
+
+        const float facesPerSecond = stats.collapseTime > 0.0f
+                                   ? float (stats.numRemovedFaces) / stats.collapseTime
+                                   : 0.0f;
+
+        this->statsLabel.setText (QObject::tr ("%1 faces removed in %2s (%3 faces/s)")
+                                    .arg (stats.numRemovedFaces)
+                                    .arg (stats.collapseTime, 0, 'f', 2)
+                                    .arg (facesPerSecond, 0, 'f', 0));
+        return ToolResponse::Redraw;
+      }
+    }
+    return ToolResponse::None;
+  }
+};
+
+DELEGATE_TOOL                   (ToolDecimateMesh)
+DELEGATE_TOOL_RUN_RELEASE_EVENT (ToolDecimateMesh)
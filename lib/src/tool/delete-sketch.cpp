@@ -11,6 +11,7 @@
 #include "sketch/mesh.hpp"
 #include "sketch/node-intersection.hpp"
 #include "sketch/path-intersection.hpp"
+#include "sketch/preview.hpp"
 #include "state.hpp"
 #include "tools.hpp"
 #include "util.hpp"
@@ -125,6 +126,17 @@ struct ToolDeleteSketch::Impl {
     this->self->showToolTip (toolTip);
   }
 
+  void updateOrDelete (SketchMesh& mesh) {
+    Scene& scene = this->self->state ().scene ();
+
+    if (mesh.isEmpty ()) {
+      scene.deleteMesh (mesh);
+    }
+    else {
+      scene.sketchPreview ().update (mesh);
+    }
+  }
+
   ToolResponse runReleaseEvent (const ViewPointingEvent& e) {
     if (e.primaryButton ()) {
       switch (this->mode) {
@@ -143,9 +155,7 @@ struct ToolDeleteSketch::Impl {
             intersection.mesh ().deleteNode ( intersection.node ()
                                             , this->deleteChildren
                                             , this->self->mirrorDimension () );
-            if (intersection.mesh ().isEmpty ()) {
-              this->self->state ().scene ().deleteMesh (intersection.mesh ());
-            }
+            this->updateOrDelete (intersection.mesh ());
           }
           return ToolResponse::Redraw;
         }
@@ -155,9 +165,7 @@ struct ToolDeleteSketch::Impl {
             this->self->snapshotSketchMeshes ();
             intersection.mesh ().deletePath ( intersection.path ()
                                             , this->self->mirrorDimension () );
-            if (intersection.mesh ().isEmpty ()) {
-              this->self->state ().scene ().deleteMesh (intersection.mesh ());
-            }
+            this->updateOrDelete (intersection.mesh ());
           }
           return ToolResponse::Redraw;
         }
@@ -13,6 +13,7 @@
 #include "sketch/bone-intersection.hpp"
 #include "sketch/mesh.hpp"
 #include "sketch/node-intersection.hpp"
+#include "sketch/preview.hpp"
 #include "state.hpp"
 #include "tool/util/movement.hpp"
 #include "tool/util/scaling.hpp"
@@ -32,6 +33,7 @@ struct ToolModifySketch::Impl {
   bool              transformChildren;
   bool              snap;
   QSlider&          snapWidthEdit;
+  SketchPreview&    preview;
 
   Impl (ToolModifySketch* s)
     : self              (s)
@@ -45,6 +47,7 @@ struct ToolModifySketch::Impl {
     , transformChildren (s->cache ().get <bool> ("transform-children", false))
     , snap              (s->cache ().get <bool> ("snap", true))
     , snapWidthEdit     (ViewUtil::slider (1, s->cache ().get <int> ("snap-width", 5), 10))
+    , preview           (s->state ().scene ().sketchPreview ())
   {
     this->self->renderMirror (false);
 
@@ -97,6 +100,17 @@ struct ToolModifySketch::Impl {
       this->self->cache ().set ("snap-width", w);
     });
     properties.addStacked (QObject::tr ("Snap width"), this->snapWidthEdit);
+    properties.add (ViewUtil::horizontalLine ());
+
+    QCheckBox& previewEdit = ViewUtil::checkBox ( QObject::tr ("Preview mesh")
+                                                , this->preview.isEnabled () );
+    ViewUtil::connect (previewEdit, [this] (bool p) {
+      this->preview.enable (p);
+      this->self->cache ().set ("preview", p);
+      this->self->state ().scene ().updateSketchPreviews ();
+      this->self->updateGlWidget ();
+    });
+    properties.add (previewEdit);
   }
 
   void setupToolTip () {
@@ -129,6 +143,7 @@ struct ToolModifySketch::Impl {
         this->mesh->move (*this->node, this->movement.delta ()
                          , this->transformChildren, this->self->mirrorDimension () );
       }
+      this->preview.update (*this->mesh);
       return ToolResponse::Redraw;
     }
     else {
@@ -222,6 +237,9 @@ struct ToolModifySketch::Impl {
           redraw = true;
         }
       }
+      if (this->mesh) {
+        this->preview.update (*this->mesh);
+      }
       this->mesh   = nullptr;
       this->node   = nullptr;
       this->parent = nullptr;
@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include "scene.hpp"
 #include "sketch/mesh.hpp"
+#include "sketch/preview.hpp"
 #include "state.hpp"
 #include "tools.hpp"
 
@@ -19,7 +20,10 @@ struct ToolNewSketch::Impl {
     SketchTree tree;
     tree.emplaceRoot (glm::vec3 (0.0f), 0.1f);
 
-    this->self->state ().scene ().newSketchMesh (this->self->state ().config (), tree);
+    Scene&      scene = this->self->state ().scene ();
+    SketchMesh& mesh  = scene.newSketchMesh (this->self->state ().config (), tree);
+
+    scene.sketchPreview ().update (mesh);
     return ToolResponse::Terminate;
   }
 };
@@ -5,6 +5,7 @@
 #include <QObject>
 #include "render-mode.hpp"
 #include "scene.hpp"
+#include "sketch/preview.hpp"
 #include "state.hpp"
 #include "tools.hpp"
 #include "view/tool-tip.hpp"
@@ -34,6 +35,7 @@ struct ToolRebalanceSketch::Impl {
       if (this->self->intersectsScene (e, intersection)) {
         this->self->snapshotSketchMeshes ();
         intersection.mesh ().rebalance (intersection.node ());
+        this->self->state ().scene ().sketchPreview ().update (intersection.mesh ());
         return ToolResponse::Redraw;
       }
     }
@@ -0,0 +1,88 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <QLabel>
+#include <QLineEdit>
+#include "action/remesh.hpp"
+#include "cache.hpp"
+#include "state.hpp"
+#include "tools.hpp"
+#include "view/pointing-event.hpp"
+#include "view/properties.hpp"
+#include "view/tool-tip.hpp"
+#include "view/util.hpp"
+#include "winged/face-intersection.hpp"
+#include "winged/mesh.hpp"
+
+struct ToolRemeshMesh::Impl {
+  ToolRemeshMesh* self;
+  float           edgeLength;
+  int             numIterations;
+  QLabel&         timesLabel;
+
+  Impl (ToolRemeshMesh* s)
+    : self          (s)
+    , edgeLength    (s->cache ().get <float> ("edge-length", 0.05f))
+    , numIterations (s->cache ().get <int>   ("iterations", 5))
+    , timesLabel    (*new QLabel)
+  {
+    this->self->renderMirror (false);
+
+    this->setupProperties ();
+    this->setupToolTip    ();
+  }
+
+  void setupProperties () {
+    ViewTwoColumnGrid& properties = this->self->properties ().body ();
+
+    QLineEdit& edgeLengthEdit = ViewUtil::lineEdit (0.001f, this->edgeLength, 1.0f, 3);
+    ViewUtil::connectFloat (edgeLengthEdit, [this] (float l) {
+      this->edgeLength = l;
+      this->self->cache ().set ("edge-length", l);
+    });
+    properties.add (QObject::tr ("Edge length"), edgeLengthEdit);
+
+    QLineEdit& iterationsEdit = ViewUtil::lineEdit (1, this->numIterations, 20);
+    ViewUtil::connectInt (iterationsEdit, [this] (int n) {
+      this->numIterations = n;
+      this->self->cache ().set ("iterations", n);
+    });
+    properties.add (QObject::tr ("Iterations"), iterationsEdit);
+    properties.add (this->timesLabel);
+  }
+
+  void setupToolTip () {
+    ViewToolTip toolTip;
+    toolTip.add (ViewToolTip::MouseEvent::Left, QObject::tr ("Remesh selection"));
+    this->self->showToolTip (toolTip);
+  }
+
+  ToolResponse runReleaseEvent (const ViewPointingEvent& e) {
+    if (e.primaryButton ()) {
+      WingedFaceIntersection intersection;
+      if (this->self->intersectsScene (e, intersection)) {
+        WingedMesh& mesh = intersection.mesh ();
+
+        this->self->snapshotWingedMeshes ();
+
+        const Action::RemeshTimes times = Action::remesh ( mesh, this->edgeLength
+                                                         , (unsigned int) (this->numIterations) );
+
+        this->timesLabel.setText (QObject::tr ("%1 faces in %2s (split %3s, collapse %4s, "
+                                               "flip %5s, relax %6s)")
+                                    .arg (mesh.numFaces ())
+                                    .arg (times.total   , 0, 'f', 2)
+                                    .arg (times.split   , 0, 'f', 2)
+                                    .arg (times.collapse, 0, 'f', 2)
+                                    .arg (times.flip    , 0, 'f', 2)
+                                    .arg (times.relax   , 0, 'f', 2));
+        return ToolResponse::Redraw;
+      }
+    }
+    return ToolResponse::None;
+  }
+};
+
+DELEGATE_TOOL                   (ToolRemeshMesh)
+DELEGATE_TOOL_RUN_RELEASE_EVENT (ToolRemeshMesh)
@@ -6,11 +6,14 @@
 #include <QFrame>
 #include <QPushButton>
 #include <QWheelEvent>
+#include <functional>
 #include "action/sculpt.hpp"
+#include "action/subdivide-mesh.hpp"
 #include "cache.hpp"
 #include "config.hpp"
 #include "history.hpp"
 #include "mirror.hpp"
+#include "multi-res.hpp"
 #include "scene.hpp"
 #include "sculpt-brush.hpp"
 #include "state.hpp"
@@ -18,11 +21,13 @@
 #include "tool/util/movement.hpp"
 #include "view/cursor.hpp"
 #include "view/double-slider.hpp"
+#include "view/main-window.hpp"
 #include "view/pointing-event.hpp"
 #include "view/properties.hpp"
 #include "view/tool-tip.hpp"
 #include "view/util.hpp"
 #include "winged/face-intersection.hpp"
+#include "winged/mesh.hpp"
 
 struct ToolSculpt::Impl {
   ToolSculpt*       self;
@@ -30,13 +35,11 @@ struct ToolSculpt::Impl {
   ViewCursor        cursor;
   CacheProxy        commonCache;
   ViewDoubleSlider& radiusEdit;
-  bool              sculpted;
 
   Impl (ToolSculpt* s) 
     : self        (s) 
     , commonCache (this->self->cache ("sculpt"))
     , radiusEdit  (ViewUtil::slider  (2, 0.01f, 0.01f, 2.0f, 3))
-    , sculpted    (false)
   {}
 
   ToolResponse runInitialize () {
@@ -108,6 +111,18 @@ struct ToolSculpt::Impl {
 
     properties.add (mirrorEdit, syncButton);
 
+    QPushButton& coarserButton = ViewUtil::pushButton (QObject::tr ("Coarser level"));
+    ViewUtil::connect (coarserButton, [this] () {
+      this->switchLevels (Action::coarsenMesh);
+    });
+
+    QPushButton& finerButton = ViewUtil::pushButton (QObject::tr ("Finer level"));
+    ViewUtil::connect (finerButton, [this] () {
+      this->switchLevels (Action::refineMesh);
+    });
+
+    properties.add (coarserButton, finerButton);
+
     properties.add (ViewUtil::horizontalLine ());
 
     this->self->runSetupProperties (properties);
@@ -134,10 +149,22 @@ struct ToolSculpt::Impl {
   ToolResponse runPointingEvent (const ViewPointingEvent& e) {
     if (e.releaseEvent ()) {
       if (e.primaryButton ()) {
+        State& state          = this->self->state ();
+        bool   discardsLevels = false;
+
         this->brush.resetPointOfAction ();
 
-        if (this->sculpted == false) {
-          this->self->state ().history ().dropSnapshot ();
+        state.scene ().forEachConstMesh ([&discardsLevels] (const WingedMesh& mesh) {
+          discardsLevels = discardsLevels || mesh.multiRes ().isOutdated (mesh);
+        });
+        state.history ().finishStroke (state.scene ());
+        state.scene   ().deleteEmptyMeshes ();
+
+        if (discardsLevels) {
+          ViewUtil::info (state.mainWindow (), QObject::tr ( "Subdivision levels have been "
+                                                             "discarded, because sculpting "
+                                                             "changed the topology. Undo to "
+                                                             "restore them." ));
         }
       }
       this->cursor.enable ();
@@ -145,13 +172,9 @@ struct ToolSculpt::Impl {
     }
     else {
       if (e.pressEvent () && e.primaryButton ()) {
-        this->self->snapshotWingedMeshes ();
-        this->sculpted = false;
-      }
-
-      if (this->self->runSculptPointingEvent (e)) {
-        this->sculpted = true;
+        this->self->state ().history ().startStroke (this->self->state ().scene ());
       }
+      this->self->runSculptPointingEvent (e);
       return ToolResponse::Redraw;
     }
   }
@@ -175,6 +198,9 @@ struct ToolSculpt::Impl {
 
     this->brush.detailFactor    (config.get <float> ("editor/tool/sculpt/detail-factor"));
     this->brush.stepWidthFactor (config.get <float> ("editor/tool/sculpt/step-width-factor"));
+    this->brush.faceBudget      (config.get <int>   ("editor/tool/sculpt/budget/faces"));
+    this->brush.timeBudget      (config.get <float> ("editor/tool/sculpt/budget/time"));
+    this->brush.domainRings     (config.get <int>   ("editor/tool/sculpt/domain-rings"));
 
     this->cursor.color  (this->self->config ().get <Color> ("editor/tool/sculpt/cursor-color"));
   }
@@ -188,13 +214,40 @@ struct ToolSculpt::Impl {
     }
   }
 
-  void sculpt () {
-    Action::sculpt (this->brush);
-    if (this->self->hasMirror ()) {
-      this->brush.mirror (this->self->mirror ().plane ());
-      Action::sculpt (this->brush);
-      this->brush.mirror (this->self->mirror ().plane ());
+  /** `switchLevels (f)` applies `f` (`Action::coarsenMesh` or `Action::refineMesh`) to
+   * all meshes of the scene. */
+  void switchLevels (const std::function <bool (WingedMesh&)>& f) {
+    State& state        = this->self->state ();
+    bool   hasSwitched  = false;
+    bool   hasDiscarded = false;
+
+    this->self->snapshotWingedMeshes ();
+
+    state.scene ().forEachMesh ([&f, &hasSwitched, &hasDiscarded] (WingedMesh& mesh) {
+      const bool hasLevels = mesh.multiRes ().numLevels () > 1;
+
+      if (f (mesh)) {
+        hasSwitched = true;
+      }
+      else if (hasLevels && mesh.multiRes ().numLevels () == 1) {
+        hasDiscarded = true;
+      }
+    });
+
+    if (hasSwitched == false && hasDiscarded == false) {
+      state.history ().dropSnapshot (state.scene ());
+    }
+    if (hasDiscarded) {
+      ViewUtil::info (state.mainWindow (), QObject::tr ( "Subdivision levels have been "
+                                                         "discarded, because the topology "
+                                                         "has changed." ));
     }
+    this->self->updateGlWidget ();
+  }
+
+  void sculpt () {
+    Action::sculpt ( this->brush
+                   , this->self->hasMirror () ? &this->self->mirror ().plane () : nullptr );
   }
 
   void updateCursorByIntersection (const ViewPointingEvent& e) {
@@ -209,7 +262,7 @@ struct ToolSculpt::Impl {
     }
   }
 
-  bool updateBrushAndCursorByIntersection (const ViewPointingEvent& e, bool useRecentOctree) {
+  bool updateBrushAndCursorByIntersection (const ViewPointingEvent& e, bool useOriginal) {
     WingedFaceIntersection intersection;
 
     if (this->self->intersectsScene (e, intersection)) {
@@ -219,11 +272,11 @@ struct ToolSculpt::Impl {
       if (e.primaryButton ()) {
         this->brush.mesh (&intersection.mesh ());
 
-        if (useRecentOctree) {
-          Intersection octreeIntersection;
-          if (this->self->intersectsRecentOctree (e, octreeIntersection)) {
-            return this->brush.updatePointOfAction ( octreeIntersection.position ()
-                                                   , octreeIntersection.normal () );
+        if (useOriginal) {
+          Intersection originalIntersection;
+          if (this->self->intersectsOriginal (e, originalIntersection)) {
+            return this->brush.updatePointOfAction ( originalIntersection.position ()
+                                                   , originalIntersection.normal () );
           }
           else {
             return this->brush.updatePointOfAction ( intersection.position ()
@@ -245,10 +298,10 @@ struct ToolSculpt::Impl {
     }
   }
 
-  bool carvelikeStroke ( const ViewPointingEvent& e, bool useRecentOctree
+  bool carvelikeStroke ( const ViewPointingEvent& e, bool useOriginal
                        , const std::function <void ()>* toggle )
   {
-    if (this->updateBrushAndCursorByIntersection (e, useRecentOctree)) {
+    if (this->updateBrushAndCursorByIntersection (e, useOriginal)) {
       const float defaultIntesity = this->brush.intensity ();
 
       this->brush.intensity (defaultIntesity * e.intensity ());
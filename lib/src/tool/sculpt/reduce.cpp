@@ -3,9 +3,7 @@
  * Use and redistribute under the terms of the GNU General Public License
  */
 #include "cache.hpp"
-#include "scene.hpp"
 #include "sculpt-brush.hpp"
-#include "state.hpp"
 #include "tools.hpp"
 #include "view/double-slider.hpp"
 #include "view/properties.hpp"
@@ -40,9 +38,7 @@ struct ToolSculptReduce::Impl {
   }
 
   bool runSculptPointingEvent (const ViewPointingEvent& e) {
-    const bool result = this->self->carvelikeStroke (e, false);
-    this->self->state ().scene ().deleteEmptyMeshes ();
-    return result;
+    return this->self->carvelikeStroke (e, false);
   }
 };
 
@@ -19,6 +19,7 @@
 #include "sketch/mesh-intersection.hpp"
 #include "sketch/path.hpp"
 #include "sketch/path-intersection.hpp"
+#include "sketch/preview.hpp"
 #include "state.hpp"
 #include "tools.hpp"
 #include "util.hpp"
@@ -275,6 +276,9 @@ struct ToolSketchSpheres::Impl {
   }
 
   ToolResponse runReleaseEvent (const ViewPointingEvent&) {
+    if (this->mesh) {
+      this->self->state ().scene ().sketchPreview ().update (*this->mesh);
+    }
     this->mesh = nullptr;
     return ToolResponse::None;
   }
@@ -0,0 +1,139 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <QAbstractButton>
+#include <QButtonGroup>
+#include <QLineEdit>
+#include <glm/glm.hpp>
+#include "action/subdivide-mesh.hpp"
+#include "cache.hpp"
+#include "state.hpp"
+#include "tools.hpp"
+#include "util.hpp"
+#include "view/pointing-event.hpp"
+#include "view/properties.hpp"
+#include "view/tool-tip.hpp"
+#include "view/util.hpp"
+#include "winged/face-intersection.hpp"
+#include "winged/mesh.hpp"
+
+namespace {
+  enum class Mode { Butterfly, Loop, Adaptive };
+
+  int toInt (Mode mode) {
+    switch (mode) {
+      case Mode::Butterfly: return 0;
+      case Mode::Loop:      return 1;
+      case Mode::Adaptive:  return 2;
+      default: DILAY_IMPOSSIBLE
+    }
+  }
+
+  Mode toMode (int i) {
+    switch (i) {
+      case 0:  return Mode::Butterfly;
+      case 1:  return Mode::Loop;
+      case 2:  return Mode::Adaptive;
+      default: DILAY_IMPOSSIBLE
+    }
+  }
+}
+
+struct ToolSubdivideMesh::Impl {
+  ToolSubdivideMesh* self;
+  Mode               mode;
+  float              maxLength;
+  float              maxAngle;
+  float              minLength;
+
+  Impl (ToolSubdivideMesh* s)
+    : self      (s)
+    , mode      (toMode (s->cache ().get <int> ("mode", toInt (Mode::Butterfly))))
+    , maxLength (s->cache ().get <float> ("max-length", 0.1f))
+    , maxAngle  (s->cache ().get <float> ("max-angle", 30.0f))
+    , minLength (s->cache ().get <float> ("min-length", 0.02f))
+  {
+    this->self->renderMirror (false);
+
+    this->setupProperties ();
+    this->setupToolTip    ();
+  }
+
+  void setupProperties () {
+    ViewTwoColumnGrid& properties = this->self->properties ().body ();
+
+    QLineEdit& maxLengthEdit = ViewUtil::lineEdit (0.001f, this->maxLength, 1.0f, 3);
+    ViewUtil::connectFloat (maxLengthEdit, [this] (float l) {
+      this->maxLength = l;
+      this->self->cache ().set ("max-length", l);
+    });
+
+    QLineEdit& maxAngleEdit = ViewUtil::lineEdit (1.0f, this->maxAngle, 180.0f, 1);
+    ViewUtil::connectFloat (maxAngleEdit, [this] (float a) {
+      this->maxAngle = a;
+      this->self->cache ().set ("max-angle", a);
+    });
+
+    QLineEdit& minLengthEdit = ViewUtil::lineEdit (0.001f, this->minLength, 1.0f, 3);
+    ViewUtil::connectFloat (minLengthEdit, [this] (float l) {
+      this->minLength = l;
+      this->self->cache ().set ("min-length", l);
+    });
+
+    QButtonGroup& modeEdit = *new QButtonGroup;
+    properties.add ( modeEdit , { QObject::tr ("Butterfly")
+                                , QObject::tr ("Loop")
+                                , QObject::tr ("Adaptive")
+                                } );
+    ViewUtil::connect (modeEdit, [this, &maxLengthEdit, &maxAngleEdit, &minLengthEdit] (int id) {
+      this->mode = toMode (id);
+      this->self->cache ().set ("mode", id);
+
+      maxLengthEdit.setEnabled (this->mode == Mode::Adaptive);
+      maxAngleEdit .setEnabled (this->mode == Mode::Adaptive);
+      minLengthEdit.setEnabled (this->mode == Mode::Adaptive);
+    });
+    properties.add (QObject::tr ("Max. edge length"), maxLengthEdit);
+    properties.add (QObject::tr ("Max. angle"), maxAngleEdit);
+    properties.add (QObject::tr ("Min. edge length"), minLengthEdit);
+
+    modeEdit.button (toInt (this->mode))->click ();
+  }
+
+  void setupToolTip () {
+    ViewToolTip toolTip;
+    toolTip.add (ViewToolTip::MouseEvent::Left, QObject::tr ("Subdivide selection"));
+    this->self->showToolTip (toolTip);
+  }
+
+  ToolResponse runReleaseEvent (const ViewPointingEvent& e) {
+    if (e.primaryButton ()) {
+      WingedFaceIntersection intersection;
+      if (this->self->intersectsScene (e, intersection)) {
+        WingedMesh& mesh = intersection.mesh ();
+
+        this->self->snapshotWingedMeshes ();
+
+        switch (this->mode) {
+          case Mode::Butterfly:
+            Action::subdivideMesh (mesh, Action::SubdivisionScheme::Butterfly);
+            break;
+          case Mode::Loop:
+            Action::subdivideMesh (mesh, Action::SubdivisionScheme::Loop);
+            break;
+          case Mode::Adaptive:
+            Action::subdivideMeshAdaptively ( mesh, this->maxLength
+                                            , glm::radians (this->maxAngle)
+                                            , this->minLength );
+            break;
+        }
+        return ToolResponse::Redraw;
+      }
+    }
+    return ToolResponse::None;
+  }
+};
+
+DELEGATE_TOOL                   (ToolSubdivideMesh)
+DELEGATE_TOOL_RUN_RELEASE_EVENT (ToolSubdivideMesh)
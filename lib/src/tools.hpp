@@ -16,6 +16,12 @@ DECLARE_TOOL (ToolDeleteMesh, "delete-mesh", DECLARE_TOOL_RUN_RELEASE_EVENT)
 
 DECLARE_TOOL (ToolNewMesh, "new-mesh", DECLARE_TOOL_RUN_INITIALIZE)
 
+DECLARE_TOOL (ToolDecimateMesh, "decimate-mesh", DECLARE_TOOL_RUN_RELEASE_EVENT)
+
+DECLARE_TOOL (ToolSubdivideMesh, "subdivide-mesh", DECLARE_TOOL_RUN_RELEASE_EVENT)
+
+DECLARE_TOOL (ToolRemeshMesh, "remesh-mesh", DECLARE_TOOL_RUN_RELEASE_EVENT)
+
 DECLARE_TOOL_SCULPT (ToolSculptCarve  , "sculpt/carve")
 DECLARE_TOOL_SCULPT (ToolSculptDrag   , "sculpt/drag")
 DECLARE_TOOL_SCULPT (ToolSculptGrab   , "sculpt/grab")
@@ -9,6 +9,7 @@
 #include "../util.hpp"
 #include "color.hpp"
 #include "config.hpp"
+#include "parallel-util.hpp"
 #include "state.hpp"
 #include "view/color-button.hpp"
 #include "view/configuration.hpp"
@@ -139,6 +140,12 @@ namespace {
                    , QObject::tr ("Detail factor"), Util::epsilon (), 1.0f );
     addFloatEdit   ( glWidget, *gridSculpt, "editor/tool/sculpt/step-width-factor"
                    , QObject::tr ("Step width factor"), Util::epsilon (), 1.0f );
+    addIntEdit     ( glWidget, *gridSculpt, "editor/tool/sculpt/budget/faces"
+                   , QObject::tr ("Max. new faces per step"), 1, std::numeric_limits <int>::max () );
+    addFloatEdit   ( glWidget, *gridSculpt, "editor/tool/sculpt/budget/time"
+                   , QObject::tr ("Max. seconds per step"), Util::epsilon (), 10.0f );
+    addIntEdit     ( glWidget, *gridSculpt, "editor/tool/sculpt/domain-rings"
+                   , QObject::tr ("Rings around domain"), 0, 10 );
     addColorButton ( glWidget, *gridSculpt, "editor/tool/sculpt/cursor-color"
                    , QObject::tr ("Cursor color") );
     addFloatEdit   ( glWidget, *gridSculpt, "editor/tool/sculpt/mirror/width"
@@ -166,6 +173,9 @@ namespace {
 
     addIntEdit ( glWidget, *grid, "editor/undo-depth", QObject::tr ("Undo depth")
                , 1, std::numeric_limits <int>::max () );
+    addIntEdit ( glWidget, *grid, "editor/num-threads"
+               , QObject::tr ("Number of threads (0: automatic)")
+               , 0, int (ParallelUtil::maxNumThreads ()) );
     addIntEdit ( glWidget, *grid, "window/initial-width", QObject::tr ("Initial window width")
                , 1, std::numeric_limits <int>::max () );
     addIntEdit ( glWidget, *grid, "window/initial-height", QObject::tr ("Initial window height")
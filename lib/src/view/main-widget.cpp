@@ -59,6 +59,9 @@ struct ViewMainWidget :: Impl {
     this->addToolButton <ToolNewMesh>       (toolPaneLayout, QObject::tr ("New mesh"));
     this->addToolButton <ToolDeleteMesh>    (toolPaneLayout, QObject::tr ("Delete mesh"));
     this->addToolButton <ToolMoveMesh>      (toolPaneLayout, QObject::tr ("Move mesh"));
+    this->addToolButton <ToolDecimateMesh>  (toolPaneLayout, QObject::tr ("Decimate mesh"));
+    this->addToolButton <ToolSubdivideMesh> (toolPaneLayout, QObject::tr ("Subdivide mesh"));
+    this->addToolButton <ToolRemeshMesh>    (toolPaneLayout, QObject::tr ("Remesh mesh"));
     toolPaneLayout->addWidget (&ViewUtil::horizontalLine ());
     this->addToolButton <ToolSculptCarve>   (toolPaneLayout, QObject::tr ("Carve"));
     this->addToolButton <ToolSculptCrease>  (toolPaneLayout, QObject::tr ("Crease"));
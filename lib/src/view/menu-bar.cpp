@@ -77,8 +77,8 @@ void ViewMenuBar :: setup (ViewMainWindow& mainWindow, ViewGlWidget& glWidget) {
     if (fileName.empty () == false) {
       if (scene.isEmpty () == false) {
         if (ViewUtil::question (mainWindow, QObject::tr ("Replace existent scene?"))) {
+          glWidget.state ().history ().reset (scene);
           scene.reset ();
-          glWidget.state ().history ().reset ();
         }
         else {
           glWidget.state ().history ().snapshotAll (scene);
@@ -0,0 +1,162 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <glm/glm.hpp>
+#include <mutex>
+#include <unordered_map>
+#include "../mesh.hpp"
+#include "../util.hpp"
+#include "winged/log.hpp"
+
+namespace {
+  struct VertexSlot {
+    bool      isLive;
+    bool      isMasked;
+    glm::vec3 position;
+  };
+
+  struct FaceSlot {
+    bool         isLive;
+    unsigned int index1;
+    unsigned int index2;
+    unsigned int index3;
+  };
+}
+
+struct WingedLog::Impl {
+  std::unordered_map <unsigned int, VertexSlot> vertices;
+  std::unordered_map <unsigned int, FaceSlot>   faces;
+  std::mutex                                    mutex;
+
+  Impl () {}
+
+  Impl (Impl&& other)
+    : vertices (std::move (other.vertices))
+    , faces    (std::move (other.faces))
+  {}
+
+  void logVertex (unsigned int index, bool isLive, bool isMasked, const glm::vec3& position) {
+    std::lock_guard <std::mutex> lock (this->mutex);
+    this->vertices.emplace (index, VertexSlot {isLive, isMasked, position});
+  }
+
+  void logFace ( unsigned int index, bool isLive
+               , unsigned int index1, unsigned int index2, unsigned int index3 )
+  {
+    std::lock_guard <std::mutex> lock (this->mutex);
+    this->faces.emplace (index, FaceSlot {isLive, index1, index2, index3});
+  }
+
+  bool isEmpty () const {
+    return this->vertices.empty () && this->faces.empty ();
+  }
+
+  void reset () {
+    this->vertices.clear ();
+    this->faces   .clear ();
+  }
+
+  void apply ( Mesh& mesh, std::vector <bool>& liveVertices, std::vector <bool>& liveFaces
+             , std::vector <bool>& mask )
+  {
+    assert (liveVertices.size () == mesh.numVertices ());
+    assert (liveFaces.size () * 3 == mesh.numIndices ());
+
+    for (auto& v : this->vertices) {
+      const unsigned int i = v.first;
+
+      while (i >= mesh.numVertices ()) {
+        mesh.addVertex (glm::vec3 (0.0f));
+        liveVertices.push_back (false);
+      }
+      const VertexSlot current = { liveVertices [i]
+                                 , i < mask.size () && mask [i]
+                                 , mesh.vertex (i) };
+
+      if (v.second.isMasked && i >= mask.size ()) {
+        mask.resize (mesh.numVertices (), false);
+      }
+      if (i < mask.size ()) {
+        mask [i] = v.second.isMasked;
+      }
+      liveVertices [i] = v.second.isLive;
+      mesh.setVertex (i, v.second.position);
+      v.second = current;
+    }
+
+    for (auto& f : this->faces) {
+      const unsigned int i = f.first;
+
+      while (i >= liveFaces.size ()) {
+        mesh.addIndex (Util::invalidIndex ());
+        mesh.addIndex (Util::invalidIndex ());
+        mesh.addIndex (Util::invalidIndex ());
+        liveFaces.push_back (false);
+      }
+      const FaceSlot current = { liveFaces [i]
+                               , mesh.index ((3 * i) + 0)
+                               , mesh.index ((3 * i) + 1)
+                               , mesh.index ((3 * i) + 2) };
+
+      liveFaces [i] = f.second.isLive;
+      mesh.setIndex ((3 * i) + 0, f.second.index1);
+      mesh.setIndex ((3 * i) + 1, f.second.index2);
+      mesh.setIndex ((3 * i) + 2, f.second.index3);
+      f.second = current;
+    }
+  }
+
+  bool position (unsigned int index, glm::vec3& position) const {
+    auto it = this->vertices.find (index);
+
+    if (it != this->vertices.end () && it->second.isLive) {
+      position = it->second.position;
+      return true;
+    }
+    return false;
+  }
+
+  bool indices ( unsigned int index
+               , unsigned int& index1, unsigned int& index2, unsigned int& index3 ) const
+  {
+    auto it = this->faces.find (index);
+
+    if (it != this->faces.end () && it->second.isLive) {
+      index1 = it->second.index1;
+      index2 = it->second.index2;
+      index3 = it->second.index3;
+      return true;
+    }
+    return false;
+  }
+
+  void forEachVertex (const std::function <void (unsigned int, bool)>& f) const {
+    for (const auto& v : this->vertices) {
+      f (v.first, v.second.isLive);
+    }
+  }
+
+  void forEachFace (const std::function <void ( unsigned int, bool
+                                              , unsigned int, unsigned int, unsigned int )>& f) const
+  {
+    for (const auto& s : this->faces) {
+      f (s.first, s.second.isLive, s.second.index1, s.second.index2, s.second.index3);
+    }
+  }
+};
+
+DELEGATE_BIG3   (WingedLog)
+DELEGATE4       (void, WingedLog, logVertex, unsigned int, bool, bool, const glm::vec3&)
+DELEGATE5       (void, WingedLog, logFace, unsigned int, bool, unsigned int, unsigned int, unsigned int)
+DELEGATE_CONST  (bool, WingedLog, isEmpty)
+DELEGATE        (void, WingedLog, reset)
+DELEGATE4       (void, WingedLog, apply, Mesh&, std::vector <bool>&, std::vector <bool>&, std::vector <bool>&)
+DELEGATE2_CONST (bool, WingedLog, position, unsigned int, glm::vec3&)
+DELEGATE4_CONST (bool, WingedLog, indices, unsigned int, unsigned int&, unsigned int&, unsigned int&)
+DELEGATE1_CONST (void, WingedLog, forEachVertex, const std::function <void (unsigned int, bool)>&)
+DELEGATE1_CONST (void, WingedLog, forEachFace, const std::function <void ( unsigned int, bool
+                                                                         , unsigned int, unsigned int
+                                                                         , unsigned int )>&)
+
+std::mutex& WingedLog :: mutex () { return this->impl->mutex; }
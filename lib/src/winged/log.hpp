@@ -0,0 +1,54 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_WINGED_LOG
+#define DILAY_WINGED_LOG
+
+#include <functional>
+#include <glm/fwd.hpp>
+#include <mutex>
+#include <vector>
+#include "macro.hpp"
+
+class Mesh;
+
+/** A `WingedLog` records the previous state of each vertex and face slot of a
+ * winged mesh the first time the slot is touched.
+ * The state of a vertex slot includes its mask flag.
+ * Recording is thread-safe. Lookups are not synchronized with recording. */
+class WingedLog {
+  public:
+    DECLARE_BIG3 (WingedLog)
+
+    void logVertex (unsigned int, bool, bool, const glm::vec3&);
+    void logFace   (unsigned int, bool, unsigned int, unsigned int, unsigned int);
+    bool isEmpty   () const;
+    void reset     ();
+
+    /** `apply (m,v,f,mask)` restores the recorded slots of mesh `m`, where `v` (resp. `f`)
+     * flags the live vertex (resp. face) slots of `m` and `mask` flags its masked vertices.
+     * The replaced state is recorded instead, i.e. a second `apply` reverts the first one. */
+    void apply     (Mesh&, std::vector <bool>&, std::vector <bool>&, std::vector <bool>&);
+
+    /** `position (i,p)` sets `p` to the recorded position of vertex `i`, if vertex `i`
+     * has been recorded and was live. */
+    bool position      (unsigned int, glm::vec3&) const;
+
+    /** `indices (i,i1,i2,i3)` sets `i1`, `i2` and `i3` to the recorded indices of face `i`,
+     * if face `i` has been recorded and was live. */
+    bool indices       (unsigned int, unsigned int&, unsigned int&, unsigned int&) const;
+
+    /** `mutex ()` guards the recording. Bookkeeping and lookups that may run concurrently
+     * with recording must hold it, but must not record while holding it. */
+    std::mutex& mutex  ();
+
+    void forEachVertex (const std::function <void (unsigned int, bool)>&) const;
+    void forEachFace   (const std::function <void ( unsigned int, bool
+                                                  , unsigned int, unsigned int, unsigned int )>&) const;
+
+  private:
+    IMPLEMENTATION
+};
+
+#endif
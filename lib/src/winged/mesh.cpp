@@ -2,20 +2,29 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
 #include "../mesh.hpp"
 #include "../util.hpp"
 #include "action/finalize.hpp"
+#include "action/subdivide-mesh.hpp"
+#include "adjacent-iterator.hpp"
 #include "affected-faces.hpp"
 #include "edge-map.hpp"
 #include "hash.hpp"
 #include "index-octree.hpp"
 #include "intersection.hpp"
 #include "mesh-util.hpp"
+#include "multi-res.hpp"
+#include "parallel-util.hpp"
 #include "primitive/ray.hpp"
 #include "primitive/triangle.hpp"
+#include "render-mode.hpp"
 #include "winged/edge.hpp"
 #include "winged/face.hpp"
 #include "winged/face-intersection.hpp"
+#include "winged/log.hpp"
 #include "winged/mesh.hpp"
 #include "winged/vertex.hpp"
 
@@ -27,10 +36,42 @@ struct WingedMesh::Impl {
   IntrusiveIndexedList <WingedEdge>   edges;
   IntrusiveIndexedList <WingedFace>   faces;
   IndexOctree                         octree;
+  MultiRes                            multiRes;
+  WingedLog*                          log;
+
+  // finest multi-resolution level that is rendered instead of a coarser current level:
+  // it is updated lazily by `render` after data has been buffered, but not while logging
+  Mesh                                finestLevel;
+  bool                                hasFinestLevel;
+  bool                                updateFinestLevel;
+
+  // one bit per vertex slot: masked vertices are protected from sculpting
+  std::vector <bool>                  vertexMask;
+  unsigned int                        numMaskedVertices;
+
+  // scratch buffers of `writeNormals`
+  std::vector <unsigned int>          faceSlots;
+  FacePtrVec                          slotFaces;
+  std::vector <glm::vec3>             slotNormals;
+
+  // faces whose triangle may have been changed since the current log has been started,
+  // i.e. faces of logged slots and faces around logged vertices, are flagged by
+  // `isOriginalFace` and kept in `originalOctree` by their recorded triangle.
+  // Faces around `newOriginalVertices` are added by the next `intersectsOriginal`.
+  // Slots may be logged in parallel, e.g. by `writeAllIndices`, so this bookkeeping is
+  // guarded by the log's mutex.
+  IndexOctree                         originalOctree;
+  std::vector <bool>                  isOriginalFace;
+  std::vector <bool>                  isOriginalVertex;
+  std::vector <unsigned int>          newOriginalVertices;
 
   Impl (WingedMesh* s, unsigned int i) 
     :  self   (s)
     , _index  (i)
+    ,  log    (nullptr)
+    , hasFinestLevel    (false)
+    , updateFinestLevel (false)
+    , numMaskedVertices (0)
   {}
 
   bool operator== (const WingedMesh& other) const {
@@ -67,6 +108,9 @@ struct WingedMesh::Impl {
   WingedVertex& addVertex (const glm::vec3& pos) {
     WingedVertex& vertex = this->vertices.emplaceBack ();
 
+    this->logVertex (vertex.index (), false);
+    this->mask      (vertex.index (), false);
+
     if (vertex.index () == this->mesh.numVertices ()) {
       this->mesh.addVertex (pos);
     }
@@ -93,6 +137,7 @@ struct WingedMesh::Impl {
   WingedFace& addFace (const PrimTriangle& geometry) {
     WingedFace& face = this->faces.emplaceBack ();
 
+    this->logFace         (face.index (), false);
     this->addFaceToOctree (face, geometry);
 
     if (3 * face.index () == this->mesh.numIndices ()) {
@@ -104,11 +149,17 @@ struct WingedMesh::Impl {
   }
 
   void setIndex (unsigned int index, unsigned int vertexIndex) { 
+    this->logFace (index / 3, true);
     return this->mesh.setIndex (index, vertexIndex); 
   }
 
   void setVertex (unsigned int index, const glm::vec3& v) {
     assert (this->vertices.isFreeSLOW (index) == false);
+    this->logVertex (index, true);
+    return this->mesh.setVertex (index,v);
+  }
+
+  void setLoggedVertex (unsigned int index, const glm::vec3& v) {
     return this->mesh.setVertex (index,v);
   }
 
@@ -122,14 +173,113 @@ struct WingedMesh::Impl {
   }
 
   void deleteFace (WingedFace& face) { 
+    this->logFace              (face.index (), true);
     this->octree.deleteElement (face.index ()); 
-    this->faces.deleteElement (face);
+    this->faces.deleteElement  (face);
   }
 
   void deleteVertex (WingedVertex& vertex) {
+    this->logVertex              (vertex.index (), true);
+    this->mask                   (vertex.index (), false);
     this->vertices.deleteElement (vertex);
   }
 
+  bool isMasked (unsigned int index) const {
+    return index < this->vertexMask.size () && this->vertexMask [index];
+  }
+
+  bool isMasked (const WingedFace& face) const {
+    return this->numMaskedVertices > 0
+        && ( this->isMasked (face.vertexRef (0).index ())
+          || this->isMasked (face.vertexRef (1).index ())
+          || this->isMasked (face.vertexRef (2).index ()) );
+  }
+
+  void mask (unsigned int index, bool value) {
+    if (index >= this->vertexMask.size ()) {
+      if (value == false) {
+        return;
+      }
+      assert (index < this->mesh.numVertices ());
+      this->vertexMask.resize (this->mesh.numVertices (), false);
+    }
+    if (this->vertexMask [index] != value) {
+      this->vertexMask [index] = value;
+
+      if (value) {
+        this->numMaskedVertices++;
+      }
+      else {
+        this->numMaskedVertices--;
+      }
+    }
+  }
+
+  const std::vector <bool>& mask () const {
+    return this->vertexMask;
+  }
+
+  void mask (const std::vector <bool>& m) {
+    this->vertexMask        = m;
+    this->numMaskedVertices = std::count (m.begin (), m.end (), true);
+  }
+
+  bool hasMask () const {
+    return this->numMaskedVertices > 0;
+  }
+
+  void logVertex (unsigned int index, bool isLive) {
+    if (this->log) {
+      this->log->logVertex ( index, isLive, this->isMasked (index)
+                           , index < this->mesh.numVertices () ? this->mesh.vertex (index)
+                                                               : glm::vec3 (0.0f) );
+
+      std::lock_guard <std::mutex> lock (this->log->mutex ());
+
+      if (index >= this->isOriginalVertex.size ()) {
+        this->isOriginalVertex.resize (index + 1, false);
+      }
+      if (this->isOriginalVertex [index] == false) {
+        this->isOriginalVertex [index] = true;
+
+        if (isLive) {
+          this->newOriginalVertices.push_back (index);
+        }
+      }
+    }
+  }
+
+  void logVertex (unsigned int index) {
+    assert (this->vertices.isFreeSLOW (index) == false);
+    this->logVertex (index, true);
+  }
+
+  void logFace (unsigned int index, bool isLive) {
+    if (this->log) {
+      {
+        std::lock_guard <std::mutex> lock (this->log->mutex ());
+
+        if (isLive) {
+          this->addOriginalFace (index);
+        }
+        else {
+          this->flagOriginalFace (index);
+        }
+      }
+
+      if ((3 * index) + 2 < this->mesh.numIndices ()) {
+        this->log->logFace ( index, isLive
+                           , this->mesh.index ((3 * index) + 0)
+                           , this->mesh.index ((3 * index) + 1)
+                           , this->mesh.index ((3 * index) + 2) );
+      }
+      else {
+        this->log->logFace ( index, isLive
+                           , Util::invalidIndex (), Util::invalidIndex (), Util::invalidIndex () );
+      }
+    }
+  }
+
   void realignFace (const WingedFace& face, const PrimTriangle& geometry) {
     this->octree.deleteElement (face.index ());
     this->addFaceToOctree (face, geometry);
@@ -139,10 +289,40 @@ struct WingedMesh::Impl {
     this->realignFace (face.index (), face.triangle (*this->self));
   }
 
+  /** `realignAllFaces ()` rebuilds the octree, which is faster than realigning each face.
+   * The bounds of all faces are computed in parallel, where degenerated faces get a
+   * negative extent. */
   void realignAllFaces () {
-    this->forEachFace ([this] (WingedFace& f) { 
-      this->realignFace (f);
+    const FacePtrVec        faces = this->allFaces ();
+    std::vector <glm::vec3> centers (faces.size ());
+    std::vector <float>     extents (faces.size ());
+
+    if (faces.empty ()) {
+      return;
+    }
+    ParallelUtil::forEach (faces.size (), [this, &faces, &centers, &extents] (unsigned int i) {
+      const PrimTriangle geometry = faces [i]->triangle (*this->self);
+
+      if (geometry.isDegenerated ()) {
+        extents [i] = -1.0f;
+      }
+      else {
+        centers [i] = geometry.center       ();
+        extents [i] = geometry.maxDimExtent ();
+      }
     });
+
+    this->octree.reset ();
+    this->setupOctree  ();
+
+    for (unsigned int i = 0; i < faces.size (); i++) {
+      if (extents [i] < 0.0f) {
+        this->octree.addDegeneratedElement (faces [i]->index ());
+      }
+      else {
+        this->octree.addElement (faces [i]->index (), centers [i], extents [i]);
+      }
+    }
   }
 
   void sanitize () {
@@ -221,7 +401,10 @@ struct WingedMesh::Impl {
     return prunedMesh;
   }
 
-  void fromMesh (const Mesh& mesh, const PrimPlane* mirror) {
+  /** `buildTopology (v,f)` builds vertices, edges, faces and the octree of `mesh`,
+   * where `v` (resp. `f`) flags the live vertex (resp. face) slots.
+   * Slots that are not live are freed afterwards, such that all slots keep their index. */
+  void buildTopology (const std::vector <bool>& liveVertices, const std::vector <bool>& liveFaces) {
     EdgeMap <WingedEdge*> edgeMap;
 
     /** `findOrAddEdge (m,i1,i2,f)` searches an edge between vertices 
@@ -261,21 +444,12 @@ struct WingedMesh::Impl {
       }
     };
 
-    // mesh
-    this->reset ();
-
-    this->mesh = bool (mirror) ? MeshUtil::mirror (mesh, *mirror)
-                               : mesh;
+    assert (this->log == nullptr);
+    assert (liveVertices.size () == this->mesh.numVertices ());
+    assert (liveFaces.size () * 3 == this->mesh.numIndices ());
 
     // octree
-    glm::vec3 minVertex, maxVertex;
-    this->mesh.minMax (minVertex, maxVertex);
-
-    const glm::vec3 center = (maxVertex + minVertex) * glm::vec3 (0.5f);
-    const glm::vec3 delta  =  maxVertex - minVertex;
-    const float     width  = glm::max (glm::max (delta.x, delta.y), delta.z);
-
-    this->setupOctreeRoot (center, width);
+    this->setupOctree ();
 
     // vertices
     for (unsigned int i = 0; i < this->mesh.numVertices (); i++) {
@@ -288,6 +462,10 @@ struct WingedMesh::Impl {
     edgeMap.resize (this->mesh.numVertices ());
 
     for (unsigned int i = 0; i < this->mesh.numIndices (); i += 3) {
+      if (liveFaces [i / 3] == false) {
+        this->faces.emplaceBack ();
+        continue;
+      }
       unsigned int index1 = this->mesh.index (i + 0);
       unsigned int index2 = this->mesh.index (i + 1);
       unsigned int index3 = this->mesh.index (i + 2);
@@ -309,6 +487,55 @@ struct WingedMesh::Impl {
       e3.successor   (f, &e1);
     }
 
+    // free slots
+    for (unsigned int i = 0; i < liveFaces.size (); i++) {
+      if (liveFaces [i] == false) {
+        this->faces.deleteElement (this->self->faceRef (i));
+      }
+    }
+    for (unsigned int i = 0; i < liveVertices.size (); i++) {
+      if (liveVertices [i] == false) {
+        this->vertices.deleteElement (this->self->vertexRef (i));
+      }
+    }
+  }
+
+  std::vector <bool> makePrunedMask () const {
+    std::vector <bool> prunedMask;
+
+    if (this->hasMask ()) {
+      if (this->vertices.hasFreeIndices () || this->faces.hasFreeIndices ()) {
+        prunedMask.reserve (this->numVertices ());
+
+        this->forEachConstVertex ([this, &prunedMask] (const WingedVertex& v) {
+          prunedMask.push_back (this->isMasked (v.index ()));
+        });
+      }
+      else {
+        prunedMask = this->vertexMask;
+        prunedMask.resize (this->mesh.numVertices (), false);
+      }
+    }
+    return prunedMask;
+  }
+
+  void fromMesh (const Mesh& mesh, const PrimPlane* mirror) {
+    this->fromMesh (mesh, std::vector <bool> (), mirror);
+  }
+
+  /** `fromMesh (m,mask,p)` masks the vertices of `m` that are flagged by `mask`. */
+  void fromMesh (const Mesh& mesh, const std::vector <bool>& mask, const PrimPlane* mirror) {
+    std::vector <bool> newMask (mask);
+
+    this->reset ();
+
+    this->mesh = bool (mirror) ? MeshUtil::mirror (mesh, *mirror, &newMask)
+                               : mesh;
+    this->mask (newMask);
+
+    this->buildTopology ( std::vector <bool> (this->mesh.numVertices (), true)
+                        , std::vector <bool> (this->mesh.numIndices () / 3, true) );
+
     if (this->octree.numDegeneratedElements () > 0) {
       Action::collapseDegeneratedFaces (*this->self);
     }
@@ -316,16 +543,337 @@ struct WingedMesh::Impl {
     this->bufferData      ();
   }
 
+  /** `fromMesh (m,v,f)` keeps the slots of `m`: degenerated faces are not collapsed. */
+  void fromMesh ( const Mesh& mesh, const std::vector <bool>& liveVertices
+                , const std::vector <bool>& liveFaces )
+  {
+    this->reset ();
+
+    this->mesh = mesh;
+    this->mask (std::vector <bool> ());
+
+    this->buildTopology   (liveVertices, liveFaces);
+    this->writeAllNormals ();
+    this->bufferData      ();
+  }
+
+  void topologyFromMesh (const Mesh& mesh) {
+    this->reset ();
+
+    this->mesh = mesh;
+    this->mask (std::vector <bool> ());
+
+    this->buildTopology   ( std::vector <bool> (this->mesh.numVertices (), true)
+                          , std::vector <bool> (this->mesh.numIndices () / 3, true) );
+    this->writeAllNormals ();
+  }
+
+  void liveSlots (std::vector <bool>& liveVertices, std::vector <bool>& liveFaces) const {
+    liveVertices.assign (this->mesh.numVertices (), true);
+    liveFaces   .assign (this->mesh.numIndices () / 3, true);
+
+    for (unsigned int i : this->vertices.freeIndices ()) {
+      liveVertices [i] = false;
+    }
+    for (unsigned int i : this->faces.freeIndices ()) {
+      liveFaces [i] = false;
+    }
+  }
+
+  void startLog (WingedLog& log) {
+    assert (this->log == nullptr);
+    this->log = &log;
+    this->resetOriginalFaces ();
+  }
+
+  void stopLog () {
+    this->log = nullptr;
+    this->resetOriginalFaces ();
+  }
+
+  /** `applyLog (l)` applies `l` in place, such that all slots keep their index.
+   * Only the topology of logged faces is rebuilt: their edges are either new or edges of
+   * the faces that they replace, which are kept in `openEdges` by the vertices of their
+   * open side.
+   * Only logged slots and normals around logged vertices are buffered. */
+  void applyLog (WingedLog& log) {
+    std::vector <bool>                        liveVertices;
+    std::vector <bool>                        liveFaces;
+    std::vector <bool>                        mask (this->vertexMask);
+    std::vector <unsigned int>                vertexSlots;
+    std::vector <unsigned int>                faceSlots;
+    std::vector <WingedFace*>                 oldFaces;
+    EdgePtrVec                                oldEdges;
+    std::unordered_map <ui_pair, WingedEdge*> openEdges;
+
+    assert (this->log == nullptr);
+
+    this->liveSlots (liveVertices, liveFaces);
+
+    log.forEachVertex ([&vertexSlots] (unsigned int i, bool) {
+      vertexSlots.push_back (i);
+    });
+    log.forEachFace ([&faceSlots] (unsigned int i, bool, unsigned int, unsigned int, unsigned int) {
+      faceSlots.push_back (i);
+    });
+
+    // delete the faces of logged slots
+    for (unsigned int i : faceSlots) {
+      if (i < liveFaces.size () && liveFaces [i]) {
+        WingedFace& face  = this->self->faceRef (i);
+        WingedEdge& edge1 = face.edgeRef ();
+        WingedEdge& edge2 = edge1.successorRef (face);
+        WingedEdge& edge3 = edge2.successorRef (face);
+
+        oldFaces.push_back (&face);
+        oldEdges.push_back (&edge1);
+        oldEdges.push_back (&edge2);
+        oldEdges.push_back (&edge3);
+      }
+    }
+    for (unsigned int i = 0; i < oldFaces.size (); i++) {
+      for (unsigned int j = 3 * i; j < (3 * i) + 3; j++) {
+        if (oldEdges [j]->leftFace () == oldFaces [i]) {
+          oldEdges [j]->leftFace (nullptr);
+        }
+        else {
+          assert (oldEdges [j]->rightFace () == oldFaces [i]);
+          oldEdges [j]->rightFace (nullptr);
+        }
+      }
+      this->octree.deleteElement (oldFaces [i]->index ());
+      this->faces .deleteElement (*oldFaces [i]);
+    }
+
+    // keep edges that are still adjacent to a face
+    EdgePtrSet deletedEdges;
+
+    for (WingedEdge* e : oldEdges) {
+      if (e->leftFace () == nullptr && e->rightFace () == nullptr) {
+        deletedEdges.insert (e);
+      }
+      else if (e->leftFace () == nullptr) {
+        openEdges.emplace (ui_pair (e->vertex1Ref ().index (), e->vertex2Ref ().index ()), e);
+      }
+      else if (e->rightFace () == nullptr) {
+        openEdges.emplace (ui_pair (e->vertex2Ref ().index (), e->vertex1Ref ().index ()), e);
+      }
+    }
+    for (WingedEdge* e : deletedEdges) {
+      this->edges.deleteElement (*e);
+    }
+    for (auto& e : openEdges) {
+      e.second->vertex1Ref ().edge (e.second);
+      e.second->vertex2Ref ().edge (e.second);
+    }
+
+    // apply log
+    std::vector <bool> wasLive (vertexSlots.size ());
+
+    for (unsigned int i = 0; i < vertexSlots.size (); i++) {
+      wasLive [i] = vertexSlots [i] < liveVertices.size () && liveVertices [vertexSlots [i]];
+    }
+    log.apply  (this->mesh, liveVertices, liveFaces, mask);
+    this->mask (mask);
+
+    for (unsigned int i = 0; i < vertexSlots.size (); i++) {
+      const unsigned int slot = vertexSlots [i];
+
+      if (wasLive [i] && liveVertices [slot] == false) {
+        this->vertices.deleteElement (this->self->vertexRef (slot));
+      }
+      else if (wasLive [i] == false && liveVertices [slot]) {
+        this->vertices.emplaceAt (slot);
+      }
+    }
+
+    // add the faces of logged slots
+    auto findOrAddEdge = [this, &openEdges] ( unsigned int index1, unsigned int index2
+                                            , WingedFace& face ) -> WingedEdge&
+    {
+      auto it = openEdges.find (ui_pair (index1, index2));
+
+      if (it != openEdges.end ()) {
+        WingedEdge& edge = *it->second;
+
+        if (edge.vertex1Ref ().index () == index1) {
+          edge.leftFace (&face);
+        }
+        else {
+          edge.rightFace (&face);
+        }
+        openEdges.erase (it);
+        face.edge (&edge);
+        return edge;
+      }
+      else {
+        WingedVertex* v1      = this->vertex (index1);
+        WingedVertex* v2      = this->vertex (index2);
+        WingedEdge&   newEdge = this->addEdge ();
+
+        openEdges.emplace (ui_pair (index2, index1), &newEdge);
+        newEdge.vertex1  (v1);
+        newEdge.vertex2  (v2);
+        newEdge.leftFace (&face);
+
+        v1-> edge (&newEdge);
+        v2-> edge (&newEdge);
+        face.edge (&newEdge);
+
+        return newEdge;
+      }
+    };
+
+    FacePtrSet newFaces;
+
+    for (unsigned int slot : faceSlots) {
+      if (liveFaces [slot] == false) {
+        continue;
+      }
+      const unsigned int index1 = this->mesh.index ((3 * slot) + 0);
+      const unsigned int index2 = this->mesh.index ((3 * slot) + 1);
+      const unsigned int index3 = this->mesh.index ((3 * slot) + 2);
+
+      WingedFace& f = this->faces.emplaceAt (slot);
+
+      this->addFaceToOctree (f, PrimTriangle ( this->mesh.vertex (index1)
+                                             , this->mesh.vertex (index2)
+                                             , this->mesh.vertex (index3) ));
+
+      WingedEdge& e1 = findOrAddEdge (index1, index2, f);
+      WingedEdge& e2 = findOrAddEdge (index2, index3, f);
+      WingedEdge& e3 = findOrAddEdge (index3, index1, f);
+
+      e1.predecessor (f, &e3);
+      e1.successor   (f, &e2);
+      e2.predecessor (f, &e1);
+      e2.successor   (f, &e3);
+      e3.predecessor (f, &e2);
+      e3.successor   (f, &e1);
+
+      newFaces.insert (&f);
+    }
+    assert (openEdges.empty ());
+
+    // realign faces and write normals around logged vertices
+    FacePtrSet   affectedFaces (newFaces);
+    VertexPtrSet affectedVertices;
+
+    for (unsigned int slot : vertexSlots) {
+      if (liveVertices [slot]) {
+        for (WingedFace& f : this->self->vertexRef (slot).adjacentFaces ()) {
+          affectedFaces.insert (&f);
+        }
+      }
+    }
+    for (WingedFace* f : affectedFaces) {
+      if (newFaces.count (f) == 0) {
+        this->realignFace (*f);
+      }
+      affectedVertices.insert (&f->vertexRef (0));
+      affectedVertices.insert (&f->vertexRef (1));
+      affectedVertices.insert (&f->vertexRef (2));
+    }
+    this->writeNormals (VertexPtrVec (affectedVertices.begin (), affectedVertices.end ()));
+
+    // buffer: free face slots must repeat some face (cf. `bufferData`)
+    std::vector <unsigned int> bufferedVertices;
+    std::vector <unsigned int> bufferedFaces (faceSlots);
+
+    bufferedVertices.reserve (affectedVertices.size () + vertexSlots.size ());
+    for (WingedVertex* v : affectedVertices) {
+      bufferedVertices.push_back (v->index ());
+    }
+    bufferedVertices.insert (bufferedVertices.end (), vertexSlots.begin (), vertexSlots.end ());
+
+    if (this->numFaces () > 0) {
+      const unsigned int someFace = 3 * this->faces.front ().index ();
+
+      for (unsigned int slot : this->faces.freeIndices ()) {
+        bool isRepeated = true;
+
+        for (unsigned int i = 0; i < 3; i++) {
+          if (this->index ((3 * slot) + i) != this->index (someFace + i)) {
+            this->mesh.setIndex ((3 * slot) + i, this->index (someFace + i));
+            isRepeated = false;
+          }
+        }
+        if (isRepeated == false) {
+          bufferedFaces.push_back (slot);
+        }
+      }
+    }
+    this->mesh.bufferData (bufferedVertices, bufferedFaces);
+
+    this->updateFinestLevel = true;
+  }
+
+  FacePtrVec allFaces () {
+    FacePtrVec faces;
+
+    faces.reserve (this->numFaces ());
+    this->faces.forEachElement ([&faces] (WingedFace& f) {
+      faces.push_back (&f);
+    });
+    return faces;
+  }
+
   void writeAllIndices () {
-    this->faces.forEachElement ([this] (WingedFace& face) {
-      face.writeIndices (*this->self);
+    const FacePtrVec faces = this->allFaces ();
+
+    ParallelUtil::forEach (faces.size (), [this, &faces] (unsigned int i) {
+      faces [i]->writeIndices (*this->self);
+    });
+  }
+
+  /** `writeNormals (vs)` writes the area-weighted average normal of each vertex of `vs`.
+   * Each adjacent face's normal is computed only once and stored in a slot.
+   * `faceSlots` maps face indices to slots and is never cleared: a face's slot is only
+   * valid if it refers back to the face. */
+  void writeNormals (const VertexPtrVec& vertices) {
+    this->faceSlots.resize (this->mesh.numIndices () / 3);
+    this->slotFaces.clear ();
+
+    for (WingedVertex* v : vertices) {
+      for (WingedFace& f : v->adjacentFaces ()) {
+        const unsigned int slot = this->faceSlots [f.index ()];
+
+        if (slot >= this->slotFaces.size () || this->slotFaces [slot] != &f) {
+          this->faceSlots [f.index ()] = this->slotFaces.size ();
+          this->slotFaces.push_back (&f);
+        }
+      }
+    }
+    this->slotNormals.resize (this->slotFaces.size ());
+
+    ParallelUtil::forEach (this->slotFaces.size (), [this] (unsigned int i) {
+      const PrimTriangle triangle = this->slotFaces [i]->triangle (*this->self);
+
+      this->slotNormals [i] = glm::cross ( triangle.vertex2 () - triangle.vertex1 ()
+                                         , triangle.vertex3 () - triangle.vertex2 () );
+    });
+
+    ParallelUtil::forEach (vertices.size (), [this, &vertices] (unsigned int i) {
+      WingedVertex& vertex = *vertices [i];
+      glm::vec3     normal (0.0f);
+
+      for (WingedFace& f : vertex.adjacentFaces ()) {
+        normal += this->slotNormals [this->faceSlots [f.index ()]];
+      }
+      if (glm::dot (normal, normal) > 0.0f) {
+        vertex.writeNormal (*this->self, glm::normalize (normal));
+      }
     });
   }
 
   void writeAllNormals () {
-    this->vertices.forEachElement ([this] (WingedVertex& v) {
-      v.writeNormal (*this->self, v.interpolatedNormal (*this->self));
+    VertexPtrVec vertices;
+
+    vertices.reserve (this->numVertices ());
+    this->vertices.forEachElement ([&vertices] (WingedVertex& v) {
+      vertices.push_back (&v);
     });
+    this->writeNormals (vertices);
   }
 
   void bufferData  () { 
@@ -334,25 +882,62 @@ struct WingedMesh::Impl {
         WingedFace& someFace = this->faces.front ();
 
         for (unsigned int index : this->faces.freeIndices ()) {
-          this->setIndex ((3 * index) + 0, this->index ((3 * someFace.index ()) + 0));
-          this->setIndex ((3 * index) + 1, this->index ((3 * someFace.index ()) + 1));
-          this->setIndex ((3 * index) + 2, this->index ((3 * someFace.index ()) + 2));
+          this->mesh.setIndex ((3 * index) + 0, this->index ((3 * someFace.index ()) + 0));
+          this->mesh.setIndex ((3 * index) + 1, this->index ((3 * someFace.index ()) + 1));
+          this->mesh.setIndex ((3 * index) + 2, this->index ((3 * someFace.index ()) + 2));
         }
       }
     };
 
     resetFreeFaceIndices  ();
     this->mesh.bufferData (); 
+
+    this->updateFinestLevel = true;
   }
 
   void render (Camera& camera) { 
-    this->mesh.render   (camera); 
+    // meshes that have been emptied by a stroke are deleted when the stroke is finished
+    if (this->isEmpty ()) {
+      return;
+    }
+    if (this->updateFinestLevel && this->log == nullptr) {
+      this->hasFinestLevel    = Action::finestLevel (*this->self, this->finestLevel);
+      this->updateFinestLevel = false;
+
+      if (this->hasFinestLevel) {
+        this->finestLevel.bufferData ();
+      }
+      else {
+        this->finestLevel = Mesh ();
+      }
+    }
+
+    if (this->hasFinestLevel && this->updateFinestLevel == false) {
+      this->finestLevel.position       (this->mesh.position ());
+      this->finestLevel.scaling        (this->mesh.scaling ());
+      this->finestLevel.rotationMatrix (this->mesh.rotationMatrix ());
+      this->finestLevel.renderMode ()  = this->mesh.renderMode ();
+      this->finestLevel.color          (this->mesh.color ());
+      this->finestLevel.wireframeColor (this->mesh.wireframeColor ());
+      this->finestLevel.render         (camera);
+    }
+    else {
+      this->mesh.render (camera); 
+    }
 #ifdef DILAY_RENDER_OCTREE
     this->octree.render (camera);
 #endif
   }
 
   void reset () {
+    if (this->log) {
+      this->vertices.forEachConstElement ([this] (const WingedVertex& v) {
+        this->logVertex (v.index (), true);
+      });
+      this->faces.forEachConstElement ([this] (const WingedFace& f) {
+        this->logFace (f.index (), true);
+      });
+    }
     this->mesh    .reset ();
     this->vertices.reset ();
     this->edges   .reset ();
@@ -361,7 +946,18 @@ struct WingedMesh::Impl {
   }
 
   void mirror (const PrimPlane& plane) {
-    this->fromMesh (this->makePrunedMesh (nullptr), &plane);
+    this->fromMesh (this->makePrunedMesh (nullptr), this->makePrunedMask (), &plane);
+  }
+
+  void setupOctree () {
+    glm::vec3 minVertex, maxVertex;
+    this->mesh.minMax (minVertex, maxVertex);
+
+    const glm::vec3 center = (maxVertex + minVertex) * glm::vec3 (0.5f);
+    const glm::vec3 delta  =  maxVertex - minVertex;
+    const float     width  = glm::max (glm::max (delta.x, delta.y), delta.z);
+
+    this->setupOctreeRoot (center, width);
   }
 
   void setupOctreeRoot (const glm::vec3& center, float width) {
@@ -385,10 +981,106 @@ struct WingedMesh::Impl {
     return intersection.isIntersection ();
   }
 
+  glm::vec3 originalVertex (unsigned int index) const {
+    glm::vec3 position;
+
+    if (this->log && this->log->position (index, position)) {
+      return position;
+    }
+    return this->mesh.vertex (index);
+  }
+
+  PrimTriangle originalTriangle (unsigned int index) const {
+    unsigned int i1, i2, i3;
+
+    if (this->log == nullptr || this->log->indices (index, i1, i2, i3) == false) {
+      i1 = this->mesh.index ((3 * index) + 0);
+      i2 = this->mesh.index ((3 * index) + 1);
+      i3 = this->mesh.index ((3 * index) + 2);
+    }
+    return PrimTriangle ( this->originalVertex (i1)
+                        , this->originalVertex (i2)
+                        , this->originalVertex (i3) );
+  }
+
+  bool flagOriginalFace (unsigned int index) {
+    if (index >= this->isOriginalFace.size ()) {
+      this->isOriginalFace.resize (index + 1, false);
+    }
+    if (this->isOriginalFace [index]) {
+      return false;
+    }
+    else {
+      this->isOriginalFace [index] = true;
+      return true;
+    }
+  }
+
+  /** `addOriginalFace (i)` adds the live face `i` to `originalOctree`, if it has not been
+   * flagged yet. Its vertices are either unchanged or have been recorded by the log. */
+  void addOriginalFace (unsigned int index) {
+    if (this->flagOriginalFace (index)) {
+      const PrimTriangle tri = this->originalTriangle (index);
+
+      if (tri.isDegenerated ()) {
+        this->originalOctree.addDegeneratedElement (index);
+      }
+      else {
+        this->originalOctree.addElement (index, tri.center (), tri.maxDimExtent ());
+      }
+    }
+  }
+
+  void resetOriginalFaces () {
+    this->originalOctree     .reset ();
+    this->isOriginalFace     .clear ();
+    this->isOriginalVertex   .clear ();
+    this->newOriginalVertices.clear ();
+  }
+
+  /** Faces around logged vertices are only added here, because the topology may be
+   * inconsistent while vertices are logged.
+   * Faces around a logged vertex that are not logged themselves have not been changed,
+   * i.e. they are still adjacent to the vertex. */
+  bool intersectsOriginal (const PrimRay& ray, Intersection& intersection) {
+    for (unsigned int i : this->newOriginalVertices) {
+      const WingedVertex* vertex = i < this->mesh.numVertices () ? this->vertices.get (i)
+                                                                 : nullptr;
+      if (vertex) {
+        for (const WingedFace& f : vertex->adjacentFaces ()) {
+          this->addOriginalFace (f.index ());
+        }
+      }
+    }
+    this->newOriginalVertices.clear ();
+
+    auto test = [&ray, &intersection] (const PrimTriangle& tri) {
+      float t;
+
+      if (IntersectionUtil::intersects (ray, tri, &t)) {
+        intersection.update (t, ray.pointAt (t), tri.normal ());
+      }
+    };
+
+    this->originalOctree.intersects (ray, [this, &test] (unsigned int i) {
+      test (this->originalTriangle (i));
+    });
+    this->octree.intersects (ray, [this, &test] (unsigned int i) {
+      if (i >= this->isOriginalFace.size () || this->isOriginalFace [i] == false) {
+        test (this->self->faceRef (i).triangle (*this->self));
+      }
+    });
+    return intersection.isIntersection ();
+  }
+
   bool intersects (const PrimSphere& sphere, AffectedFaces& faces) {
     this->octree.intersects (sphere, [this, &sphere, &faces] (unsigned int i) {
-      WingedFace&        face = this->self->faceRef (i);
-      const PrimTriangle tri  = face.triangle (*this->self);
+      WingedFace& face = this->self->faceRef (i);
+
+      if (this->isMasked (face)) {
+        return;
+      }
+      const PrimTriangle tri = face.triangle (*this->self);
 
       if (IntersectionUtil::intersects (sphere, tri)) {
         faces.insert (face);
@@ -483,14 +1175,26 @@ DELEGATE        (WingedEdge&    , WingedMesh, addEdge)
 DELEGATE1       (WingedFace&    , WingedMesh, addFace, const PrimTriangle&)
 DELEGATE2       (void           , WingedMesh, setIndex, unsigned int, unsigned int)
 DELEGATE2       (void           , WingedMesh, setVertex, unsigned int, const glm::vec3&)
+DELEGATE1       (void           , WingedMesh, logVertex, unsigned int)
+DELEGATE2       (void           , WingedMesh, setLoggedVertex, unsigned int, const glm::vec3&)
 DELEGATE2       (void           , WingedMesh, setNormal, unsigned int, const glm::vec3&)
 
 GETTER_CONST    (const IndexOctree&, WingedMesh, octree)
 GETTER_CONST    (const Mesh&       , WingedMesh, mesh)
+GETTER_CONST    (const MultiRes&   , WingedMesh, multiRes)
+GETTER          (MultiRes&         , WingedMesh, multiRes)
 
 DELEGATE1       (void, WingedMesh, deleteEdge, WingedEdge&)
 DELEGATE1       (void, WingedMesh, deleteFace, WingedFace&)
 DELEGATE1       (void, WingedMesh, deleteVertex, WingedVertex&)
+
+DELEGATE1_CONST (bool                     , WingedMesh, isMasked, unsigned int)
+DELEGATE1_CONST (bool                     , WingedMesh, isMasked, const WingedFace&)
+DELEGATE2       (void                     , WingedMesh, mask, unsigned int, bool)
+DELEGATE_CONST  (const std::vector <bool>&, WingedMesh, mask)
+DELEGATE1       (void                     , WingedMesh, mask, const std::vector <bool>&)
+DELEGATE_CONST  (bool                     , WingedMesh, hasMask)
+
 DELEGATE2       (void, WingedMesh, realignFace, const WingedFace&, const PrimTriangle&)
 DELEGATE1       (void, WingedMesh, realignFace, const WingedFace&)
 DELEGATE        (void, WingedMesh, realignAllFaces)
@@ -503,8 +1207,17 @@ DELEGATE_CONST  (unsigned int     , WingedMesh, numIndices)
 DELEGATE_CONST  (bool             , WingedMesh, isEmpty)
 
 DELEGATE1_CONST (Mesh             , WingedMesh, makePrunedMesh, std::vector <unsigned int>*)
+DELEGATE_CONST  (std::vector <bool>, WingedMesh, makePrunedMask)
 DELEGATE2       (void             , WingedMesh, fromMesh, const Mesh&, const PrimPlane*)
+DELEGATE3       (void             , WingedMesh, fromMesh, const Mesh&, const std::vector <bool>&, const PrimPlane*)
+DELEGATE3       (void             , WingedMesh, fromMesh, const Mesh&, const std::vector <bool>&, const std::vector <bool>&)
+DELEGATE1       (void             , WingedMesh, topologyFromMesh, const Mesh&)
+DELEGATE2_CONST (void             , WingedMesh, liveSlots, std::vector <bool>&, std::vector <bool>&)
+DELEGATE1       (void             , WingedMesh, startLog, WingedLog&)
+DELEGATE        (void             , WingedMesh, stopLog)
+DELEGATE1       (void             , WingedMesh, applyLog, WingedLog&)
 DELEGATE        (void             , WingedMesh, writeAllIndices)
+DELEGATE1       (void             , WingedMesh, writeNormals, const VertexPtrVec&)
 DELEGATE        (void             , WingedMesh, writeAllNormals)
 DELEGATE        (void             , WingedMesh, bufferData)
 DELEGATE1       (void             , WingedMesh, render, Camera&)
@@ -516,6 +1229,7 @@ DELEGATE        (RenderMode&      , WingedMesh, renderMode)
 
 DELEGATE2       (bool, WingedMesh, intersects, const PrimRay&, WingedFaceIntersection&)
 DELEGATE2       (bool, WingedMesh, intersects, const PrimSphere&, AffectedFaces&)
+DELEGATE2       (bool, WingedMesh, intersectsOriginal, const PrimRay&, Intersection&)
 
 DELEGATE1       (void              , WingedMesh, scale, const glm::vec3&)
 DELEGATE1       (void              , WingedMesh, scaling, const glm::vec3&)
@@ -10,12 +10,15 @@
 #include <vector>
 #include "intrusive-list.hpp"
 #include "macro.hpp"
+#include "winged/fwd.hpp"
 
 class AffectedFaces;
 class Camera;
 class Color;
 class IndexOctree;
+class Intersection;
 class Mesh;
+class MultiRes;
 class PrimPlane;
 class PrimRay;
 class PrimSphere;
@@ -24,6 +27,7 @@ class RenderMode;
 class WingedEdge;
 class WingedFace;
 class WingedFaceIntersection;
+class WingedLog;
 class WingedVertex;
 
 class WingedMesh : public IntrusiveList <WingedMesh>::Item {
@@ -46,15 +50,34 @@ class WingedMesh : public IntrusiveList <WingedMesh>::Item {
     WingedFace&        addFace             (const PrimTriangle&);
     void               setIndex            (unsigned int, unsigned int);
     void               setVertex           (unsigned int, const glm::vec3&);
+
+    /** `setLoggedVertex (i,v)` sets the position of vertex `i` like `setVertex`, but
+     * expects that `i` has already been recorded by `logVertex (i)`.
+     * Unlike `setVertex`, it does not lock the current log, i.e. positions of distinct
+     * vertices can be set in parallel. */
+    void               logVertex           (unsigned int);
+    void               setLoggedVertex     (unsigned int, const glm::vec3&);
     void               setNormal           (unsigned int, const glm::vec3&);
 
     const IndexOctree& octree              () const;
     const Mesh&        mesh                () const;
+    const MultiRes&    multiRes            () const;
+    MultiRes&          multiRes            ();
 
     void               deleteEdge          (WingedEdge&);
     void               deleteFace          (WingedFace&);
     void               deleteVertex        (WingedVertex&);
 
+    /** Masked vertices are protected from sculpting.
+     * A face is masked if one of its vertices is masked.
+     * Masked faces are culled from `intersects (const PrimSphere&, AffectedFaces&)`. */
+    bool               isMasked            (unsigned int) const;
+    bool               isMasked            (const WingedFace&) const;
+    void               mask                (unsigned int, bool);
+    const std::vector <bool>& mask         () const;
+    void               mask                (const std::vector <bool>&);
+    bool               hasMask             () const;
+
     void               realignFace         (const WingedFace&, const PrimTriangle&);
     void               realignFace         (const WingedFace&);
     void               realignAllFaces     ();
@@ -67,8 +90,22 @@ class WingedMesh : public IntrusiveList <WingedMesh>::Item {
     bool               isEmpty             () const;
 
     Mesh               makePrunedMesh      (std::vector <unsigned int>* = nullptr) const;
+    std::vector <bool> makePrunedMask      () const;
     void               fromMesh            (const Mesh&, const PrimPlane* = nullptr);
+    void               fromMesh            ( const Mesh&, const std::vector <bool>&
+                                           , const PrimPlane* = nullptr );
+    void               fromMesh            ( const Mesh&, const std::vector <bool>&
+                                           , const std::vector <bool>& );
+
+    /** `topologyFromMesh (m)` builds the topology of `m` like `fromMesh (m,v,f)` with all
+     * slots being live, but does not buffer data, i.e. it does not need a GL context. */
+    void               topologyFromMesh    (const Mesh&);
+    void               liveSlots           (std::vector <bool>&, std::vector <bool>&) const;
+    void               startLog            (WingedLog&);
+    void               stopLog             ();
+    void               applyLog            (WingedLog&);
     void               writeAllIndices     (); 
+    void               writeNormals        (const VertexPtrVec&);
     void               writeAllNormals     (); 
     void               bufferData          ();
     void               render              (Camera&);
@@ -81,6 +118,12 @@ class WingedMesh : public IntrusiveList <WingedMesh>::Item {
     bool               intersects          (const PrimRay&, WingedFaceIntersection&);
     bool               intersects          (const PrimSphere&, AffectedFaces&);
 
+    /** `intersectsOriginal (r,i)` intersects `r` with the mesh's surface before its
+     * current log has been started, i.e. before the current sculpt stroke.
+     * Faces that may have been changed by the log are kept in a separate octree, which is
+     * updated incrementally while logging. */
+    bool               intersectsOriginal  (const PrimRay&, Intersection&);
+
     void               scale               (const glm::vec3&);
     void               scaling             (const glm::vec3&);
     glm::vec3          scaling             () const;
@@ -33,21 +33,6 @@ glm::vec3 WingedVertex :: savedNormal (const WingedMesh& mesh) const {
   return mesh.normal (this->_index);
 }
 
-glm::vec3 WingedVertex :: interpolatedNormal (const WingedMesh& mesh) const {
-  glm::vec3    normal = glm::vec3 (0.0f);
-  unsigned int n      = 0;
-
-  for (WingedFace& f : this->adjacentFaces ()) {
-    PrimTriangle triangle = f.triangle (mesh);
-    if (triangle.isDegenerated () == false) {
-      normal += triangle.normal ();
-      n++;
-    }
-  }
-  assert (n > 0);
-  return normal / float (n);
-}
-
 void WingedVertex :: writePosition (WingedMesh& mesh, const glm::vec3& pos) {
   mesh.setVertex (this->_index, pos);
 }
@@ -56,10 +41,6 @@ void WingedVertex :: writeNormal (WingedMesh& mesh, const glm::vec3& normal) {
   mesh.setNormal (this->_index, normal);
 }
 
-void WingedVertex :: writeInterpolatedNormal (WingedMesh& mesh) {
-  this->writeNormal (mesh, this->interpolatedNormal (mesh));
-}
-
 unsigned int WingedVertex :: valence () const {
   unsigned int i             = 0;
   AdjEdges     adjacentEdges = this->adjacentEdges ();
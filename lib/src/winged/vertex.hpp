@@ -29,14 +29,12 @@ class WingedVertex : public IntrusiveList <WingedVertex>::Item {
 
     void          edge     (WingedEdge* e) { this->_edge = e; }
 
-    void          writeIndex              (WingedMesh&, unsigned int);
-    glm::vec3     position                (const WingedMesh&) const;
-    glm::vec3     savedNormal             (const WingedMesh&) const;
-    glm::vec3     interpolatedNormal      (const WingedMesh&) const;
-    void          writePosition           (WingedMesh&, const glm::vec3&);
-    void          writeNormal             (WingedMesh&, const glm::vec3&);
-    void          writeInterpolatedNormal (WingedMesh&);
-    unsigned int  valence                 () const;
+    void          writeIndex       (WingedMesh&, unsigned int);
+    glm::vec3     position         (const WingedMesh&) const;
+    glm::vec3     savedNormal      (const WingedMesh&) const;
+    void          writePosition    (WingedMesh&, const glm::vec3&);
+    void          writeNormal      (WingedMesh&, const glm::vec3&);
+    unsigned int  valence          () const;
 
     AdjEdges      adjacentEdges    (WingedEdge&) const;
     AdjEdges      adjacentEdges    ()            const;
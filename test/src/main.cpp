@@ -5,12 +5,15 @@
 #include <iostream>
 #include <QCoreApplication>
 #include "test-bitset.hpp"
+#include "test-conversion.hpp"
 #include "test-distance.hpp"
 #include "test-intersection.hpp"
 #include "test-intrusive-list.hpp"
+#include "test-mask.hpp"
 #include "test-maybe.hpp"
 #include "test-misc.hpp"
 #include "test-octree.hpp"
+#include "test-quadric.hpp"
 #include "test-tree.hpp"
 
 int main () {
@@ -29,6 +32,9 @@ int main () {
   TestTree         ::test2 ();
   TestMisc         ::test  ();
   TestDistance     ::test  ();
+  TestConversion   ::test  ();
+  TestQuadric      ::test  ();
+  TestMask         ::test  ();
 
   std::cout << "all tests run successfully\n";
   return 0;
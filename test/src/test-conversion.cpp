@@ -0,0 +1,130 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <chrono>
+#include <glm/glm.hpp>
+#include <iostream>
+#include "mesh.hpp"
+#include "sketch/conversion.hpp"
+#include "sketch/path.hpp"
+#include "test-conversion.hpp"
+
+namespace {
+  bool isEqual (const Mesh& m1, const Mesh& m2) {
+    if (m1.numVertices () != m2.numVertices () || m1.numIndices () != m2.numIndices ()) {
+      return false;
+    }
+    for (unsigned int i = 0; i < m1.numVertices (); i++) {
+      if (m1.vertex (i) != m2.vertex (i)) {
+        return false;
+      }
+    }
+    for (unsigned int i = 0; i < m1.numIndices (); i++) {
+      if (m1.index (i) != m2.index (i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+void TestConversion::test () {
+  const float       resolution = 0.05f;
+  const float       blending   = 0.3f;
+  const SketchPaths paths;
+  SketchTree        tree;
+
+  SketchNode& root = tree.emplaceRoot (glm::vec3 (0.0f), 1.0f);
+  SketchNode& tip  = root.emplaceChild (glm::vec3 (2.0f, 0.0f, 0.0f), 0.5f)
+                         .emplaceChild (glm::vec3 (2.0f, 1.5f, 0.0f), 0.3f);
+  SketchNode& node = root.emplaceChild (glm::vec3 (0.0f, -0.5f, 0.5f), 0.4f);
+
+  SketchConversionCache cache;
+
+  // conversions of a cache process all bricks at once, and `SketchConversion::convert`
+  // processes them in layers
+  assert (isEqual ( cache.convert (tree, paths, resolution, 0.0f, false)
+                  , SketchConversion::convert (tree, paths, resolution, 0.0f, false) ));
+
+  // edits that keep the sketch's bounding box reuse samples of the previous conversion
+  node.data ().center (glm::vec3 (0.2f, -0.4f, 0.5f));
+  assert (isEqual ( cache.convert (tree, paths, resolution, 0.0f, false)
+                  , SketchConversion::convert (tree, paths, resolution, 0.0f, false) ));
+
+  node.data ().radius (0.3f);
+  assert (isEqual ( cache.convert (tree, paths, resolution, 0.0f, false)
+                  , SketchConversion::convert (tree, paths, resolution, 0.0f, false) ));
+
+  root.deleteChild (node);
+  assert (isEqual ( cache.convert (tree, paths, resolution, 0.0f, false)
+                  , SketchConversion::convert (tree, paths, resolution, 0.0f, false) ));
+
+  // edits that change the sketch's bounding box reuse all bricks that remain unaffected
+  SketchConversionCache fresh;
+
+  tip.emplaceChild (glm::vec3 (2.0f, 2.5f, 0.5f), 0.2f);
+  assert (isEqual ( cache.convert (tree, paths, resolution, 0.0f, false)
+                  , SketchConversion::convert (tree, paths, resolution, 0.0f, false) ));
+
+  fresh.convert (tree, paths, resolution, 0.0f, false);
+  assert (cache.numSampledBricks () > 0);
+  assert (cache.numSampledBricks () < fresh.numSampledBricks () / 2);
+
+  root.data ().radius (1.2f);
+  assert (isEqual ( cache.convert (tree, paths, resolution, 0.0f, false)
+                  , SketchConversion::convert (tree, paths, resolution, 0.0f, false) ));
+
+  assert (isEqual ( cache.convert (tree, paths, 2.0f * resolution, 0.0f, false)
+                  , SketchConversion::convert (tree, paths, 2.0f * resolution, 0.0f, false) ));
+
+  // blended primitives
+  assert (isEqual ( cache.convert (tree, paths, resolution, blending, false)
+                  , SketchConversion::convert (tree, paths, resolution, blending, false) ));
+
+  SketchNode& blended = root.emplaceChild (glm::vec3 (0.5f, 0.8f, 0.0f), 0.3f);
+  assert (isEqual ( cache.convert (tree, paths, resolution, blending, false)
+                  , SketchConversion::convert (tree, paths, resolution, blending, false) ));
+
+  assert (isEqual ( SketchConversion::convert (tree, paths, resolution, blending, false)
+                  , SketchConversion::convert (tree, paths, resolution, 0.0f, false) ) == false);
+
+  // adaptive conversions merge cubes of flat regions
+  assert (isEqual ( cache.convert (tree, paths, resolution, blending, true)
+                  , SketchConversion::convert (tree, paths, resolution, blending, true) ));
+
+  blended.data ().center (glm::vec3 (0.6f, 0.7f, 0.0f));
+  assert (isEqual ( cache.convert (tree, paths, resolution, blending, true)
+                  , SketchConversion::convert (tree, paths, resolution, blending, true) ));
+
+  assert ( SketchConversion::convert (tree, paths, resolution, blending, true).numVertices ()
+         < SketchConversion::convert (tree, paths, resolution, blending, false).numVertices () );
+
+  // timings of combs of growing size: each node of the spine has a tooth
+  for (unsigned int n : { 16, 64, 256 }) {
+    SketchTree  comb;
+    SketchNode* spine = &comb.emplaceRoot (glm::vec3 (0.0f), 0.3f);
+
+    for (unsigned int i = 1; i < n; i++) {
+      const glm::vec3 center = spine->data ().center ();
+
+      if (i % 2 == 1) {
+        spine->emplaceChild (center + glm::vec3 (0.0f, 0.8f, 0.2f * float ((i / 2) % 3)), 0.15f);
+      }
+      else {
+        spine = &spine->emplaceChild (center + glm::vec3 (0.5f, 0.0f, 0.0f), 0.3f);
+      }
+    }
+
+    for (float r : { 2.0f * resolution, resolution }) {
+      const auto start = std::chrono::steady_clock::now ();
+      const Mesh mesh  = SketchConversion::convert (comb, paths, r, blending, false);
+      const auto end   = std::chrono::steady_clock::now ();
+
+      assert (mesh.numVertices () > 0);
+      std::cout << "converted " << n << " nodes at resolution " << r << " in "
+                << std::chrono::duration <float> (end - start).count () << "s\n";
+    }
+  }
+}
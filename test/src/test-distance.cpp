@@ -4,11 +4,47 @@
  */
 #include <glm/glm.hpp>
 #include <glm/gtc/epsilon.hpp>
+#include <vector>
 #include "distance.hpp"
+#include "primitive/cone-sphere.hpp"
 #include "primitive/cylinder.hpp"
+#include "primitive/sphere.hpp"
 #include "test-distance.hpp"
 #include "util.hpp"
 
+namespace {
+  /* compares batched distances with scalar ones at a grid of points around `min` and `max`
+   * for both the AVX2 and the SSE kernels, which must yield bit-identical results */
+  template <typename T>
+  void testDistances (const T& primitive, const glm::vec3& min, const glm::vec3& max) {
+    const unsigned int  n = 11;
+    std::vector <float> xs, ys, zs;
+
+    for (unsigned int z = 0; z < n; z++) {
+      for (unsigned int y = 0; y < n; y++) {
+        for (unsigned int x = 0; x < n; x++) {
+          const glm::vec3 p = min + ((max - min) * (glm::vec3 (x, y, z) / float (n - 1)));
+          xs.push_back (p.x);
+          ys.push_back (p.y);
+          zs.push_back (p.z);
+        }
+      }
+    }
+    std::vector <float> distances (xs.size ());
+
+    for (bool avx2 : { true, false }) {
+      Distance::useAvx2   (avx2);
+      Distance::distances ( primitive, xs.size ()
+                          , xs.data (), ys.data (), zs.data (), distances.data () );
+
+      for (unsigned int i = 0; i < xs.size (); i++) {
+        assert (distances [i] == Distance::distance (primitive, glm::vec3 (xs[i], ys[i], zs[i])));
+      }
+    }
+    Distance::useAvx2 (true);
+  }
+}
+
 void TestDistance::test () {
   using Distance::distance;
 
@@ -31,4 +67,17 @@ void TestDistance::test () {
                             , glm::sqrt ((1.5f * 1.5f) + (2.0f * 2.0f)), eps ));
   assert (glm::epsilonEqual ( distance (cyl, glm::vec3 (2.0f, 2.0f, 0.0f))
                             , glm::sqrt ((1.5f * 1.5f) + (1.0f * 1.0f)), eps ));
+
+  const PrimSphere s1 (glm::vec3 ( 0.0f, 0.0f, 0.0f), 1.0f);
+  const PrimSphere s2 (glm::vec3 ( 2.0f, 1.0f, 0.0f), 0.5f);
+  const PrimSphere s3 (glm::vec3 (-1.0f, 2.0f, 1.0f), 1.0f);
+  const PrimSphere s4 (glm::vec3 ( 0.2f, 0.0f, 0.0f), 0.5f);
+
+  testDistances (s1, glm::vec3 (-2.0f), glm::vec3 (2.0f));
+  testDistances (s2, glm::vec3 (-2.0f), glm::vec3 (3.0f));
+
+  // cone-spheres with a cone, with same radii, and without a cone
+  testDistances (PrimConeSphere (s1, s2), glm::vec3 (-2.0f), glm::vec3 (3.0f));
+  testDistances (PrimConeSphere (s1, s3), glm::vec3 (-2.0f), glm::vec3 (3.0f));
+  testDistances (PrimConeSphere (s1, s4), glm::vec3 (-2.0f), glm::vec3 (2.0f));
 }
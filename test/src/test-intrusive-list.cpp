@@ -118,6 +118,18 @@ void TestIntrusiveList::test2 () {
   assert (list.get (0)->data () == 20);
   assert (list.get (0)->index () == 0);
 
+  list.emplaceAt (3, 30);
+  assert (list.numElements () == 3);
+  assert (list.isFreeSLOW (2));
+  assert (list.get (3));
+  assert (list.get (3)->data () == 30);
+  assert (list.get (3)->index () == 3);
+
+  list.emplaceAt (2, 40);
+  assert (list.numElements () == 4);
+  assert (list.hasFreeIndices () == false);
+  assert (list.get (2)->data () == 40);
+
   list.reset ();
   assert (list.numElements () == 0);
   assert (list.hasFreeIndices () == false);
@@ -0,0 +1,57 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <glm/glm.hpp>
+#include <vector>
+#include "mesh.hpp"
+#include "mesh-util.hpp"
+#include "primitive/plane.hpp"
+#include "test-mask.hpp"
+#include "winged/log.hpp"
+
+void TestMask::test () {
+  const glm::vec3    masked   ( 0.5f, 0.5f, 0.5f);
+  const glm::vec3    mirrored (-0.5f, 0.5f, 0.5f);
+  const Mesh         cube (MeshUtil::cube ());
+  std::vector <bool> mask (cube.numVertices (), false);
+
+  for (unsigned int i = 0; i < cube.numVertices (); i++) {
+    mask [i] = cube.vertex (i) == masked;
+  }
+
+  // both copies of a masked vertex are masked after mirroring
+  Mesh mesh = MeshUtil::mirror ( cube, PrimPlane (glm::vec3 (0.0f), glm::vec3 (1.0f, 0.0f, 0.0f))
+                               , &mask );
+  unsigned int maskedIndex = mesh.numVertices ();
+
+  assert (mask.size () == mesh.numVertices ());
+
+  for (unsigned int i = 0; i < mesh.numVertices (); i++) {
+    const glm::vec3 v = mesh.vertex (i);
+
+    assert (mask [i] == (v == masked || v == mirrored));
+    if (mask [i]) {
+      maskedIndex = i;
+    }
+  }
+  assert (maskedIndex < mesh.numVertices ());
+
+  // deleting a masked vertex unmasks it: undoing the deletion masks it again
+  std::vector <bool> liveVertices (mesh.numVertices (), true);
+  std::vector <bool> liveFaces (mesh.numIndices () / 3, true);
+  WingedLog          log;
+
+  log.logVertex (maskedIndex, true, true, mesh.vertex (maskedIndex));
+  liveVertices [maskedIndex] = false;
+  mask         [maskedIndex] = false;
+
+  log.apply (mesh, liveVertices, liveFaces, mask);
+  assert (liveVertices [maskedIndex]);
+  assert (mask         [maskedIndex]);
+
+  log.apply (mesh, liveVertices, liveFaces, mask);
+  assert (liveVertices [maskedIndex] == false);
+  assert (mask         [maskedIndex] == false);
+}
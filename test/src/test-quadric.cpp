@@ -0,0 +1,50 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <glm/glm.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include "primitive/plane.hpp"
+#include "quadric.hpp"
+#include "test-quadric.hpp"
+#include "util.hpp"
+
+void TestQuadric::test () {
+  const glm::vec3 corner (1.0f, 2.0f, 3.0f);
+  const Quadric   x (PrimPlane (corner, glm::vec3 (1.0f, 0.0f, 0.0f)), 1.0f);
+  const Quadric   y (PrimPlane (corner, glm::vec3 (0.0f, 2.0f, 0.0f)), 2.0f);
+  const Quadric   z (PrimPlane (corner, glm::vec3 (0.0f, 0.0f, 1.0f)), 0.5f);
+
+  assert (glm::epsilonEqual (x.error (corner), 0.0f, Util::epsilon ()));
+  assert (glm::epsilonEqual (y.error (glm::vec3 (0.0f, 4.0f, 0.0f)), 8.0f, Util::epsilon ()));
+
+  // quadrics of parallel planes have no unique minimum
+  Quadric   xy = x;
+  glm::vec3 position (0.0f);
+
+  assert (xy.minimize (position) == false);
+  assert (position == glm::vec3 (0.0f));
+
+  // accumulated quadrics measure the distances to all of their planes
+  xy.add (y);
+
+  const glm::vec3 p (2.0f, 0.0f, -1.0f);
+  assert (glm::epsilonEqual (xy.error (p), x.error (p) + y.error (p), Util::epsilon ()));
+  assert (xy.minimize (position) == false);
+
+  Quadric xyz = xy;
+  xyz.add (z);
+
+  assert (xyz.minimize (position));
+  assert (glm::all (glm::epsilonEqual (position, corner, Util::epsilon ())));
+  assert (glm::epsilonEqual (xyz.error (position), 0.0f, Util::epsilon ()));
+
+  // the minimum of two sets of planes through a common point is that point
+  const Quadric tilted (PrimPlane (corner, glm::vec3 (1.0f, 1.0f, 1.0f)), 1.0f);
+  Quadric       xyTilted = xy;
+  xyTilted.add (tilted);
+
+  assert (xyTilted.minimize (position));
+  assert (glm::all (glm::epsilonEqual (position, corner, Util::epsilon ())));
+}
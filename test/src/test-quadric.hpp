@@ -0,0 +1,12 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_TEST_QUADRIC
+#define DILAY_TEST_QUADRIC
+
+namespace TestQuadric {
+  void test ();
+}
+
+#endif
@@ -9,22 +9,28 @@ INCLUDEPATH    += src $$PWD/../lib/src
 SOURCES += \
            src/main.cpp \
            src/test-bitset.cpp \
+           src/test-conversion.cpp \
            src/test-distance.cpp \
            src/test-intersection.cpp \
            src/test-intrusive-list.cpp \
+           src/test-mask.cpp \
            src/test-maybe.cpp \
            src/test-misc.cpp \
            src/test-octree.cpp \
+           src/test-quadric.cpp \
            src/test-tree.cpp
 
 HEADERS += \
            src/test-bitset.hpp \
+           src/test-conversion.hpp \
            src/test-distance.hpp \
            src/test-intersection.hpp \
            src/test-intrusive-list.hpp \
+           src/test-mask.hpp \
            src/test-maybe.hpp \
            src/test-misc.hpp \
            src/test-octree.hpp \
+           src/test-quadric.hpp \
            src/test-tree.hpp
 
 win32:CONFIG(release, debug|release):    LIBS += -L$$OUT_PWD/../lib/release/ -ldilay